@@ -0,0 +1,75 @@
+#include "benchmark/benchmark.h"
+#include "foundation/dynamic_array.hpp"
+#include "algo/parallel_sort.hpp"
+#include "algo/radix_sort.hpp"
+#include "algo/sort.hpp"
+#include "algo/stable_sort.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace Engine;
+
+static DynamicArray<uint32> MakeSortInput(int64 count)
+{
+    std::mt19937 random(42);
+    DynamicArray<uint32> array;
+    array.Reserve((int32)count);
+    for (int64 i = 0; i < count; i++)
+    {
+        array.Add(random());
+    }
+    return array;
+}
+
+/** every iteration sorts a fresh copy, the copy is part of the time of all variants */
+template <typename SortFunc>
+static void RunSortBenchmark(benchmark::State& state, const SortFunc& sortFunc)
+{
+    const DynamicArray<uint32> source = MakeSortInput(state.range(0));
+    DynamicArray<uint32> array;
+    for (auto _ : state)
+    {
+        array = source;
+        sortFunc(array);
+        benchmark::DoNotOptimize(array.Data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_StdSort(benchmark::State& state)
+{
+    RunSortBenchmark(state, [](DynamicArray<uint32>& array) { std::sort(array.Data(), array.Data() + array.Size()); });
+}
+
+static void BM_AlgoSort(benchmark::State& state)
+{
+    RunSortBenchmark(state, [](DynamicArray<uint32>& array) { Algo::Sort(array); });
+}
+
+static void BM_StdStableSort(benchmark::State& state)
+{
+    RunSortBenchmark(state, [](DynamicArray<uint32>& array) { std::stable_sort(array.Data(), array.Data() + array.Size()); });
+}
+
+static void BM_AlgoStableSort(benchmark::State& state)
+{
+    RunSortBenchmark(state, [](DynamicArray<uint32>& array) { Algo::StableSort(array); });
+}
+
+static void BM_AlgoRadixSort(benchmark::State& state)
+{
+    RunSortBenchmark(state, [](DynamicArray<uint32>& array) { Algo::RadixSort(array); });
+}
+
+static void BM_AlgoParallelSort(benchmark::State& state)
+{
+    RunSortBenchmark(state, [](DynamicArray<uint32>& array) { Algo::ParallelSort(array); });
+}
+
+BENCHMARK(BM_StdSort)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_AlgoSort)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_StdStableSort)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_AlgoStableSort)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_AlgoRadixSort)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_AlgoParallelSort)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
@@ -0,0 +1,98 @@
+#include "benchmark/benchmark.h"
+#include "foundation/concurrent_map.hpp"
+#include "foundation/map.hpp"
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace Engine;
+
+/** names every thread interns, the first pass adds them and later ones only find them */
+static constexpr int32 kNameCount = 16384;
+
+static const std::vector<std::string>& GetNames()
+{
+    static const std::vector<std::string> names = []()
+    {
+        std::vector<std::string> result;
+        for (int32 i = 0; i < kNameCount; i++)
+        {
+            result.push_back("Actor_Component_" + std::to_string(i));
+        }
+        return result;
+    }();
+    return names;
+}
+
+/** one Map behind one lock, how StringEntryPool and ModuleManager used to share names */
+class SharedMutexMap
+{
+public:
+    uint64 FindOrAdd(uint64 key, uint64 value)
+    {
+        {
+            std::shared_lock lock(Mutex);
+            if (uint64* found = Pairs.Find(key))
+            {
+                return *found;
+            }
+        }
+        std::lock_guard lock(Mutex);
+        return Pairs.FindOrAdd(key, value);
+    }
+
+    void Clear()
+    {
+        std::lock_guard lock(Mutex);
+        Pairs.Clear();
+    }
+
+private:
+    std::shared_mutex Mutex;
+    Map<uint64, uint64> Pairs;
+};
+
+template <typename MapType>
+static void RunInternBenchmark(benchmark::State& state, MapType& map)
+{
+    if (state.thread_index() == 0)
+    {
+        map.Clear();
+    }
+
+    const std::vector<std::string>& names = GetNames();
+    // threads walk the names from different offsets so they contend on adds too
+    int32 index = state.thread_index() * 997 % kNameCount;
+    for (auto _ : state)
+    {
+        const uint64 entryId = std::hash<std::string_view>()(names[index]);
+        benchmark::DoNotOptimize(map.FindOrAdd(entryId, entryId));
+        index = (index + 1) & (kNameCount - 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_SharedMutexMapIntern(benchmark::State& state)
+{
+    static SharedMutexMap map;
+    RunInternBenchmark(state, map);
+}
+
+static void BM_ConcurrentMapIntern(benchmark::State& state)
+{
+    static ConcurrentMap<uint64, uint64> map;
+    RunInternBenchmark(state, map);
+}
+
+static void BM_ReadMostlyMapIntern(benchmark::State& state)
+{
+    static ConcurrentMap<uint64, uint64, true> map;
+    RunInternBenchmark(state, map);
+}
+
+BENCHMARK(BM_SharedMutexMapIntern)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_ConcurrentMapIntern)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_ReadMostlyMapIntern)->ThreadRange(1, 64)->UseRealTime();
@@ -1,10 +1,18 @@
 #include "benchmark/benchmark.h"
 #include "foundation/dynamic_array.hpp"
 #include "foundation/set.hpp"
+#include "foundation/map.hpp"
+#include "foundation/flat_set.hpp"
+#include "foundation/flat_map.hpp"
+#include "foundation/sorted_flat_map.hpp"
 #include "foundation/ustring.hpp"
+#include <string>
+#include <string_view>
+#include <chrono>
 #include <vector>
 #include <set>
 #include <unordered_set>
+#include <unordered_map>
 #include <iostream>
 
 using namespace Engine;
@@ -75,6 +83,74 @@ static void BM_VectorRemove(benchmark::State& state)
     }
 }
 
+static constexpr uint32 kRemoveArraySize = 100000;
+
+/** value in [0, 100) spread over the array, removing values below N removes about N percent */
+static uint32 GetRemovePercentile(uint32 index)
+{
+    return ((index * 2654435761u) >> 16) % 100;
+}
+
+template <typename ArrayType>
+static void FillRemoveArray(ArrayType& array)
+{
+    for (uint32 i = 0; i < kRemoveArraySize; i++)
+    {
+        array[i] = GetRemovePercentile(i);
+    }
+}
+
+static void BM_DyanmicArrayRemoveMatch(benchmark::State& state)
+{
+    const uint32 percent = (uint32)state.range(0);
+    DynamicArray<uint32> array;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        array.Resize(kRemoveArraySize);
+        FillRemoveArray(array);
+        state.ResumeTiming();
+
+        array.RemoveMatch([percent](uint32 value) { return value < percent; });
+        benchmark::DoNotOptimize(array.Data());
+    }
+    state.SetItemsProcessed(state.iterations() * kRemoveArraySize);
+}
+
+static void BM_DyanmicArrayRemoveAllSwap(benchmark::State& state)
+{
+    const uint32 percent = (uint32)state.range(0);
+    DynamicArray<uint32> array;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        array.Resize(kRemoveArraySize);
+        FillRemoveArray(array);
+        state.ResumeTiming();
+
+        array.RemoveAllSwap([percent](uint32 value) { return value < percent; });
+        benchmark::DoNotOptimize(array.Data());
+    }
+    state.SetItemsProcessed(state.iterations() * kRemoveArraySize);
+}
+
+static void BM_VectorEraseIf(benchmark::State& state)
+{
+    const uint32 percent = (uint32)state.range(0);
+    std::vector<uint32> array;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        array.resize(kRemoveArraySize);
+        FillRemoveArray(array);
+        state.ResumeTiming();
+
+        std::erase_if(array, [percent](uint32 value) { return value < percent; });
+        benchmark::DoNotOptimize(array.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kRemoveArraySize);
+}
+
 static void BM_DyanmicArrayLoop(benchmark::State& state)
 {
     DynamicArray<uint32> array;
@@ -84,10 +160,12 @@ static void BM_DyanmicArrayLoop(benchmark::State& state)
     }
     for (auto _ : state) 
     {
-        for (auto _ : array)
+        uint32 sum = 0;
+        for (uint32 value : array)
         {
-
+            sum += value;
         }
+        benchmark::DoNotOptimize(sum);
     }
 }
 
@@ -100,10 +178,82 @@ static void BM_VectorLoop(benchmark::State& state)
     }
     for (auto _ : state) 
     {
-        for (auto _ : array)
+        uint32 sum = 0;
+        for (uint32 value : array)
+        {
+            sum += value;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+}
+
+/** heap allocations one temporary list of count elements makes, counted once outside the timed loop */
+template <typename ArrayType>
+static int64 CountTempListAllocations(int64 count)
+{
+    ArrayType array;
+    int64 allocations = 0;
+    size_t allocatedSize = array.GetAllocatedSize();
+    for (int64 i = 0; i < count; i++)
+    {
+        array.Add((uint32)i);
+        if (array.GetAllocatedSize() != allocatedSize)
+        {
+            allocatedSize = array.GetAllocatedSize();
+            ++allocations;
+        }
+    }
+    return allocations;
+}
+
+/** a short lived list built and consumed per iteration, the case small vectors are for */
+template <typename ArrayType>
+static void RunTempListBenchmark(benchmark::State& state)
+{
+    const int64 count = state.range(0);
+    for (auto _ : state)
+    {
+        ArrayType array;
+        for (int64 i = 0; i < count; i++)
+        {
+            array.Add((uint32)i);
+        }
+        uint32 sum = 0;
+        for (uint32 value : array)
         {
+            sum += value;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.counters["heap_allocs"] = (double)CountTempListAllocations<ArrayType>(count);
+}
+
+static void BM_DynamicArrayTempList(benchmark::State& state)
+{
+    RunTempListBenchmark<DynamicArray<uint32>>(state);
+}
+
+static void BM_InlineArrayTempList(benchmark::State& state)
+{
+    RunTempListBenchmark<DynamicArray<uint32, InlineAllocator<16>>>(state);
+}
 
+static void BM_VectorTempList(benchmark::State& state)
+{
+    const int64 count = state.range(0);
+    for (auto _ : state)
+    {
+        std::vector<uint32> array;
+        for (int64 i = 0; i < count; i++)
+        {
+            array.push_back((uint32)i);
         }
+        uint32 sum = 0;
+        for (uint32 value : array)
+        {
+            sum += value;
+        }
+        benchmark::DoNotOptimize(sum);
     }
 }
 
@@ -119,6 +269,18 @@ static void BM_SetAdd(benchmark::State& state)
     }
 }
 
+static void BM_FlatSetAdd(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        FlatSet<uint32> mySet;
+        for (uint32 i = 0; i < 1000; i++)
+        {
+            mySet.Add(i);
+        }
+    }
+}
+
 static void BM_StlHashSetAdd(benchmark::State& state)
 {
     for (auto _ : state)
@@ -161,6 +323,87 @@ static void BM_SetLoop(benchmark::State& state)
     }
 }
 
+/** iterate a set after 90% of 10000 elements were removed, arg 1 compacts it first */
+static void BM_SetLoopAfterRemove(benchmark::State& state)
+{
+    Set<uint32> mySet;
+    for (uint32 i = 0; i < 10000; i++)
+    {
+        mySet.Add(i);
+    }
+    for (uint32 i = 0; i < 10000; i++)
+    {
+        if (i % 10 != 0)
+        {
+            mySet.Remove(i);
+        }
+    }
+    if (state.range(0))
+    {
+        mySet.Compact();
+    }
+
+    uint32 v = 0;
+    for (auto _ : state)
+    {
+        for (auto&& item : mySet)
+        {
+            v += item;
+        }
+        benchmark::DoNotOptimize(v);
+    }
+}
+
+/** time every Add, the counter is the slowest one, which is the Add that rehashes when rehash is not incremental */
+template <typename SetType>
+static void RunWorstInsertBenchmark(benchmark::State& state)
+{
+    const uint64 count = static_cast<uint64>(state.range(0));
+    double worstInsertNs = 0.0;
+    for (auto _ : state)
+    {
+        SetType mySet;
+        for (uint64 i = 0; i < count; i++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            mySet.Add(i * 2654435761u);
+            const auto end = std::chrono::steady_clock::now();
+            worstInsertNs = Math::Max(worstInsertNs, std::chrono::duration<double, std::nano>(end - start).count());
+        }
+        benchmark::DoNotOptimize(mySet.Size());
+    }
+    state.counters["WorstInsertUs"] = worstInsertNs / 1000.0;
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+static void BM_SetWorstInsert(benchmark::State& state)
+{
+    RunWorstInsertBenchmark<Set<uint64>>(state);
+}
+
+static void BM_IncrementalSetWorstInsert(benchmark::State& state)
+{
+    RunWorstInsertBenchmark<Set<uint64, DefaultSetKeyFunc<uint64>, IncrementalSetAllocator>>(state);
+}
+
+static void BM_FlatSetLoop(benchmark::State& state)
+{
+    FlatSet<uint32> mySet;
+    for (uint32 i = 1000; i > 0; i--)
+    {
+        mySet.Add(i);
+    }
+
+    uint32 v = 0;
+    for (auto _ : state)
+    {
+        for (auto&& item : mySet)
+        {
+            v = item;
+        }
+    }
+}
+
 static void BM_StlHashSetLoop(benchmark::State& state)
 {
     std::unordered_set<uint32> mySet;
@@ -197,6 +440,237 @@ static void BM_StlSetLoop(benchmark::State& state)
     }
 }
 
+/** half of the lookups hit, keys spread by a stride like handles or pointers */
+template <typename SetType, typename ContainsType>
+static void RunSetFindBenchmark(benchmark::State& state, const ContainsType& contains)
+{
+    const uint32 count = static_cast<uint32>(state.range(0));
+    SetType mySet;
+    for (uint32 i = 0; i < count; i++)
+    {
+        mySet.insert(i * 16);
+    }
+
+    for (auto _ : state)
+    {
+        uint32 found = 0;
+        for (uint32 i = 0; i < count * 2; i++)
+        {
+            found += contains(mySet, i * 8) ? 1 : 0;
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(state.iterations() * count * 2);
+}
+
+/** adapts Add to the insert of std containers */
+template <typename SetType>
+struct InsertAdapter : SetType
+{
+    void insert(uint32 value) { SetType::Add(value); }
+};
+
+static void BM_SetFind(benchmark::State& state)
+{
+    RunSetFindBenchmark<InsertAdapter<Set<uint32>>>(state, [](const auto& set, uint32 key) { return set.Contains(key); });
+}
+
+static void BM_FlatSetFind(benchmark::State& state)
+{
+    RunSetFindBenchmark<InsertAdapter<FlatSet<uint32>>>(state, [](const auto& set, uint32 key) { return set.Contains(key); });
+}
+
+static void BM_StlHashSetFind(benchmark::State& state)
+{
+    RunSetFindBenchmark<std::unordered_set<uint32>>(state, [](const auto& set, uint32 key) { return set.find(key) != set.end(); });
+}
+
+/** small table lookups, same key pattern as RunSetFindBenchmark */
+template <typename MapType>
+static void RunMapFindBenchmark(benchmark::State& state, const MapType& myMap)
+{
+    const uint32 count = static_cast<uint32>(state.range(0));
+    for (auto _ : state)
+    {
+        uint32 found = 0;
+        for (uint32 i = 0; i < count * 2; i++)
+        {
+            const uint64* value = myMap.Find(i * 8);
+            found += value ? static_cast<uint32>(*value) : 0;
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(state.iterations() * count * 2);
+}
+
+static void BM_MapFind(benchmark::State& state)
+{
+    Map<uint32, uint64> myMap;
+    for (uint32 i = 0; i < static_cast<uint32>(state.range(0)); i++)
+    {
+        myMap.Add(i * 16, i);
+    }
+    RunMapFindBenchmark(state, myMap);
+}
+
+static void BM_SortedFlatMapFind(benchmark::State& state)
+{
+    DynamicArray<Pair<uint32, uint64>> pairs;
+    for (uint32 i = static_cast<uint32>(state.range(0)); i > 0; i--)
+    {
+        pairs.Add(Pair<uint32, uint64>((i - 1) * 16, i - 1));
+    }
+    const SortedFlatMap<uint32, uint64> myMap(MoveTemp(pairs));
+    RunMapFindBenchmark(state, myMap);
+}
+
+/** build a table from unsorted keys, like loading a config section */
+static void BM_MapBuild(benchmark::State& state)
+{
+    const uint32 count = static_cast<uint32>(state.range(0));
+    for (auto _ : state)
+    {
+        Map<uint32, uint64> myMap;
+        myMap.Reserve(static_cast<int32>(count));
+        for (uint32 i = 0; i < count; i++)
+        {
+            const uint32 key = (i * 2654435761u) >> 8;
+            myMap.Add(key, i);
+        }
+        benchmark::DoNotOptimize(myMap.Size());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+static void BM_SortedFlatMapBuild(benchmark::State& state)
+{
+    const uint32 count = static_cast<uint32>(state.range(0));
+    for (auto _ : state)
+    {
+        DynamicArray<Pair<uint32, uint64>> pairs(static_cast<int32>(count));
+        for (uint32 i = 0; i < count; i++)
+        {
+            const uint32 key = (i * 2654435761u) >> 8;
+            pairs.Add(Pair<uint32, uint64>(key, i));
+        }
+        SortedFlatMap<uint32, uint64> myMap(MoveTemp(pairs));
+        benchmark::DoNotOptimize(myMap.Size());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+/** config like names, half of the looked up ones are in the map */
+static std::vector<std::string> MakeConfigNames(uint32 count)
+{
+    std::vector<std::string> names;
+    for (uint32 i = 0; i < count; i++)
+    {
+        names.push_back("r.Render.Setting." + std::to_string(i));
+    }
+    return names;
+}
+
+struct StdStringMapKeyFunc : MapDefaultHashFunc<std::string, uint64>
+{
+    static uint32 GetHashCode(const std::string& key) { return (uint32)std::hash<std::string>()(key); }
+};
+
+template <typename MapType>
+static void RunMapFindStringBenchmark(benchmark::State& state, const MapType& myMap)
+{
+    const std::vector<std::string> names = MakeConfigNames(static_cast<uint32>(state.range(0)) * 2);
+    for (auto _ : state)
+    {
+        uint64 found = 0;
+        for (const std::string& name : names)
+        {
+            const uint64* value = myMap.Find(name);
+            found += value ? *value : 0;
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(state.iterations() * names.size());
+}
+
+static void BM_MapFindString(benchmark::State& state)
+{
+    Map<std::string, uint64, StdStringMapKeyFunc> myMap;
+    const std::vector<std::string> names = MakeConfigNames(static_cast<uint32>(state.range(0)));
+    for (uint64 i = 0; i < names.size(); i++)
+    {
+        myMap.Add(names[i], i);
+    }
+    RunMapFindStringBenchmark(state, myMap);
+}
+
+static void BM_SortedFlatMapFindString(benchmark::State& state)
+{
+    DynamicArray<Pair<std::string, uint64>> pairs;
+    const std::vector<std::string> names = MakeConfigNames(static_cast<uint32>(state.range(0)));
+    for (uint64 i = 0; i < names.size(); i++)
+    {
+        pairs.Add(Pair<std::string, uint64>(names[i], i));
+    }
+    const SortedFlatMap<std::string, uint64> myMap(MoveTemp(pairs));
+    RunMapFindStringBenchmark(state, myMap);
+}
+
+static void BM_MapAdd(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        Map<uint32, uint64> myMap;
+        for (uint32 i = 0; i < 1000; i++)
+        {
+            myMap.Add(i, i);
+        }
+    }
+}
+
+static void BM_FlatMapAdd(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        FlatMap<uint32, uint64> myMap;
+        for (uint32 i = 0; i < 1000; i++)
+        {
+            myMap.Add(i, i);
+        }
+    }
+}
+
+static void BM_StlHashMapAdd(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        std::unordered_map<uint32, uint64> myMap;
+        for (uint32 i = 0; i < 1000; i++)
+        {
+            myMap.emplace(i, i);
+        }
+    }
+}
+
+static void BM_HashBytes(benchmark::State& state)
+{
+    const std::string text(state.range(0), 'x');
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(HashBytes(text.data(), text.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_StdHashBytes(benchmark::State& state)
+{
+    const std::string text(state.range(0), 'x');
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(std::hash<std::string_view>()(text));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
 static void BM_StdString(benchmark::State& state)
 {
     for (auto _ : state)
@@ -270,17 +744,49 @@ static void BM_UStringFromLatin1(benchmark::State& state)
 //BENCHMARK(BM_DyanmicArrayRemove);
 //BENCHMARK(BM_VectorRemove);
 //
-//BENCHMARK(BM_DyanmicArrayLoop);
-//BENCHMARK(BM_VectorLoop);
+BENCHMARK(BM_DyanmicArrayRemoveMatch)->Arg(10)->Arg(50)->Arg(90);
+BENCHMARK(BM_DyanmicArrayRemoveAllSwap)->Arg(10)->Arg(50)->Arg(90);
+BENCHMARK(BM_VectorEraseIf)->Arg(10)->Arg(50)->Arg(90);
+
+BENCHMARK(BM_DyanmicArrayLoop);
+BENCHMARK(BM_VectorLoop);
+
+BENCHMARK(BM_DynamicArrayTempList)->Arg(4)->Arg(16)->Arg(64);
+BENCHMARK(BM_InlineArrayTempList)->Arg(4)->Arg(16)->Arg(64);
+BENCHMARK(BM_VectorTempList)->Arg(4)->Arg(16)->Arg(64);
 //
-//BENCHMARK(BM_SetAdd);
-//BENCHMARK(BM_StlHashSetAdd);
+BENCHMARK(BM_SetAdd);
+BENCHMARK(BM_FlatSetAdd);
+BENCHMARK(BM_StlHashSetAdd);
 //BENCHMARK(BM_StlSetAdd);
-//
-//BENCHMARK(BM_SetLoop);
-//BENCHMARK(BM_StlHashSetLoop);
+
+BENCHMARK(BM_SetLoop);
+BENCHMARK(BM_SetLoopAfterRemove)->Arg(0)->Arg(1);
+BENCHMARK(BM_FlatSetLoop);
+BENCHMARK(BM_StlHashSetLoop);
 //BENCHMARK(BM_StlSetLoop);
 
+BENCHMARK(BM_SetWorstInsert)->Arg(100000)->Arg(500000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_IncrementalSetWorstInsert)->Arg(100000)->Arg(500000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_SetFind)->Arg(16)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_FlatSetFind)->Arg(16)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_StlHashSetFind)->Arg(16)->Arg(1000)->Arg(100000);
+
+BENCHMARK(BM_MapFind)->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK(BM_SortedFlatMapFind)->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK(BM_MapFindString)->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK(BM_SortedFlatMapFindString)->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK(BM_MapBuild)->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK(BM_SortedFlatMapBuild)->RangeMultiplier(4)->Range(4, 1024);
+
+BENCHMARK(BM_MapAdd);
+BENCHMARK(BM_FlatMapAdd);
+BENCHMARK(BM_StlHashMapAdd);
+
+BENCHMARK(BM_HashBytes)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_StdHashBytes)->RangeMultiplier(8)->Range(8, 4096);
+
 BENCHMARK(BM_StdString);
 BENCHMARK(BM_UString);
 
@@ -0,0 +1,409 @@
+#include "benchmark/benchmark.h"
+#include "memory/ansi_c_malloc.hpp"
+#include "memory/binned_malloc.hpp"
+#include "memory/object_pool.hpp"
+#include "memory/memory.hpp"
+#include "memory/memory_tracker.hpp"
+#include "memory/platform_memory.hpp"
+#include "foundation/dynamic_array.hpp"
+#include "foundation/ustring.hpp"
+#include <algorithm>
+
+using namespace Engine;
+
+static constexpr uint32 kChurnCount = 1024;
+
+template <typename MallocType>
+static IMalloc* GetBenchmarkMalloc()
+{
+    static MallocType instance;
+    return &instance;
+}
+
+/** allocate then free many small blocks with mixed size, like nodes and small strings */
+template <typename MallocType>
+static void BM_SmallChurn(benchmark::State& state)
+{
+    IMalloc* allocator = GetBenchmarkMalloc<MallocType>();
+    const uint32 alignment = PlatformMemory::GetDefaultAlignment();
+    void* ptrs[kChurnCount];
+
+    for (auto _ : state)
+    {
+        for (uint32 i = 0; i < kChurnCount; i++)
+        {
+            ptrs[i] = allocator->Malloc(16 + (i * 7) % 240, alignment);
+        }
+
+        for (uint32 i = 0; i < kChurnCount; i += 2)
+        {
+            allocator->Free(ptrs[i]);
+        }
+
+        for (uint32 i = 1; i < kChurnCount; i += 2)
+        {
+            allocator->Free(ptrs[i]);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * kChurnCount);
+}
+
+/** grow a buffer with Realloc like DynamicArray::Add does */
+template <typename MallocType>
+static void BM_ReallocGrowth(benchmark::State& state)
+{
+    IMalloc* allocator = GetBenchmarkMalloc<MallocType>();
+    const uint32 alignment = PlatformMemory::GetDefaultAlignment();
+
+    for (auto _ : state)
+    {
+        size_t capacity = 4 * sizeof(uint32);
+        void* ptr = allocator->Malloc(capacity, alignment);
+        while (capacity < 64 * 1024)
+        {
+            capacity = capacity * 3 / 2 + 16;
+            ptr = allocator->Realloc(ptr, capacity, alignment);
+        }
+        benchmark::DoNotOptimize(ptr);
+        allocator->Free(ptr);
+    }
+}
+
+/** allocation pattern of short strings, 2 byte chars between 8 and 64 length */
+template <typename MallocType>
+static void BM_StringSizes(benchmark::State& state)
+{
+    IMalloc* allocator = GetBenchmarkMalloc<MallocType>();
+    void* ptrs[kChurnCount];
+
+    for (auto _ : state)
+    {
+        for (uint32 i = 0; i < kChurnCount; i++)
+        {
+            ptrs[i] = allocator->Malloc((8 + i % 57) * 2, 8);
+        }
+
+        for (uint32 i = 0; i < kChurnCount; i++)
+        {
+            allocator->Free(ptrs[kChurnCount - 1 - i]);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * kChurnCount);
+}
+
+/** BM_SmallChurn through TrackingMalloc, the difference is the cost of PL_MEMORY_TRACKER */
+template <typename MallocType>
+static void BM_TrackedSmallChurn(benchmark::State& state)
+{
+    static TrackingMalloc tracking(new MallocType());
+    MemoryTagScope scope(EMemoryTag::Strings);
+    const uint32 alignment = PlatformMemory::GetDefaultAlignment();
+    void* ptrs[kChurnCount];
+
+    for (auto _ : state)
+    {
+        for (uint32 i = 0; i < kChurnCount; i++)
+        {
+            ptrs[i] = tracking.Malloc(16 + (i * 7) % 240, alignment);
+        }
+
+        for (uint32 i = 0; i < kChurnCount; i += 2)
+        {
+            tracking.Free(ptrs[i]);
+        }
+
+        for (uint32 i = 1; i < kChurnCount; i += 2)
+        {
+            tracking.Free(ptrs[i]);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * kChurnCount);
+}
+
+/** every thread allocates and frees its own blocks */
+template <typename MallocType>
+static void BM_ThreadedChurn(benchmark::State& state)
+{
+    IMalloc* allocator = GetBenchmarkMalloc<MallocType>();
+    const uint32 alignment = PlatformMemory::GetDefaultAlignment();
+    void* ptrs[kChurnCount];
+
+    for (auto _ : state)
+    {
+        for (uint32 i = 0; i < kChurnCount; i++)
+        {
+            ptrs[i] = allocator->Malloc(16 + (i * 13) % 496, alignment);
+        }
+
+        for (uint32 i = 0; i < kChurnCount; i++)
+        {
+            allocator->Free(ptrs[i]);
+        }
+    }
+
+    allocator->ClearCurrentThreadTLS();
+    state.SetItemsProcessed(state.iterations() * kChurnCount);
+}
+
+#ifdef PL_BINNED_MALLOC
+static constexpr const char* kGlobalMallocName = "BinnedMalloc";
+#else
+static constexpr const char* kGlobalMallocName = "AnsiCMalloc";
+#endif
+
+/**
+ * Many short DynamicArrays grown by Add and freed, containers always allocate through GMalloc so build with
+ * binned_malloc on and off to compare.
+ */
+static void BM_DynamicArrayChurn(benchmark::State& state)
+{
+    DynamicArray<DynamicArray<int32>> arrays;
+    arrays.Reserve(kChurnCount);
+
+    for (auto _ : state)
+    {
+        for (uint32 i = 0; i < kChurnCount; i++)
+        {
+            DynamicArray<int32>& array = arrays.AddDefault();
+            for (uint32 j = 0; j < 1 + i % 24; j++)
+            {
+                array.Add((int32)j);
+            }
+        }
+        arrays.Clear(kChurnCount);
+    }
+
+    state.SetLabel(kGlobalMallocName);
+    state.SetItemsProcessed(state.iterations() * kChurnCount);
+}
+
+/** short UStrings built and appended to, like names and paths, through GMalloc as BM_DynamicArrayChurn */
+static void BM_UStringChurn(benchmark::State& state)
+{
+    DynamicArray<UString> strings;
+    strings.Reserve(kChurnCount);
+
+    for (auto _ : state)
+    {
+        for (uint32 i = 0; i < kChurnCount; i++)
+        {
+            UString& str = strings.AddDefault();
+            str.Append("entity_");
+            for (uint32 j = 0; j < i % 8; j++)
+            {
+                str.Append("part");
+            }
+        }
+        strings.Clear(kChurnCount);
+    }
+
+    state.SetLabel(kGlobalMallocName);
+    state.SetItemsProcessed(state.iterations() * kChurnCount);
+}
+
+/**
+ * Footprint of small allocations in both modes of AnsiCMalloc, the median distance between neighbour blocks
+ * includes header and crt bookkeeping. Arg 0 is EAnsiMallocMode, arg 1 is the requested size.
+ */
+static void BM_AnsiMallocOverhead(benchmark::State& state)
+{
+    AnsiCMalloc allocator((EAnsiMallocMode)state.range(0));
+    const size_t size = (size_t)state.range(1);
+    const uint32 alignment = PlatformMemory::GetDefaultAlignment();
+    void* ptrs[kChurnCount];
+
+    for (auto _ : state)
+    {
+        for (uint32 i = 0; i < kChurnCount; i++)
+        {
+            ptrs[i] = allocator.Malloc(size, alignment);
+        }
+
+        for (uint32 i = 0; i < kChurnCount; i++)
+        {
+            allocator.Free(ptrs[i]);
+        }
+    }
+
+    uintptr_t addresses[kChurnCount];
+    for (uint32 i = 0; i < kChurnCount; i++)
+    {
+        ptrs[i] = allocator.Malloc(size, alignment);
+        addresses[i] = (uintptr_t)ptrs[i];
+    }
+    std::sort(addresses, addresses + kChurnCount);
+
+    uintptr_t gaps[kChurnCount - 1];
+    for (uint32 i = 0; i + 1 < kChurnCount; i++)
+    {
+        gaps[i] = addresses[i + 1] - addresses[i];
+    }
+    std::nth_element(gaps, gaps + kChurnCount / 2, gaps + kChurnCount - 1);
+
+    for (uint32 i = 0; i < kChurnCount; i++)
+    {
+        allocator.Free(ptrs[i]);
+    }
+
+    state.counters["BytesPerAlloc"] = (double)gaps[kChurnCount / 2];
+    state.counters["Overhead"] = (double)gaps[kChurnCount / 2] - (double)size;
+    state.SetItemsProcessed(state.iterations() * kChurnCount);
+}
+
+static constexpr uint32 kCallBatch = 64;
+
+/** entry used by containers, with PL_STATIC_MALLOC it should match BM_DirectMallocFree */
+static void BM_MemoryMallocFree(benchmark::State& state)
+{
+    void* ptrs[kCallBatch];
+    for (auto _ : state)
+    {
+        for (uint32 i = 0; i < kCallBatch; i++)
+        {
+            ptrs[i] = Memory::Malloc(32);
+        }
+
+        for (uint32 i = 0; i < kCallBatch; i++)
+        {
+            Memory::Free(ptrs[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kCallBatch);
+}
+
+/** concrete final malloc, no virtual dispatch and no lazy creation check */
+template <typename MallocType>
+static void BM_DirectMallocFree(benchmark::State& state)
+{
+    MallocType* allocator = static_cast<MallocType*>(GetBenchmarkMalloc<MallocType>());
+    const uint32 alignment = PlatformMemory::GetDefaultAlignment();
+    void* ptrs[kCallBatch];
+    for (auto _ : state)
+    {
+        for (uint32 i = 0; i < kCallBatch; i++)
+        {
+            ptrs[i] = allocator->Malloc(32, alignment);
+        }
+
+        for (uint32 i = 0; i < kCallBatch; i++)
+        {
+            allocator->Free(ptrs[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kCallBatch);
+}
+
+/** same malloc through IMalloc, what Memory::Malloc does without PL_STATIC_MALLOC */
+template <typename MallocType>
+static void BM_VirtualMallocFree(benchmark::State& state)
+{
+    IMalloc* allocator = GetBenchmarkMalloc<MallocType>();
+    benchmark::DoNotOptimize(allocator);
+    const uint32 alignment = PlatformMemory::GetDefaultAlignment();
+    void* ptrs[kCallBatch];
+    for (auto _ : state)
+    {
+        for (uint32 i = 0; i < kCallBatch; i++)
+        {
+            ptrs[i] = allocator->Malloc(32, alignment);
+        }
+
+        for (uint32 i = 0; i < kCallBatch; i++)
+        {
+            allocator->Free(ptrs[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kCallBatch);
+}
+
+/** object of the size of a small component or handle */
+struct PooledObject
+{
+    explicit PooledObject(uint64 id) : Id(id) {}
+
+    uint64 Id;
+    uint8 Payload[56];
+};
+
+struct NewDeletePolicy
+{
+    PooledObject* New(uint64 id) { return new PooledObject(id); }
+    void Delete(PooledObject* object) { delete object; }
+};
+
+template <bool ThreadSafe>
+struct ObjectPoolPolicy
+{
+    PooledObject* New(uint64 id) { return Pool.New(id); }
+    void Delete(PooledObject* object) { Pool.Delete(object); }
+
+    ObjectPool<PooledObject, ThreadSafe> Pool;
+};
+
+template <typename PolicyType>
+static PolicyType& GetPoolPolicy()
+{
+    static PolicyType instance;
+    return instance;
+}
+
+/** keep a live set and replace half of it every iteration in scattered order, like spawning and destroying entities */
+template <typename PolicyType>
+static void BM_PoolChurn(benchmark::State& state)
+{
+    PolicyType& policy = GetPoolPolicy<PolicyType>();
+    PooledObject* objects[kChurnCount];
+    for (uint32 i = 0; i < kChurnCount; i++)
+    {
+        objects[i] = policy.New(i);
+    }
+
+    for (auto _ : state)
+    {
+        for (uint32 i = 0; i < kChurnCount; i += 2)
+        {
+            const uint32 index = (i * 7) % kChurnCount;
+            policy.Delete(objects[index]);
+            objects[index] = policy.New(index);
+        }
+        benchmark::DoNotOptimize(objects[0]->Id);
+    }
+
+    for (uint32 i = 0; i < kChurnCount; i++)
+    {
+        policy.Delete(objects[i]);
+    }
+    state.SetItemsProcessed(state.iterations() * kChurnCount / 2);
+}
+
+BENCHMARK(BM_AnsiMallocOverhead)->ArgNames({ "Mode", "Size" })->ArgsProduct({ { (int64)EAnsiMallocMode::Header, (int64)EAnsiMallocMode::Aligned }, { 8, 24, 48, 96 } });
+
+BENCHMARK_TEMPLATE(BM_SmallChurn, AnsiCMalloc);
+BENCHMARK_TEMPLATE(BM_SmallChurn, BinnedMalloc);
+BENCHMARK_TEMPLATE(BM_TrackedSmallChurn, AnsiCMalloc);
+BENCHMARK_TEMPLATE(BM_TrackedSmallChurn, BinnedMalloc);
+
+BENCHMARK_TEMPLATE(BM_ReallocGrowth, AnsiCMalloc);
+BENCHMARK_TEMPLATE(BM_ReallocGrowth, BinnedMalloc);
+
+BENCHMARK_TEMPLATE(BM_StringSizes, AnsiCMalloc);
+BENCHMARK_TEMPLATE(BM_StringSizes, BinnedMalloc);
+
+BENCHMARK_TEMPLATE(BM_ThreadedChurn, AnsiCMalloc)->ThreadRange(1, 8);
+BENCHMARK_TEMPLATE(BM_ThreadedChurn, BinnedMalloc)->ThreadRange(1, 8);
+
+BENCHMARK(BM_DynamicArrayChurn);
+BENCHMARK(BM_UStringChurn);
+
+BENCHMARK_TEMPLATE(BM_PoolChurn, ObjectPoolPolicy<false>);
+BENCHMARK_TEMPLATE(BM_PoolChurn, NewDeletePolicy)->ThreadRange(1, 8);
+BENCHMARK_TEMPLATE(BM_PoolChurn, ObjectPoolPolicy<true>)->ThreadRange(1, 8);
+
+BENCHMARK(BM_MemoryMallocFree);
+BENCHMARK_TEMPLATE(BM_DirectMallocFree, AnsiCMalloc);
+BENCHMARK_TEMPLATE(BM_DirectMallocFree, BinnedMalloc);
+BENCHMARK_TEMPLATE(BM_VirtualMallocFree, AnsiCMalloc);
+BENCHMARK_TEMPLATE(BM_VirtualMallocFree, BinnedMalloc);
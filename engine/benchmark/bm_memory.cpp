@@ -0,0 +1,125 @@
+#include "benchmark/benchmark.h"
+#include "memory/simd_memory.hpp"
+#include <cstring>
+#include <vector>
+
+using namespace Engine;
+
+/** first argument is the ESimdLevel of the kernels, -1 calls libc directly */
+static constexpr int64 kLibc = -1;
+
+static void SetBenchmarkLabel(benchmark::State& state)
+{
+    static const char* const kNames[] = { "libc", "none", "sse2", "avx2", "avx512" };
+    state.SetLabel(kNames[state.range(0) + 1]);
+}
+
+/** skip levels the cpu can not run instead of measuring a clamped one twice */
+static bool SelectLevel(benchmark::State& state)
+{
+    SetBenchmarkLabel(state);
+    if (state.range(0) == kLibc)
+    {
+        return true;
+    }
+
+    const ESimdLevel level = static_cast<ESimdLevel>(state.range(0));
+    if (level > SimdMemory::GetSupportedLevel())
+    {
+        state.SkipWithError("level not supported");
+        return false;
+    }
+    SimdMemory::SetLevel(level);
+    return true;
+}
+
+static void BM_Memcpy(benchmark::State& state)
+{
+    if (!SelectLevel(state))
+    {
+        return;
+    }
+
+    const size_t size = static_cast<size_t>(state.range(1));
+    const bool useLibc = state.range(0) == kLibc;
+    // odd offset so neither buffer starts vector aligned, like elements inside a container
+    std::vector<uint8> src(size + 64, 1);
+    std::vector<uint8> dest(size + 64);
+    for (auto _ : state)
+    {
+        if (useLibc)
+        {
+            ::memcpy(dest.data() + 3, src.data() + 1, size);
+        }
+        else
+        {
+            SimdMemory::Memcpy(dest.data() + 3, src.data() + 1, size);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64>(size));
+}
+
+static void BM_Memset(benchmark::State& state)
+{
+    if (!SelectLevel(state))
+    {
+        return;
+    }
+
+    const size_t size = static_cast<size_t>(state.range(1));
+    const bool useLibc = state.range(0) == kLibc;
+    std::vector<uint8> dest(size + 64);
+    for (auto _ : state)
+    {
+        if (useLibc)
+        {
+            ::memset(dest.data() + 3, 0x5A, size);
+        }
+        else
+        {
+            SimdMemory::Memset(dest.data() + 3, 0x5A, size);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64>(size));
+}
+
+/** equal buffers, the worst case where every byte is read */
+static void BM_Memcmp(benchmark::State& state)
+{
+    if (!SelectLevel(state))
+    {
+        return;
+    }
+
+    const size_t size = static_cast<size_t>(state.range(1));
+    const bool useLibc = state.range(0) == kLibc;
+    std::vector<uint8> lBuffer(size + 64, 7);
+    std::vector<uint8> rBuffer(size + 64, 7);
+    for (auto _ : state)
+    {
+        bool equal;
+        if (useLibc)
+        {
+            equal = ::memcmp(lBuffer.data() + 3, rBuffer.data() + 1, size) == 0;
+        }
+        else
+        {
+            equal = SimdMemory::Memcmp(lBuffer.data() + 3, rBuffer.data() + 1, size);
+        }
+        benchmark::DoNotOptimize(equal);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64>(size));
+}
+
+static void MemoryArguments(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgsProduct({
+        { kLibc, static_cast<int64>(ESimdLevel::Sse2), static_cast<int64>(ESimdLevel::Avx2), static_cast<int64>(ESimdLevel::Avx512) },
+        { 8, 16, 32, 64, 128, 256, 512, 1 << 10, 4 << 10, 16 << 10, 64 << 10, 256 << 10, 1 << 20 } });
+}
+
+BENCHMARK(BM_Memcpy)->Apply(MemoryArguments);
+BENCHMARK(BM_Memset)->Apply(MemoryArguments);
+BENCHMARK(BM_Memcmp)->Apply(MemoryArguments);
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "algo/range_utils.hpp"
+
+namespace Engine::Algo::Private
+{
+    /**
+     * Branchless search, the loop only depends on count so the compare turns into a conditional move
+     * instead of a mispredicted branch.
+     */
+    template <typename ElementType, typename SizeType, typename ValueType, typename PredicateType>
+    SizeType LowerBoundInternal(const ElementType* first, SizeType count, const ValueType& value, PredicateType& predicate)
+    {
+        if (count <= 0)
+        {
+            return 0;
+        }
+
+        const ElementType* base = first;
+        while (count > 1)
+        {
+            const SizeType half = count / 2;
+            base = predicate(base[half], value) ? base + half : base;
+            count -= half;
+        }
+        return (SizeType)(base - first) + (predicate(*base, value) ? 1 : 0);
+    }
+
+    template <typename ElementType, typename SizeType, typename ValueType, typename PredicateType>
+    SizeType UpperBoundInternal(const ElementType* first, SizeType count, const ValueType& value, PredicateType& predicate)
+    {
+        if (count <= 0)
+        {
+            return 0;
+        }
+
+        const ElementType* base = first;
+        while (count > 1)
+        {
+            const SizeType half = count / 2;
+            base = !predicate(value, base[half]) ? base + half : base;
+            count -= half;
+        }
+        return (SizeType)(base - first) + (!predicate(value, *base) ? 1 : 0);
+    }
+
+    /** compare a value with projected elements, LowerBound passes the element first, UpperBound the value */
+    template <typename ProjectionType, typename PredicateType, bool ValueFirst>
+    struct ProjectedValuePredicate
+    {
+        ProjectionType& Projection;
+        PredicateType& Predicate;
+
+        template <typename LeftType, typename RightType>
+        FORCEINLINE bool operator() (const LeftType& lhs, const RightType& rhs) const
+        {
+            if constexpr (ValueFirst)
+            {
+                return Predicate(lhs, std::invoke(Projection, rhs));
+            }
+            else
+            {
+                return Predicate(std::invoke(Projection, lhs), rhs);
+            }
+        }
+    };
+}
+
+namespace Engine::Algo
+{
+    /** index of the first element not ordered before value, size of range if there is none */
+    template <ContiguousRangeType RangeType, typename ValueType, typename PredicateType = std::less<>>
+    auto LowerBound(const RangeType& range, const ValueType& value, PredicateType predicate = {})
+    {
+        return Private::LowerBoundInternal(Private::GetData(range), Private::GetSize(range), value, predicate);
+    }
+
+    /** index of the first element value is ordered before, size of range if there is none */
+    template <ContiguousRangeType RangeType, typename ValueType, typename PredicateType = std::less<>>
+    auto UpperBound(const RangeType& range, const ValueType& value, PredicateType predicate = {})
+    {
+        return Private::UpperBoundInternal(Private::GetData(range), Private::GetSize(range), value, predicate);
+    }
+
+    /** index of an element equal to value in a sorted range, INDEX_NONE cast to the size type if not found */
+    template <ContiguousRangeType RangeType, typename ValueType, typename PredicateType = std::less<>>
+    auto BinarySearch(const RangeType& range, const ValueType& value, PredicateType predicate = {})
+    {
+        const auto* first = Private::GetData(range);
+        const auto count = Private::GetSize(range);
+        using SizeType = std::remove_const_t<decltype(count)>;
+        const SizeType index = Private::LowerBoundInternal(first, count, value, predicate);
+        return index < count && !predicate(value, first[index]) ? index : (SizeType)INDEX_NONE;
+    }
+
+    /** LowerBound of a range sorted by projection, value is compared with projected elements */
+    template <ContiguousRangeType RangeType, typename ValueType, typename ProjectionType, typename PredicateType = std::less<>>
+    auto LowerBoundBy(const RangeType& range, const ValueType& value, ProjectionType projection, PredicateType predicate = {})
+    {
+        Private::ProjectedValuePredicate<ProjectionType, PredicateType, false> projected{ projection, predicate };
+        return Private::LowerBoundInternal(Private::GetData(range), Private::GetSize(range), value, projected);
+    }
+
+    template <ContiguousRangeType RangeType, typename ValueType, typename ProjectionType, typename PredicateType = std::less<>>
+    auto UpperBoundBy(const RangeType& range, const ValueType& value, ProjectionType projection, PredicateType predicate = {})
+    {
+        Private::ProjectedValuePredicate<ProjectionType, PredicateType, true> projected{ projection, predicate };
+        return Private::UpperBoundInternal(Private::GetData(range), Private::GetSize(range), value, projected);
+    }
+}
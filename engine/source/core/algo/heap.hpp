@@ -0,0 +1,130 @@
+#pragma once
+
+#include <utility>
+#include "algo/range_utils.hpp"
+
+namespace Engine::Algo::Private
+{
+    /** move the element at index down until no child is ordered after it */
+    template <typename ElementType, typename PredicateType>
+    void SiftDown(ElementType* first, int64 index, int64 count, PredicateType& predicate)
+    {
+        ElementType value = MoveTemp(first[index]);
+        for (;;)
+        {
+            int64 child = 2 * index + 1;
+            if (child >= count)
+            {
+                break;
+            }
+            if (child + 1 < count && predicate(first[child], first[child + 1]))
+            {
+                ++child;
+            }
+            if (!predicate(value, first[child]))
+            {
+                break;
+            }
+            first[index] = MoveTemp(first[child]);
+            index = child;
+        }
+        first[index] = MoveTemp(value);
+    }
+
+    /** move the element at index up until its parent is not ordered before it */
+    template <typename ElementType, typename PredicateType>
+    void SiftUp(ElementType* first, int64 index, PredicateType& predicate)
+    {
+        ElementType value = MoveTemp(first[index]);
+        while (index > 0)
+        {
+            const int64 parent = (index - 1) / 2;
+            if (!predicate(first[parent], value))
+            {
+                break;
+            }
+            first[index] = MoveTemp(first[parent]);
+            index = parent;
+        }
+        first[index] = MoveTemp(value);
+    }
+
+    template <typename ElementType, typename PredicateType>
+    void HeapifyInternal(ElementType* first, int64 count, PredicateType& predicate)
+    {
+        for (int64 index = count / 2 - 1; index >= 0; --index)
+        {
+            SiftDown(first, index, count, predicate);
+        }
+    }
+
+    template <typename ElementType, typename PredicateType>
+    void HeapSortInternal(ElementType* first, int64 count, PredicateType& predicate)
+    {
+        HeapifyInternal(first, count, predicate);
+        for (int64 last = count - 1; last > 0; --last)
+        {
+            std::swap(first[0], first[last]);
+            SiftDown(first, 0, last, predicate);
+        }
+    }
+}
+
+namespace Engine::Algo
+{
+    /**
+     * Heaps follow std: the first element is the one every other element is ordered before,
+     * the largest one with std::less.
+     */
+    template <ContiguousRangeType RangeType, typename PredicateType = std::less<>>
+    void Heapify(RangeType&& range, PredicateType predicate = {})
+    {
+        Private::HeapifyInternal(Private::GetData(range), (int64)Private::GetSize(range), predicate);
+    }
+
+    /** add the last element of range into the heap formed by the elements before it */
+    template <ContiguousRangeType RangeType, typename PredicateType = std::less<>>
+    void HeapPush(RangeType&& range, PredicateType predicate = {})
+    {
+        const int64 count = (int64)Private::GetSize(range);
+        if (count > 1)
+        {
+            Private::SiftUp(Private::GetData(range), count - 1, predicate);
+        }
+    }
+
+    /** move the top of heap to the end of range, the elements before it form the heap again */
+    template <ContiguousRangeType RangeType, typename PredicateType = std::less<>>
+    void HeapPop(RangeType&& range, PredicateType predicate = {})
+    {
+        const int64 count = (int64)Private::GetSize(range);
+        if (count > 1)
+        {
+            auto* first = Private::GetData(range);
+            std::swap(first[0], first[count - 1]);
+            Private::SiftDown(first, 0, count - 1, predicate);
+        }
+    }
+
+    template <ContiguousRangeType RangeType, typename PredicateType = std::less<>>
+    bool IsHeap(const RangeType& range, PredicateType predicate = {})
+    {
+        const auto* first = Private::GetData(range);
+        const int64 count = (int64)Private::GetSize(range);
+        for (int64 index = 1; index < count; ++index)
+        {
+            if (predicate(first[(index - 1) / 2], first[index]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** in place, O(n log n) worst case, not stable */
+    template <ContiguousRangeType RangeType, typename PredicateType = std::less<>>
+    void HeapSort(RangeType&& range, PredicateType predicate = {})
+    {
+        Private::HeapSortInternal(Private::GetData(range), (int64)Private::GetSize(range), predicate);
+    }
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <thread>
+#include <utility>
+#include "algo/range_utils.hpp"
+#include "algo/binary_search.hpp"
+#include "algo/sort.hpp"
+#include "math/generic_math.hpp"
+#include "memory/memory.hpp"
+#include "memory/memory_ops.hpp"
+
+namespace Engine::Algo::Private
+{
+    /** below it thread start up costs more than sorting on one thread */
+    constexpr int64 kParallelSortThreshold = 64 * 1024;
+    /** smallest count of elements a task sorts */
+    constexpr int64 kMinParallelChunk = 16 * 1024;
+    constexpr int32 kMaxParallelTasks = 64;
+
+    /** run task(index) for every index below taskCount, index 0 runs on calling thread */
+    template <typename TaskType>
+    void ParallelFor(int32 taskCount, const TaskType& task)
+    {
+        ENSURE(taskCount > 0 && taskCount <= kMaxParallelTasks);
+        std::thread threads[kMaxParallelTasks];
+        for (int32 index = 1; index < taskCount; ++index)
+        {
+            threads[index] = std::thread(task, index);
+        }
+        task(0);
+        for (int32 index = 1; index < taskCount; ++index)
+        {
+            threads[index].join();
+        }
+    }
+
+    /** count of elements taken from left among the first outputCount outputs of merging left and right */
+    template <typename ElementType, typename PredicateType>
+    int64 MergeSplit(const ElementType* left, int64 leftCount, const ElementType* right, int64 rightCount, int64 outputCount, PredicateType& predicate)
+    {
+        int64 low = Math::Max<int64>(0, outputCount - rightCount);
+        int64 high = Math::Min(outputCount, leftCount);
+        while (low < high)
+        {
+            const int64 leftTaken = low + (high - low) / 2;
+            // left wins ties, so it takes more while its next element is not after the last right one
+            if (!predicate(right[outputCount - leftTaken - 1], left[leftTaken]))
+            {
+                low = leftTaken + 1;
+            }
+            else
+            {
+                high = leftTaken;
+            }
+        }
+        return low;
+    }
+
+    /** relocate two sorted runs into raw dest */
+    template <typename ElementType, typename PredicateType>
+    void MergeRelocate(ElementType* left, int64 leftCount, ElementType* right, int64 rightCount, ElementType* dest, PredicateType& predicate)
+    {
+        ElementType* const leftEnd = left + leftCount;
+        ElementType* const rightEnd = right + rightCount;
+        while (left != leftEnd && right != rightEnd)
+        {
+            if (predicate(*right, *left))
+            {
+                RelocateElement(dest++, right++);
+            }
+            else
+            {
+                RelocateElement(dest++, left++);
+            }
+        }
+        RelocateElements(dest, left, leftEnd - left);
+        RelocateElements(dest + (leftEnd - left), right, rightEnd - right);
+    }
+
+    /**
+     * Every task sorts a chunk, then runs are merged pairwise between range and buffer.
+     * Every merge is split by output position so all tasks stay busy on the last merges too.
+     */
+    template <typename ElementType, typename PredicateType>
+    void ParallelSortInternal(ElementType* first, int64 count, int32 taskCount, PredicateType& predicate)
+    {
+        taskCount = (int32)Math::Min<int64>(Math::Min(taskCount, kMaxParallelTasks), count / kMinParallelChunk);
+        if (count < kParallelSortThreshold || taskCount < 2)
+        {
+            IntroSort(first, count, predicate);
+            return;
+        }
+
+        // power of two chunks merge in pairs without leftovers
+        const int32 chunkCount = (int32)std::bit_floor((uint32)taskCount);
+        auto chunkBegin = [count, chunkCount](int64 chunk) {
+            return count * chunk / chunkCount;
+        };
+
+        ParallelFor(chunkCount, [&](int32 chunk) {
+            IntroSort(first + chunkBegin(chunk), chunkBegin(chunk + 1) - chunkBegin(chunk), predicate);
+        });
+
+        ElementType* buffer = (ElementType*)Memory::Malloc(count * sizeof(ElementType), Math::Max<uint32>(alignof(ElementType), PlatformMemory::GetDefaultAlignment()));
+        ElementType* src = first;
+        ElementType* dest = buffer;
+        for (int32 runChunks = 1; runChunks < chunkCount; runChunks *= 2)
+        {
+            // split points are found before any element moves, tasks would read relocated elements otherwise
+            const int32 piecesPerMerge = 2 * runChunks;
+            int64 leftSplits[kMaxParallelTasks + 1];
+            for (int32 task = 0; task < chunkCount; ++task)
+            {
+                const int32 merge = task / piecesPerMerge;
+                const int64 leftBegin = chunkBegin(merge * piecesPerMerge);
+                const int64 rightBegin = chunkBegin(merge * piecesPerMerge + runChunks);
+                const int64 rightEnd = chunkBegin((merge + 1) * piecesPerMerge);
+                const int64 outputCount = (rightEnd - leftBegin) * (task % piecesPerMerge) / piecesPerMerge;
+                leftSplits[task] = MergeSplit(src + leftBegin, rightBegin - leftBegin, src + rightBegin, rightEnd - rightBegin, outputCount, predicate);
+            }
+
+            ParallelFor(chunkCount, [&](int32 task) {
+                const int32 merge = task / piecesPerMerge;
+                const int32 piece = task % piecesPerMerge;
+                const int64 leftBegin = chunkBegin(merge * piecesPerMerge);
+                const int64 rightBegin = chunkBegin(merge * piecesPerMerge + runChunks);
+                const int64 rightEnd = chunkBegin((merge + 1) * piecesPerMerge);
+                const int64 total = rightEnd - leftBegin;
+                const int64 outputBegin = total * piece / piecesPerMerge;
+                const int64 outputEnd = total * (piece + 1) / piecesPerMerge;
+                const int64 leftTakenBegin = leftSplits[task];
+                const int64 leftTakenEnd = piece + 1 < piecesPerMerge ? leftSplits[task + 1] : rightBegin - leftBegin;
+                const int64 rightTakenBegin = outputBegin - leftTakenBegin;
+                const int64 rightTakenEnd = outputEnd - leftTakenEnd;
+                MergeRelocate(src + leftBegin + leftTakenBegin, leftTakenEnd - leftTakenBegin,
+                    src + rightBegin + rightTakenBegin, rightTakenEnd - rightTakenBegin,
+                    dest + leftBegin + outputBegin, predicate);
+            });
+            std::swap(src, dest);
+        }
+
+        if (src != first)
+        {
+            ParallelFor(chunkCount, [&](int32 chunk) {
+                RelocateElements(first + chunkBegin(chunk), src + chunkBegin(chunk), chunkBegin(chunk + 1) - chunkBegin(chunk));
+            });
+        }
+        Memory::Free(buffer);
+    }
+}
+
+namespace Engine::Algo
+{
+    /**
+     * Sort on up to taskCount threads, 0 uses every hardware thread. Small ranges are sorted on calling thread.
+     * Not stable, predicate is called from several threads at once and needs a buffer as large as the range.
+     */
+    template <ContiguousRangeType RangeType, typename PredicateType = std::less<>>
+    void ParallelSort(RangeType&& range, PredicateType predicate = {}, int32 taskCount = 0)
+    {
+        if (taskCount <= 0)
+        {
+            taskCount = (int32)std::thread::hardware_concurrency();
+        }
+        Private::ParallelSortInternal(Private::GetData(range), (int64)Private::GetSize(range), taskCount, predicate);
+    }
+}
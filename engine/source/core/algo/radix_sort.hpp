@@ -0,0 +1,128 @@
+#pragma once
+
+#include <bit>
+#include <type_traits>
+#include "algo/range_utils.hpp"
+#include "algo/sort.hpp"
+#include "math/generic_math.hpp"
+#include "memory/memory.hpp"
+#include "memory/memory_ops.hpp"
+
+namespace Engine::Algo
+{
+    /** keys RadixSort can order: integers of any width, float and double */
+    template <typename KeyType>
+    concept RadixKeyType = (std::is_integral_v<KeyType> && !std::is_same_v<KeyType, bool>) || std::is_same_v<KeyType, float> || std::is_same_v<KeyType, double>;
+}
+
+namespace Engine::Algo::Private
+{
+    /** below it insertion sort is faster than building histograms */
+    constexpr int64 kRadixSortThreshold = 64;
+
+    /** map key to an unsigned integer of the same width whose order is the order of key */
+    template <typename KeyType>
+    FORCEINLINE auto ToRadixKey(KeyType key)
+    {
+        if constexpr (std::is_floating_point_v<KeyType>)
+        {
+            using UIntType = std::conditional_t<sizeof(KeyType) == 4, uint32, uint64>;
+            constexpr UIntType signBit = UIntType(1) << (sizeof(UIntType) * 8 - 1);
+            const UIntType bits = std::bit_cast<UIntType>(key);
+            // negative floats are stored as magnitude, flipping every bit reverses their order
+            return (bits & signBit) ? (UIntType)~bits : (UIntType)(bits | signBit);
+        }
+        else
+        {
+            using UIntType = std::make_unsigned_t<KeyType>;
+            if constexpr (std::is_signed_v<KeyType>)
+            {
+                return (UIntType)((UIntType)key ^ (UIntType(1) << (sizeof(UIntType) * 8 - 1)));
+            }
+            else
+            {
+                return (UIntType)key;
+            }
+        }
+    }
+
+    /**
+     * LSD radix sort on 8 bit digits, histograms of all digits are built in one read,
+     * digits every key shares are skipped. Elements ping-pong between range and a buffer of the same size.
+     */
+    template <typename ElementType, typename ProjectionType>
+    void RadixSortInternal(ElementType* first, int64 count, ProjectionType& projection)
+    {
+        using KeyType = std::decay_t<std::invoke_result_t<ProjectionType&, const ElementType&>>;
+        static_assert(RadixKeyType<KeyType>, "radix sort needs integer or floating point keys");
+        constexpr int32 kPassCount = sizeof(KeyType);
+
+        auto getDigit = [&projection](const ElementType& element, int32 pass) -> uint32 {
+            return (uint32)(ToRadixKey(std::invoke(projection, element)) >> (pass * 8)) & 0xFF;
+        };
+
+        if (count <= kRadixSortThreshold)
+        {
+            auto keyLess = [&projection](const ElementType& lhs, const ElementType& rhs) {
+                return ToRadixKey(std::invoke(projection, lhs)) < ToRadixKey(std::invoke(projection, rhs));
+            };
+            InsertionSort(first, count, keyLess);
+            return;
+        }
+
+        int64 histograms[kPassCount][256] = {};
+        for (int64 index = 0; index < count; ++index)
+        {
+            const auto key = ToRadixKey(std::invoke(projection, first[index]));
+            for (int32 pass = 0; pass < kPassCount; ++pass)
+            {
+                ++histograms[pass][(key >> (pass * 8)) & 0xFF];
+            }
+        }
+
+        ElementType* buffer = (ElementType*)Memory::Malloc(count * sizeof(ElementType), Math::Max<uint32>(alignof(ElementType), PlatformMemory::GetDefaultAlignment()));
+        ElementType* src = first;
+        ElementType* dest = buffer;
+        for (int32 pass = 0; pass < kPassCount; ++pass)
+        {
+            int64* histogram = histograms[pass];
+            if (histogram[getDigit(src[0], pass)] == count)
+            {
+                continue;
+            }
+
+            int64 offset = 0;
+            for (int32 digit = 0; digit < 256; ++digit)
+            {
+                const int64 digitCount = histogram[digit];
+                histogram[digit] = offset;
+                offset += digitCount;
+            }
+
+            for (int64 index = 0; index < count; ++index)
+            {
+                RelocateElement(dest + histogram[getDigit(src[index], pass)]++, src + index);
+            }
+            std::swap(src, dest);
+        }
+
+        if (src != first)
+        {
+            RelocateElements(first, src, count);
+        }
+        Memory::Free(buffer);
+    }
+}
+
+namespace Engine::Algo
+{
+    /**
+     * Stable O(n) sort on the integer or floating point key projection returns, default key is the element itself.
+     * Needs a temporary buffer as large as the range, -0.0 is ordered before 0.0 and NaN by its bits.
+     */
+    template <ContiguousRangeType RangeType, typename ProjectionType = std::identity>
+    void RadixSort(RangeType&& range, ProjectionType projection = {})
+    {
+        Private::RadixSortInternal(Private::GetData(range), (int64)Private::GetSize(range), projection);
+    }
+}
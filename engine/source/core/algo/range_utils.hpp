@@ -0,0 +1,51 @@
+#pragma once
+
+#include <functional>
+#include <ranges>
+#include "definitions_core.hpp"
+#include "global.hpp"
+#include "foundation/type_traits.hpp"
+
+namespace Engine::Algo
+{
+    /** ranges the algorithms work on in place: DynamicArray, std::span of a part of it, std::vector, c arrays */
+    template <typename RangeType>
+    concept ContiguousRangeType = std::ranges::contiguous_range<RangeType> && std::ranges::sized_range<RangeType>;
+}
+
+namespace Engine::Algo::Private
+{
+    template <typename RangeType>
+    FORCEINLINE auto GetData(RangeType& range)
+    {
+        return std::ranges::data(range);
+    }
+
+    /** size in the index type of the range, so results index DynamicArray without casts */
+    template <typename RangeType>
+    FORCEINLINE auto GetSize(const RangeType& range)
+    {
+        if constexpr (requires { range.Size(); })
+        {
+            return range.Size();
+        }
+        else
+        {
+            return std::ranges::size(range);
+        }
+    }
+
+    /** compare projected values of both sides */
+    template <typename ProjectionType, typename PredicateType>
+    struct ProjectedPredicate
+    {
+        ProjectionType& Projection;
+        PredicateType& Predicate;
+
+        template <typename LeftType, typename RightType>
+        FORCEINLINE bool operator() (LeftType&& lhs, RightType&& rhs) const
+        {
+            return Predicate(std::invoke(Projection, Forward<LeftType>(lhs)), std::invoke(Projection, Forward<RightType>(rhs)));
+        }
+    };
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <bit>
+#include <utility>
+#include "algo/range_utils.hpp"
+#include "algo/heap.hpp"
+
+namespace Engine::Algo::Private
+{
+    /** partitions at most this large are finished by insertion sort */
+    constexpr int64 kInsertionSortThreshold = 16;
+
+    /** stable, used for small inputs by every sort */
+    template <typename ElementType, typename PredicateType>
+    void InsertionSort(ElementType* first, int64 count, PredicateType& predicate)
+    {
+        for (int64 index = 1; index < count; ++index)
+        {
+            if (predicate(first[index], first[index - 1]))
+            {
+                ElementType value = MoveTemp(first[index]);
+                int64 hole = index;
+                do
+                {
+                    first[hole] = MoveTemp(first[hole - 1]);
+                    --hole;
+                } while (hole > 0 && predicate(value, first[hole - 1]));
+                first[hole] = MoveTemp(value);
+            }
+        }
+    }
+
+    template <typename ElementType, typename PredicateType>
+    FORCEINLINE void SortThree(ElementType& a, ElementType& b, ElementType& c, PredicateType& predicate)
+    {
+        if (predicate(b, a))
+        {
+            std::swap(a, b);
+        }
+        if (predicate(c, b))
+        {
+            std::swap(b, c);
+            if (predicate(b, a))
+            {
+                std::swap(a, b);
+            }
+        }
+    }
+
+    /**
+     * Quick sort with median of three pivot, falls back to heap sort once depthLimit is used up,
+     * so the worst case stays O(n log n). Recurses into the smaller side only.
+     */
+    template <typename ElementType, typename PredicateType>
+    void IntroSort(ElementType* first, int64 count, int32 depthLimit, PredicateType& predicate)
+    {
+        while (count > kInsertionSortThreshold)
+        {
+            if (depthLimit == 0)
+            {
+                HeapSortInternal(first, count, predicate);
+                return;
+            }
+            --depthLimit;
+
+            // first and last become sentinels of both scans, the median is kept at first[1] as pivot
+            ElementType* last = first + count - 1;
+            SortThree(*first, first[count / 2], *last, predicate);
+            std::swap(first[1], first[count / 2]);
+            ElementType* left = first + 1;
+            ElementType* right = last;
+            for (;;)
+            {
+                do
+                {
+                    ++left;
+                } while (predicate(*left, first[1]));
+                do
+                {
+                    --right;
+                } while (predicate(first[1], *right));
+                if (left >= right)
+                {
+                    break;
+                }
+                std::swap(*left, *right);
+            }
+            std::swap(first[1], *right);
+
+            const int64 leftCount = right - first;
+            const int64 rightCount = count - leftCount - 1;
+            if (leftCount < rightCount)
+            {
+                IntroSort(first, leftCount, depthLimit, predicate);
+                first = right + 1;
+                count = rightCount;
+            }
+            else
+            {
+                IntroSort(right + 1, rightCount, depthLimit, predicate);
+                count = leftCount;
+            }
+        }
+        InsertionSort(first, count, predicate);
+    }
+
+    template <typename ElementType, typename PredicateType>
+    void IntroSort(ElementType* first, int64 count, PredicateType& predicate)
+    {
+        if (count > 1)
+        {
+            IntroSort(first, count, 2 * (int32)std::bit_width((uint64)count), predicate);
+        }
+    }
+}
+
+namespace Engine::Algo
+{
+    /** introsort in place, not stable */
+    template <ContiguousRangeType RangeType, typename PredicateType = std::less<>>
+    void Sort(RangeType&& range, PredicateType predicate = {})
+    {
+        Private::IntroSort(Private::GetData(range), (int64)Private::GetSize(range), predicate);
+    }
+
+    /** sort by the value projection returns for each element, projection may be a member pointer */
+    template <ContiguousRangeType RangeType, typename ProjectionType, typename PredicateType = std::less<>>
+    void SortBy(RangeType&& range, ProjectionType projection, PredicateType predicate = {})
+    {
+        Private::ProjectedPredicate<ProjectionType, PredicateType> projected{ projection, predicate };
+        Private::IntroSort(Private::GetData(range), (int64)Private::GetSize(range), projected);
+    }
+}
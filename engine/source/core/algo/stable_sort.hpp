@@ -0,0 +1,92 @@
+#pragma once
+
+#include "algo/range_utils.hpp"
+#include "algo/binary_search.hpp"
+#include "algo/sort.hpp"
+#include "math/generic_math.hpp"
+#include "memory/memory.hpp"
+#include "memory/memory_ops.hpp"
+
+namespace Engine::Algo::Private
+{
+    /**
+     * Merge sort, the left half of every merge is relocated to buffer and merged back in place,
+     * buffer holds count / 2 raw elements.
+     */
+    template <typename ElementType, typename PredicateType>
+    void MergeSort(ElementType* first, int64 count, ElementType* buffer, PredicateType& predicate)
+    {
+        if (count <= kInsertionSortThreshold)
+        {
+            InsertionSort(first, count, predicate);
+            return;
+        }
+
+        const int64 middle = count / 2;
+        MergeSort(first, middle, buffer, predicate);
+        MergeSort(first + middle, count - middle, buffer, predicate);
+
+        // left elements not after the first right one are already in place
+        const int64 skip = UpperBoundInternal(first, middle, first[middle], predicate);
+        if (skip == middle)
+        {
+            return;
+        }
+
+        ElementType* out = first + skip;
+        const int64 leftCount = middle - skip;
+        RelocateElements(buffer, out, leftCount);
+
+        ElementType* left = buffer;
+        ElementType* const leftEnd = buffer + leftCount;
+        ElementType* right = first + middle;
+        ElementType* const rightEnd = first + count;
+        // once left runs out the rest of right is already in place
+        while (left != leftEnd)
+        {
+            if (right != rightEnd && predicate(*right, *left))
+            {
+                RelocateElement(out, right);
+                ++right;
+            }
+            else
+            {
+                RelocateElement(out, left);
+                ++left;
+            }
+            ++out;
+        }
+    }
+
+    template <typename ElementType, typename PredicateType>
+    void StableSortInternal(ElementType* first, int64 count, PredicateType& predicate)
+    {
+        if (count <= kInsertionSortThreshold)
+        {
+            InsertionSort(first, count, predicate);
+            return;
+        }
+
+        const int64 bufferCount = count / 2;
+        ElementType* buffer = (ElementType*)Memory::Malloc(bufferCount * sizeof(ElementType), Math::Max<uint32>(alignof(ElementType), PlatformMemory::GetDefaultAlignment()));
+        MergeSort(first, count, buffer, predicate);
+        Memory::Free(buffer);
+    }
+}
+
+namespace Engine::Algo
+{
+    /** merge sort, equal elements keep their order, needs a temporary buffer of half the range */
+    template <ContiguousRangeType RangeType, typename PredicateType = std::less<>>
+    void StableSort(RangeType&& range, PredicateType predicate = {})
+    {
+        Private::StableSortInternal(Private::GetData(range), (int64)Private::GetSize(range), predicate);
+    }
+
+    template <ContiguousRangeType RangeType, typename ProjectionType, typename PredicateType = std::less<>>
+    void StableSortBy(RangeType&& range, ProjectionType projection, PredicateType predicate = {})
+    {
+        Private::ProjectedPredicate<ProjectionType, PredicateType> projected{ projection, predicate };
+        Private::StableSortInternal(Private::GetData(range), (int64)Private::GetSize(range), projected);
+    }
+}
@@ -119,7 +119,7 @@ namespace Engine
     {
         auto files = PlatformFile->QueryFiles(*path, _T("."), false);
         //! files is BFS
-        for (auto iter = files.rbegin(); iter != files.rend(); --iter)
+        for (auto iter = files.rbegin(); iter != files.rend(); ++iter)
         {
             if (IsDirectory(*iter) && !RemoveDir(*iter))
             {
@@ -476,6 +476,18 @@ namespace Engine
             }
         }
 
+        /** drop the bits from newSize to the end, the allocation is kept */
+        void Truncate(int32 newSize)
+        {
+            ENSURE(0 <= newSize && newSize <= ArraySize);
+            if (newSize % kElementBits != 0)
+            {
+                // clear the dropped bits of the last word so a later Add starts from zero
+                Data()[newSize / kElementBits] &= kFullWordMask >> (kElementBits - newSize % kElementBits);
+            }
+            ArraySize = newSize;
+        }
+
         void Resize(int32 capacity)
         {
             ENSURE(capacity >= 0);
@@ -527,7 +539,7 @@ namespace Engine
         ConstValidIterator CreateValidIterator(int32 startIndex = 0) const
         {
             ENSURE(startIndex >= 0 && startIndex <= ArraySize);
-            return ConstValidIterator(*this, 0);
+            return ConstValidIterator(*this, startIndex);
         }
 
         Iterator begin()
@@ -0,0 +1,518 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include "definitions_core.hpp"
+#include "global.hpp"
+#include "foundation/dynamic_array.hpp"
+#include "foundation/map.hpp"
+#include "memory/memory.hpp"
+
+namespace Engine
+{
+    namespace Private
+    {
+        /** spread a key hash over 64 bits, shards take the top bits and tables the middle ones */
+        inline uint64 MixConcurrentMapHash(uint32 hashCode)
+        {
+            return (uint64)hashCode * 0x9E3779B97F4A7C15ull;
+        }
+
+        /** Map behind a reader writer lock, padded so shards next to each other do not share a cache line */
+        template <typename KeyType, typename ValueType, typename KeyFunc>
+        class alignas(64) LockedMapShard
+        {
+        public:
+            template <typename ComparableKey>
+            bool Find(uint32 hashCode, const ComparableKey& key, ValueType& outValue) const
+            {
+                std::shared_lock lock(Mutex);
+                if (const ValueType* value = Pairs.FindByHash(hashCode, key))
+                {
+                    outValue = *value;
+                    return true;
+                }
+                return false;
+            }
+
+            template <typename ComparableKey>
+            bool Contains(uint32 hashCode, const ComparableKey& key) const
+            {
+                std::shared_lock lock(Mutex);
+                return Pairs.Contains(key, hashCode);
+            }
+
+            /** hits only take the shared lock */
+            template <typename InKeyType, typename InValueType>
+            ValueType FindOrAdd(uint32 hashCode, InKeyType&& key, InValueType&& value)
+            {
+                {
+                    std::shared_lock lock(Mutex);
+                    if (const ValueType* found = Pairs.FindByHash(hashCode, key))
+                    {
+                        return *found;
+                    }
+                }
+
+                std::lock_guard lock(Mutex);
+                return Pairs.FindOrAddByHash(hashCode, Forward<InKeyType>(key), Forward<InValueType>(value));
+            }
+
+            template <typename InKeyType, typename InValueType>
+            void Add(uint32 hashCode, InKeyType&& key, InValueType&& value)
+            {
+                std::lock_guard lock(Mutex);
+                Pairs.AddByHash(hashCode, Forward<InKeyType>(key), Forward<InValueType>(value));
+            }
+
+            template <typename ComparableKey>
+            bool Remove(const ComparableKey& key)
+            {
+                std::lock_guard lock(Mutex);
+                return Pairs.Remove(key);
+            }
+
+            void Reserve(int32 count)
+            {
+                std::lock_guard lock(Mutex);
+                Pairs.Reserve(count);
+            }
+
+            void Clear()
+            {
+                std::lock_guard lock(Mutex);
+                Pairs.Clear();
+            }
+
+            int32 Size() const
+            {
+                std::shared_lock lock(Mutex);
+                return Pairs.Size();
+            }
+
+            template <typename FuncType>
+            void ForEach(const FuncType& func) const
+            {
+                std::shared_lock lock(Mutex);
+                for (const auto& pair : Pairs)
+                {
+                    func(pair.Key, pair.Value);
+                }
+            }
+
+        private:
+            mutable std::shared_mutex Mutex;
+            Map<KeyType, ValueType, KeyFunc> Pairs;
+        };
+
+        /**
+         * Insert only open addressing table of atomic pointers to immutable pairs, readers take no lock.
+         * Writers lock the shard, publish a pair with a release store and never free a pair or an outgrown table
+         * while the shard lives, so a reader holding an old pointer always reads valid memory.
+         */
+        template <typename KeyType, typename ValueType, typename KeyFunc>
+        class alignas(64) ReadMostlyMapShard
+        {
+            struct Node
+            {
+                template <typename InKeyType, typename InValueType>
+                Node(uint32 hashCode, InKeyType&& key, InValueType&& value)
+                    : HashCode(hashCode)
+                    , Element(Forward<InKeyType>(key), Forward<InValueType>(value))
+                {}
+
+                uint32 HashCode;
+                Pair<KeyType, ValueType> Element;
+            };
+
+            /** header of a table, Mask + 1 slots follow it in the same allocation */
+            struct alignas(std::atomic<Node*>) Table
+            {
+                uint32 Mask;
+
+                std::atomic<Node*>* GetSlots()
+                {
+                    return reinterpret_cast<std::atomic<Node*>*>(this + 1);
+                }
+
+                const std::atomic<Node*>* GetSlots() const
+                {
+                    return reinterpret_cast<const std::atomic<Node*>*>(this + 1);
+                }
+            };
+
+            static constexpr uint32 kMinCapacity = 16;
+
+        public:
+            ReadMostlyMapShard() = default;
+
+            ~ReadMostlyMapShard()
+            {
+                Release();
+            }
+
+            template <typename ComparableKey>
+            const ValueType* Find(uint32 hashCode, const ComparableKey& key) const
+            {
+                const Table* table = CurrentTable.load(std::memory_order_acquire);
+                if (table == nullptr)
+                {
+                    return nullptr;
+                }
+
+                // load factor stays below 3/4, an empty slot always ends the probe
+                for (uint32 index = GetStartIndex(hashCode, table->Mask); ; index = (index + 1) & table->Mask)
+                {
+                    const Node* node = table->GetSlots()[index].load(std::memory_order_acquire);
+                    if (node == nullptr)
+                    {
+                        return nullptr;
+                    }
+                    if (node->HashCode == hashCode && KeyFunc::Equals(node->Element.Key, key))
+                    {
+                        return &node->Element.Value;
+                    }
+                }
+            }
+
+            template <typename ComparableKey>
+            bool Find(uint32 hashCode, const ComparableKey& key, ValueType& outValue) const
+            {
+                if (const ValueType* value = Find(hashCode, key))
+                {
+                    outValue = *value;
+                    return true;
+                }
+                return false;
+            }
+
+            template <typename ComparableKey>
+            bool Contains(uint32 hashCode, const ComparableKey& key) const
+            {
+                return Find(hashCode, key) != nullptr;
+            }
+
+            /** hits take no lock */
+            template <typename InKeyType, typename InValueType>
+            const ValueType& FindOrAdd(uint32 hashCode, InKeyType&& key, InValueType&& value)
+            {
+                if (const ValueType* found = Find(hashCode, key))
+                {
+                    return *found;
+                }
+                return Emplace(hashCode, Forward<InKeyType>(key), Forward<InValueType>(value), false);
+            }
+
+            /** the pair of an existing key is replaced by a new one, the old pair stays readable until Clear */
+            template <typename InKeyType, typename InValueType>
+            void Add(uint32 hashCode, InKeyType&& key, InValueType&& value)
+            {
+                Emplace(hashCode, Forward<InKeyType>(key), Forward<InValueType>(value), true);
+            }
+
+            void Reserve(int32 count)
+            {
+                std::lock_guard lock(Mutex);
+                const uint32 capacity = GetCapacityForCount((uint32)count);
+                const Table* table = CurrentTable.load(std::memory_order_relaxed);
+                if (table == nullptr || capacity > table->Mask + 1)
+                {
+                    Grow(capacity);
+                }
+            }
+
+            /** not safe while other threads read */
+            void Clear()
+            {
+                std::lock_guard lock(Mutex);
+                Release();
+            }
+
+            int32 Size() const
+            {
+                return Count.load(std::memory_order_relaxed);
+            }
+
+            /** visits a snapshot, pairs added meanwhile may be missed */
+            template <typename FuncType>
+            void ForEach(const FuncType& func) const
+            {
+                const Table* table = CurrentTable.load(std::memory_order_acquire);
+                for (uint32 index = 0; table != nullptr && index <= table->Mask; ++index)
+                {
+                    if (const Node* node = table->GetSlots()[index].load(std::memory_order_acquire))
+                    {
+                        func(node->Element.Key, node->Element.Value);
+                    }
+                }
+            }
+
+        private:
+            static uint32 GetStartIndex(uint32 hashCode, uint32 mask)
+            {
+                return (uint32)(MixConcurrentMapHash(hashCode) >> 32) & mask;
+            }
+
+            static uint32 GetCapacityForCount(uint32 count)
+            {
+                return Math::Max(kMinCapacity, std::bit_ceil(count + count / 3 + 1));
+            }
+
+            template <typename InKeyType, typename InValueType>
+            const ValueType& Emplace(uint32 hashCode, InKeyType&& key, InValueType&& value, bool replaceExisting)
+            {
+                std::lock_guard lock(Mutex);
+                Table* table = CurrentTable.load(std::memory_order_relaxed);
+                const int32 count = Count.load(std::memory_order_relaxed);
+                if (table == nullptr || (uint32)(count + 1) * 4 > (table->Mask + 1) * 3)
+                {
+                    table = Grow(table == nullptr ? kMinCapacity : (table->Mask + 1) * 2);
+                }
+
+                for (uint32 index = GetStartIndex(hashCode, table->Mask); ; index = (index + 1) & table->Mask)
+                {
+                    std::atomic<Node*>& slot = table->GetSlots()[index];
+                    Node* node = slot.load(std::memory_order_relaxed);
+                    if (node == nullptr)
+                    {
+                        Node* newNode = NewNode(hashCode, Forward<InKeyType>(key), Forward<InValueType>(value));
+                        slot.store(newNode, std::memory_order_release);
+                        Count.store(count + 1, std::memory_order_relaxed);
+                        return newNode->Element.Value;
+                    }
+
+                    if (node->HashCode == hashCode && KeyFunc::Equals(node->Element.Key, key))
+                    {
+                        if (!replaceExisting)
+                        {
+                            return node->Element.Value;
+                        }
+
+                        Node* newNode = NewNode(hashCode, Forward<InKeyType>(key), Forward<InValueType>(value));
+                        slot.store(newNode, std::memory_order_release);
+                        RetiredNodes.Add(node);
+                        return newNode->Element.Value;
+                    }
+                }
+            }
+
+            /** move every pair into a table of capacity slots and publish it, the old table is retired */
+            Table* Grow(uint32 capacity)
+            {
+                Table* newTable = new(Memory::Malloc(sizeof(Table) + capacity * sizeof(std::atomic<Node*>), alignof(Table))) Table{ capacity - 1 };
+                for (uint32 index = 0; index < capacity; ++index)
+                {
+                    new(newTable->GetSlots() + index) std::atomic<Node*>(nullptr);
+                }
+
+                if (Table* oldTable = CurrentTable.load(std::memory_order_relaxed))
+                {
+                    for (uint32 oldIndex = 0; oldIndex <= oldTable->Mask; ++oldIndex)
+                    {
+                        if (Node* node = oldTable->GetSlots()[oldIndex].load(std::memory_order_relaxed))
+                        {
+                            uint32 index = GetStartIndex(node->HashCode, newTable->Mask);
+                            while (newTable->GetSlots()[index].load(std::memory_order_relaxed) != nullptr)
+                            {
+                                index = (index + 1) & newTable->Mask;
+                            }
+                            newTable->GetSlots()[index].store(node, std::memory_order_relaxed);
+                        }
+                    }
+                    RetiredTables.Add(oldTable);
+                }
+
+                CurrentTable.store(newTable, std::memory_order_release);
+                return newTable;
+            }
+
+            template <typename InKeyType, typename InValueType>
+            static Node* NewNode(uint32 hashCode, InKeyType&& key, InValueType&& value)
+            {
+                return new(Memory::Malloc(sizeof(Node), alignof(Node))) Node(hashCode, Forward<InKeyType>(key), Forward<InValueType>(value));
+            }
+
+            static void DeleteNode(Node* node)
+            {
+                node->~Node();
+                Memory::Free(node);
+            }
+
+            void Release()
+            {
+                if (Table* table = CurrentTable.load(std::memory_order_relaxed))
+                {
+                    for (uint32 index = 0; index <= table->Mask; ++index)
+                    {
+                        if (Node* node = table->GetSlots()[index].load(std::memory_order_relaxed))
+                        {
+                            DeleteNode(node);
+                        }
+                    }
+                    Memory::Free(table);
+                    CurrentTable.store(nullptr, std::memory_order_relaxed);
+                }
+
+                for (Node* node : RetiredNodes)
+                {
+                    DeleteNode(node);
+                }
+                for (Table* table : RetiredTables)
+                {
+                    Memory::Free(table);
+                }
+                RetiredNodes.Clear();
+                RetiredTables.Clear();
+                Count.store(0, std::memory_order_relaxed);
+            }
+
+        private:
+            std::atomic<Table*> CurrentTable{ nullptr };
+            std::atomic<int32> Count{ 0 };
+            /** serializes writers */
+            std::mutex Mutex;
+            DynamicArray<Table*> RetiredTables;
+            DynamicArray<Node*> RetiredNodes;
+        };
+    }
+
+    /**
+     * Hash map shared by threads, keys are spread over ShardCount shards with a lock each,
+     * so threads working on different shards never wait on each other. Values are copied out,
+     * a reference into a shard would outlive its lock.
+     *
+     * With ReadMostly lookups take no lock at all and Find returns a pointer valid until Clear,
+     * writers still lock their shard. Pairs are never freed before Clear, so it suits registries
+     * which only grow, like interned names, and Remove is not available.
+     */
+    template <typename KeyType, typename ValueType, bool ReadMostly = false, uint32 ShardCount = 32, typename KeyFunc = MapDefaultHashFunc<KeyType, ValueType>>
+    class ConcurrentMap
+    {
+        static_assert(std::has_single_bit(ShardCount), "ShardCount must be a power of two");
+
+        using ShardType = std::conditional_t<ReadMostly,
+            Private::ReadMostlyMapShard<KeyType, ValueType, KeyFunc>,
+            Private::LockedMapShard<KeyType, ValueType, KeyFunc>>;
+
+    public:
+        ConcurrentMap() = default;
+
+        /** reserve room for count elements spread over all shards */
+        explicit ConcurrentMap(int32 count)
+        {
+            Reserve(count);
+        }
+
+        ConcurrentMap(const ConcurrentMap& other) = delete;
+
+        ConcurrentMap& operator= (const ConcurrentMap& other) = delete;
+
+        template <typename ComparableKey>
+        bool Find(const ComparableKey& key, ValueType& outValue) const
+        {
+            const uint32 hashCode = KeyFunc::GetHashCode(key);
+            return GetShard(hashCode).Find(hashCode, key, outValue);
+        }
+
+        /** lock free lookup, the value stays valid until Clear */
+        template <typename ComparableKey>
+            requires ReadMostly
+        const ValueType* Find(const ComparableKey& key) const
+        {
+            const uint32 hashCode = KeyFunc::GetHashCode(key);
+            return GetShard(hashCode).Find(hashCode, key);
+        }
+
+        template <typename ComparableKey>
+        bool Contains(const ComparableKey& key) const
+        {
+            const uint32 hashCode = KeyFunc::GetHashCode(key);
+            return GetShard(hashCode).Contains(hashCode, key);
+        }
+
+        /** value of key, or value after adding it, a racing add of the same key keeps the first value */
+        template <typename InKeyType, typename InValueType>
+        ValueType FindOrAdd(InKeyType&& key, InValueType&& value)
+        {
+            const uint32 hashCode = KeyFunc::GetHashCode(key);
+            return GetShard(hashCode).FindOrAdd(hashCode, Forward<InKeyType>(key), Forward<InValueType>(value));
+        }
+
+        /** the value of an existing key is overwritten */
+        template <typename InKeyType, typename InValueType>
+        void Add(InKeyType&& key, InValueType&& value)
+        {
+            const uint32 hashCode = KeyFunc::GetHashCode(key);
+            GetShard(hashCode).Add(hashCode, Forward<InKeyType>(key), Forward<InValueType>(value));
+        }
+
+        template <typename ComparableKey>
+            requires (!ReadMostly)
+        bool Remove(const ComparableKey& key)
+        {
+            return GetShard(KeyFunc::GetHashCode(key)).Remove(key);
+        }
+
+        void Reserve(int32 count)
+        {
+            for (ShardType& shard : Shards)
+            {
+                shard.Reserve((count + ShardCount - 1) / ShardCount);
+            }
+        }
+
+        /** with ReadMostly no other thread may read meanwhile */
+        void Clear()
+        {
+            for (ShardType& shard : Shards)
+            {
+                shard.Clear();
+            }
+        }
+
+        /** sum of shard sizes, only exact while no thread adds */
+        int32 Size() const
+        {
+            int32 size = 0;
+            for (const ShardType& shard : Shards)
+            {
+                size += shard.Size();
+            }
+            return size;
+        }
+
+        /** call func(key, value) for every pair, one shard at a time */
+        template <typename FuncType>
+        void ForEach(const FuncType& func) const
+        {
+            for (const ShardType& shard : Shards)
+            {
+                shard.ForEach(func);
+            }
+        }
+
+    private:
+        ShardType& GetShard(uint32 hashCode)
+        {
+            if constexpr (ShardCount == 1)
+            {
+                return Shards[0];
+            }
+            else
+            {
+                return Shards[Private::MixConcurrentMapHash(hashCode) >> (64 - std::countr_zero(ShardCount))];
+            }
+        }
+
+        const ShardType& GetShard(uint32 hashCode) const
+        {
+            return const_cast<ConcurrentMap*>(this)->GetShard(hashCode);
+        }
+
+    private:
+        ShardType Shards[ShardCount];
+    };
+}
@@ -35,6 +35,20 @@ namespace Engine
         return EntryId != other.EntryId || Number != other.Number;
     }
 
+    bool FixedString::operator==(FixedStringView view) const
+    {
+        const uint32 number = FixedStringHelper::SplitNumber(const_cast<char_t*>(view.Data()), view.Length());
+        return Number == number && EntryId == StringEntryPool::AllocEntryId(view);
+    }
+
+    uint32 FixedString::GetViewHashCode(FixedStringView view)
+    {
+        FixedString name;
+        name.Number = FixedStringHelper::SplitNumber(const_cast<char_t*>(view.Data()), view.Length());
+        name.EntryId = StringEntryPool::AllocEntryId(view);
+        return GetHashCode(name);
+    }
+
     void FixedString::MakeFixedString(FixedStringView view)
     {
         Number = FixedStringHelper::SplitNumber(const_cast<char_t*>(view.Data()), view.Length());
@@ -49,7 +63,7 @@ namespace Engine
 
     String FixedString::ToString() const
     {
-        FixedStringView* entry = StringEntryPool::Get().Find(EntryId);
+        const FixedStringView* entry = StringEntryPool::Get().Find(EntryId);
         if (entry == nullptr)
         {
             return String::Empty();
@@ -1,6 +1,5 @@
 //#include "precompiled_core.hpp"
 #include "foundation/string.hpp"
-#include "math/hash_helper.hpp"
 #include "log/logger.hpp"
 
 #ifdef UNICODE
@@ -54,7 +53,7 @@ namespace Engine
 
     size_t String::GetHash() const
     {
-        return HashHelper::FnvHash(Internal.c_str(), Internal.length());
+        return HashBytes(Internal.data(), Internal.length() * sizeof(char_t));
     }
 
     bool String::IsValidIndex(size_t index) const
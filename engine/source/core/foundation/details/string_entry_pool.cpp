@@ -1,4 +1,5 @@
 #include "string_entry_pool.hpp"
+#include "memory/memory_tracker.hpp"
 
 namespace Engine
 {
@@ -8,8 +9,8 @@ namespace Engine
 
         if (Find(entryId) == nullptr)
         {
-            std::lock_guard lock(Mutex);
-            EntryPool.Add(entryId, entry);
+            MEMORY_TAG_SCOPE(Strings);
+            EntryPool.FindOrAdd(entryId, entry);
         }
         return entryId;
     }
@@ -22,14 +23,13 @@ namespace Engine
     FixedEntryId StringEntryPool::Store(const FixedStringView& entry)
     {
         FixedEntryId entryId = AllocEntryId(entry);
-        std::lock_guard lock(Mutex);
+        MEMORY_TAG_SCOPE(Strings);
         EntryPool.Add(entryId, entry);
         return entryId;
     }
 
-    FixedStringView* StringEntryPool::Find(FixedEntryId entryId)
+    const FixedStringView* StringEntryPool::Find(FixedEntryId entryId)
     {
-        std::shared_lock lock(Mutex);
         return EntryPool.Find(entryId);
     }
 
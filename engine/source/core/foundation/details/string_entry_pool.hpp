@@ -1,7 +1,6 @@
 #pragma once
 
-#include <shared_mutex>
-#include "foundation/map.hpp"
+#include "foundation/concurrent_map.hpp"
 #include "foundation/string.hpp"
 #include "foundation/ustring.hpp"
 #include "foundation/char_utils.hpp"
@@ -63,8 +62,6 @@ namespace Engine
         }
     };
 
-    using StringEntryPoolAllocator = SetAllocator<DefaultAllocator , DefaultAllocator, 2, InitialBucketCount, 4>;
-
 #ifdef SMALLER_FIXED_STRING
     using FixedEntryId = uint32;
 #else
@@ -73,7 +70,8 @@ namespace Engine
 
     class StringEntryPool
     {
-        using TEntryPool = Map<uint64, FixedStringView, MapDefaultHashFunc<uint64, FixedStringView>, StringEntryPoolAllocator>;
+        /** names are only ever added, lookups from any thread take no lock */
+        using TEntryPool = ConcurrentMap<uint64, FixedStringView, true>;
     public:
         static StringEntryPool& Get()
         {
@@ -91,7 +89,7 @@ namespace Engine
 
         FixedEntryId Store(const FixedStringView& entry);
 
-        FixedStringView* Find(FixedEntryId entryId);
+        const FixedStringView* Find(FixedEntryId entryId);
 
     private:
         template <typename CharType>
@@ -109,8 +107,7 @@ namespace Engine
             #endif
         }
 
-        template <>
-        static FixedEntryId GetLowerCaseHash<UChar>(const UChar* str, int32 length)
+        static FixedEntryId GetLowerCaseHash(const UChar* str, int32 length)
         {
             UChar lowerStr[MAX_ENTRY_LENGTH];
             for (int32 idx = 0; idx < length; ++idx)
@@ -118,13 +115,12 @@ namespace Engine
                 lowerStr[idx] = Unicode::ToLower(static_cast<char16_t>(str[idx]));
             }
 #ifdef SMALLER_FIXED_STRING
-            return CityHash::CityHash32(reinterpret_cast<const char*>(lowerStr), length * sizeof(CharType));
+            return CityHash::CityHash32(reinterpret_cast<const char*>(lowerStr), length * sizeof(UChar));
 #else
             return CityHash::CityHash64(reinterpret_cast<const char*>(lowerStr), length * sizeof(UChar));
 #endif
         }
     private:
-        std::shared_mutex Mutex;
-        TEntryPool EntryPool;
+        TEntryPool EntryPool{ InitialBucketCount };
     };
 }
\ No newline at end of file
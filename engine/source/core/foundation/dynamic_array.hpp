@@ -1,10 +1,13 @@
 #pragma once
 
+#include <compare>
 #include <initializer_list>
+#include <iterator>
 #include "definitions_core.hpp"
 #include "global.hpp"
 #include "math/generic_math.hpp"
 #include "memory/allocator_policies.hpp"
+#include "memory/memory_ops.hpp"
 #include "log/logger.hpp"
 #include "foundation/type_traits.hpp"
 #include "foundation/functional.hpp"
@@ -12,113 +15,142 @@
 namespace Engine
 {
 #pragma region iterator
-    template <typename ContainerType, typename ElementType, typename SizeType>
-    class ConstIndexIterator
+#ifdef ENGINE_DEBUG
+    /**
+     * Debug iterator keeps container and index, so every dereference is checked against current size.
+     * ElementType is const for the const iterator, both satisfy std::contiguous_iterator like the raw
+     * pointers used in release builds.
+     */
+    template <typename ContainerType, typename ElementType>
+    class CheckedArrayIterator
     {
+        template <typename OtherContainer, typename OtherElement> friend class CheckedArrayIterator;
+
     public:
-        ConstIndexIterator(const ContainerType& container, SizeType index)
+        using iterator_concept = std::contiguous_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_cv_t<ElementType>;
+        using element_type = ElementType;
+        using difference_type = std::ptrdiff_t;
+        using pointer = ElementType*;
+        using reference = ElementType&;
+
+        CheckedArrayIterator() = default;
+
+        CheckedArrayIterator(ContainerType* container, difference_type index)
             : Container(container)
             , Index(index)
         {}
 
-        const ElementType& operator* () const
+        /** Iterator converts to ConstIterator */
+        template <typename OtherContainer, typename OtherElement>
+            requires std::is_convertible_v<OtherElement*, ElementType*>
+        CheckedArrayIterator(const CheckedArrayIterator<OtherContainer, OtherElement>& other)
+            : Container(other.Container)
+            , Index(other.Index)
+        {}
+
+        ElementType& operator* () const
         {
-            return Container[Index];
+            ENSURE(Container && Index >= 0 && Index < (difference_type)Container->Size());
+            return Container->Data()[Index];
         }
 
-        const ElementType* operator-> () const
+        /** also used by std::to_address, so end is a valid address here */
+        ElementType* operator-> () const
         {
-            return &Container[Index];
+            ENSURE(Container && Index >= 0 && Index <= (difference_type)Container->Size());
+            return Container->Data() + Index;
         }
 
-        explicit operator bool () const
+        ElementType& operator[] (difference_type offset) const
         {
-            return Index >= 0 && Index < Container.Size();
+            return *(*this + offset);
         }
 
-        ConstIndexIterator& operator++ ()
+        CheckedArrayIterator& operator++ ()
         {
             ++Index;
             return *this;
         }
 
-        ConstIndexIterator& operator-- ()
+        CheckedArrayIterator operator++ (int)
         {
-            --Index;
-            return *this;
+            CheckedArrayIterator result = *this;
+            ++Index;
+            return result;
         }
 
-        SizeType GetIndex() const
+        CheckedArrayIterator& operator-- ()
         {
-            return Index;
+            --Index;
+            return *this;
         }
 
-        friend bool operator== (const ConstIndexIterator& lhs, const ConstIndexIterator& rhs)
+        CheckedArrayIterator operator-- (int)
         {
-            return (&lhs.Container == &rhs.Container) && (lhs.Index == rhs.Index);
+            CheckedArrayIterator result = *this;
+            --Index;
+            return result;
         }
 
-        friend bool operator!= (const ConstIndexIterator& lhs, const ConstIndexIterator& rhs)
+        CheckedArrayIterator& operator+= (difference_type offset)
         {
-            return !(lhs == rhs);
+            Index += offset;
+            return *this;
         }
 
-    protected:
-        const ContainerType& Container;
-        SizeType Index;
-    };
-
-    template <typename ContainerType, typename ElementType, typename SizeType>
-    class IndexIterator : public ConstIndexIterator<ContainerType, ElementType, SizeType>
-    {
-        using Super = ConstIndexIterator<ContainerType, ElementType, SizeType>;
-
-    public:
-        IndexIterator(const ContainerType& container, SizeType index)
-            : Super(container, index)
-        {}
-
-        ElementType& operator* () const
+        CheckedArrayIterator& operator-= (difference_type offset)
         {
-            return const_cast<ElementType&>(this->Container[this->Index]);
+            Index -= offset;
+            return *this;
         }
 
-        ElementType* operator-> () const
+        friend CheckedArrayIterator operator+ (CheckedArrayIterator iter, difference_type offset)
         {
-            return const_cast<ElementType*>(&(this->Container[this->Index]));
+            return iter += offset;
         }
 
-        IndexIterator& operator++ ()
+        friend CheckedArrayIterator operator+ (difference_type offset, CheckedArrayIterator iter)
         {
-            Super::operator++();
-            return *this;
+            return iter += offset;
         }
 
-        IndexIterator& operator-- ()
+        friend CheckedArrayIterator operator- (CheckedArrayIterator iter, difference_type offset)
         {
-            Super::operator--();
-            return *this;
+            return iter -= offset;
         }
 
-        void RemoveSelf()
+        friend difference_type operator- (const CheckedArrayIterator& lhs, const CheckedArrayIterator& rhs)
         {
-            const_cast<ContainerType&>(this->Container).RemoveAt(this->Index);
-            this->Index--;
+            ENSURE(lhs.Container == rhs.Container);
+            return lhs.Index - rhs.Index;
         }
 
-        friend bool operator== (const IndexIterator& lhs, const IndexIterator& rhs)
+        friend bool operator== (const CheckedArrayIterator& lhs, const CheckedArrayIterator& rhs)
         {
-            return (&lhs.Container == &rhs.Container) && (lhs.Index == rhs.Index);
+            ENSURE(lhs.Container == rhs.Container);
+            return lhs.Index == rhs.Index;
         }
 
-        friend bool operator!= (const IndexIterator& lhs, const IndexIterator& rhs)
+        friend std::strong_ordering operator<=> (const CheckedArrayIterator& lhs, const CheckedArrayIterator& rhs)
         {
-            return !(lhs == rhs);
+            ENSURE(lhs.Container == rhs.Container);
+            return lhs.Index <=> rhs.Index;
         }
+
+    private:
+        ContainerType* Container{ nullptr };
+        difference_type Index{ 0 };
     };
+#endif
 #pragma endregion iterator
 
-    template <typename ElementType, typename Allocator = DefaultAllocator>
+    /**
+     * Contiguous array, GrowthPolicy decides capacity when it grows and whether it shrinks after removal,
+     * see GrowthPolicy in allocator_policies.hpp
+     */
+    template <typename ElementType, typename Allocator = DefaultAllocator, typename GrowthPolicy = DefaultGrowthPolicy>
     class DynamicArray
     {
         template <typename T, typename U> friend class SparseArray;
@@ -128,8 +160,15 @@ namespace Engine
         using SizeType = typename AllocatorType::SizeType;
 
     public:
-        using ConstIterator = ConstIndexIterator<DynamicArray, ElementType, SizeType>;
-        using Iterator = IndexIterator<DynamicArray, ElementType, SizeType>;
+#ifdef ENGINE_DEBUG
+        using Iterator = CheckedArrayIterator<DynamicArray, ElementType>;
+        using ConstIterator = CheckedArrayIterator<const DynamicArray, const ElementType>;
+#else
+        using Iterator = ElementType*;
+        using ConstIterator = const ElementType*;
+#endif
+        using ReverseIterator = std::reverse_iterator<Iterator>;
+        using ConstReverseIterator = std::reverse_iterator<ConstIterator>;
         using TElement = ElementType;
 
     public:
@@ -140,7 +179,7 @@ namespace Engine
         explicit DynamicArray(SizeType capacity)
             : ArrayCapacity(Math::Max(capacity, AllocatorInstance.GetDefaultSize()))
         {
-            AllocatorInstance.Resize(ArrayCapacity);
+            AllocatorInstance.Resize(ArrayCapacity, 0);
         }
 
         DynamicArray(const ElementType* rawPtr, SizeType count)
@@ -168,8 +207,8 @@ namespace Engine
             MoveElement(Forward<DynamicArray&&>(other));
         }
 
-        template <typename OtherAllocator>
-        explicit DynamicArray(const DynamicArray<ElementType, OtherAllocator>& other)
+        template <typename OtherAllocator, typename OtherPolicy>
+        explicit DynamicArray(const DynamicArray<ElementType, OtherAllocator, OtherPolicy>& other)
         {
             CopyElement(other.Data(), other.Size());
         }
@@ -202,8 +241,8 @@ namespace Engine
             return *this;
         }
 
-        template <typename OtherAllocator>
-        DynamicArray& operator=(const DynamicArray<ElementType, OtherAllocator>& other)
+        template <typename OtherAllocator, typename OtherPolicy>
+        DynamicArray& operator=(const DynamicArray<ElementType, OtherAllocator, OtherPolicy>& other)
         {
             DestructElements(Data(), ArraySize);
             CopyElement(other.Data(), (SizeType) other.Size());
@@ -306,7 +345,7 @@ namespace Engine
         {
             ENSURE(0 <=index && index <= ArraySize);
             AddressCheck(&element);
-            EmplaceAt(index, element);
+            EmplaceAt(index, MoveTemp(element));
         };
 
         void Insert(SizeType index, const ElementType* elements, SizeType size)
@@ -323,16 +362,57 @@ namespace Engine
          */
         void RemoveAt(SizeType index)
         {
-            ENSURE(IsValidIndex(index));
-            DestructElements(Data() + index, 1);
+            RemoveAt(index, 1);
+        }
 
-            SizeType countToMove = ArraySize - index - 1;
-            if (countToMove)
+        /**
+         * Remove count elements from index, the tail is moved once
+         * @param index
+         * @param count
+         */
+        void RemoveAt(SizeType index, SizeType count)
+        {
+            ENSURE(count >= 0 && IsValidIndex(index) && index + count <= ArraySize);
+            if (count == 0)
             {
-                Memory::Memmove(Data() + index, Data() + index + 1, countToMove * sizeof(ElementType));
+                return;
             }
-            ArraySize -= 1;
-            //TODO: check need shink
+
+            DestructElements(Data() + index, count);
+            SizeType countToMove = ArraySize - index - count;
+            RelocateElements(Data() + index, Data() + index + count, countToMove);
+            ArraySize -= count;
+            CheckShrink();
+        }
+
+        /**
+         * Remove element at position and fill the hole with the last element, order is not kept
+         * @param index
+         */
+        void RemoveAtSwap(SizeType index)
+        {
+            RemoveAtSwap(index, 1);
+        }
+
+        /**
+         * Remove count elements from index and fill the hole with elements from end, order is not kept
+         * @param index
+         * @param count
+         */
+        void RemoveAtSwap(SizeType index, SizeType count)
+        {
+            ENSURE(count >= 0 && IsValidIndex(index) && index + count <= ArraySize);
+            if (count == 0)
+            {
+                return;
+            }
+
+            DestructElements(Data() + index, count);
+            SizeType countAfterHole = ArraySize - index - count;
+            SizeType countToMove = Math::Min(count, countAfterHole);
+            RelocateElements(Data() + index, Data() + ArraySize - countToMove, countToMove);
+            ArraySize -= count;
+            CheckShrink();
         }
 
         /**
@@ -347,48 +427,99 @@ namespace Engine
             }) > 0;
         }
 
+        /**
+         * Remove elements in [first, last]
+         * @param first
+         * @param last
+         */
         void Remove(SizeType first, SizeType last)
         {
             ENSURE(IsValidIndex(first) && IsValidIndex(last));
             if (first <= last)
             {
-                SizeType removeCount = last - first + 1;
-                DestructElements(Data() + first, removeCount);
-                SizeType countToMove = ArraySize - last - 1;
-                if (countToMove)
-                {
-                    Memory::Memmove(Data() + first, Data() + last + 1, countToMove * sizeof(ElementType));
-                }
-                ArraySize -= removeCount;
+                RemoveAt(first, last - first + 1);
             }
         }
 
         /**
-         * Remove all elements match the predicate
+         * Remove all elements match the predicate in one pass, every kept element is moved at most once
          * @param predicate
          * @return count of elements been removed
          */
-        SizeType RemoveMatch(TFunction<bool(const ElementType& element)> predicate)
+        template <typename PredicateType>
+        SizeType RemoveMatch(const PredicateType& predicate)
         {
             if (ArraySize <= 0)
             {
                 return 0;
             }
 
-            SizeType searchCount = ArraySize;
-            SizeType matchCount = 0;
-            while (searchCount > 0)
+            ElementType* data = Data();
+            SizeType writeIndex = 0;
+            for (SizeType readIndex = 0; readIndex < ArraySize; ++readIndex)
             {
-                ElementType* element = Data() + searchCount - 1;
-                if (predicate(*element))
+                if (predicate(data[readIndex]))
                 {
-                    RemoveAt(searchCount - 1);
-                    matchCount++;
+                    DestructElements(data + readIndex, 1);
+                }
+                else
+                {
+                    if (writeIndex != readIndex)
+                    {
+                        RelocateElement(data + writeIndex, data + readIndex);
+                    }
+                    ++writeIndex;
                 }
-                searchCount--;
             }
 
-            return matchCount;
+            const SizeType removeCount = ArraySize - writeIndex;
+            ArraySize = writeIndex;
+            CheckShrink();
+            return removeCount;
+        }
+
+        /**
+         * Remove all elements equals param, order is not kept
+         * @param element
+         * @return count of elements been removed
+         */
+        SizeType RemoveAllSwap(const ElementType& element)
+        {
+            return RemoveAllSwap([&element](const ElementType& inElement) {
+                return element == inElement;
+            });
+        }
+
+        /**
+         * Remove all elements match the predicate, holes are filled with elements from end so order is not kept
+         * @param predicate
+         * @return count of elements been removed
+         */
+        template <typename PredicateType>
+            requires std::is_invocable_v<const PredicateType&, const ElementType&>
+        SizeType RemoveAllSwap(const PredicateType& predicate)
+        {
+            ElementType* data = Data();
+            const SizeType oldSize = ArraySize;
+            SizeType index = 0;
+            while (index < ArraySize)
+            {
+                if (predicate(data[index]))
+                {
+                    DestructElements(data + index, 1);
+                    --ArraySize;
+                    if (index != ArraySize)
+                    {
+                        RelocateElement(data + index, data + ArraySize);
+                    }
+                }
+                else
+                {
+                    ++index;
+                }
+            }
+            CheckShrink();
+            return oldSize - ArraySize;
         }
 
         /**
@@ -476,11 +607,26 @@ namespace Engine
         {
             if (newCapacity > ArraySize && newCapacity != ArrayCapacity)
             {
-                ArrayCapacity = newCapacity;
-                AllocatorInstance.Resize(newCapacity);
+                ResizeAllocation(newCapacity);
+            }
+        }
+
+        /** release unused capacity, keeps what the allocator would round the allocation up to anyway */
+        void ShrinkToFit()
+        {
+            const SizeType newCapacity = Math::Max(QuantizeCapacity(ArraySize), AllocatorInstance.GetDefaultSize());
+            if (newCapacity < ArrayCapacity)
+            {
+                ResizeAllocation(newCapacity);
             }
         }
 
+        /** bytes allocated by the allocator, elements stored inside the array are not counted */
+        size_t GetAllocatedSize() const
+        {
+            return AllocatorInstance.GetAllocatedSize(ArrayCapacity);
+        }
+
         bool IsValidIndex(SizeType index) const
         {
             return index < ArraySize;
@@ -489,64 +635,82 @@ namespace Engine
 
         Iterator begin()
         {
-            return Iterator(*this, 0);
+            return MakeIterator(0);
         }
 
         ConstIterator begin() const
         {
-            return ConstIterator(*this, 0);
+            return MakeIterator(0);
         }
 
         Iterator end()
         {
-            return Iterator(*this, ArraySize);
+            return MakeIterator(ArraySize);
         }
 
         ConstIterator end() const
         {
-            return ConstIterator(*this, ArraySize);
+            return MakeIterator(ArraySize);
         }
 
-        Iterator rbegin()
+        ReverseIterator rbegin()
         {
-            return Iterator(*this, ArraySize - 1);
+            return ReverseIterator(end());
         }
 
-        ConstIterator rbegin() const
+        ConstReverseIterator rbegin() const
         {
-            return ConstIterator(*this, ArraySize - 1);
+            return ConstReverseIterator(end());
         }
 
-        Iterator rend()
+        ReverseIterator rend()
         {
-            return Iterator(*this, (SizeType)-1);
+            return ReverseIterator(begin());
         }
 
-        ConstIterator rend() const
+        ConstReverseIterator rend() const
         {
-            return ConstIterator(*this, (SizeType)-1);
+            return ConstReverseIterator(begin());
         }
 
-        ConstIterator cbegin()
+        ConstIterator cbegin() const
         {
-            return ConstIterator(*this, 0);
+            return begin();
         }
 
-        ConstIterator cend()
+        ConstIterator cend() const
         {
-            return ConstIterator(*this, ArraySize - 1);
+            return end();
         }
 
-        ConstIterator crbegin()
+        ConstReverseIterator crbegin() const
         {
-            return ConstIterator(*this, 0);
+            return rbegin();
         }
 
-        ConstIterator crend()
+        ConstReverseIterator crend() const
         {
-            return ConstIterator(*this, (SizeType)-1);
+            return rend();
         }
     private:
+        Iterator MakeIterator(SizeType index)
+        {
+#ifdef ENGINE_DEBUG
+            return Iterator(this, index);
+#else
+            return Data() + index;
+#endif
+        }
+
+        ConstIterator MakeIterator(SizeType index) const
+        {
+#ifdef ENGINE_DEBUG
+            return ConstIterator(this, index);
+#else
+            return Data() + index;
+#endif
+        }
+
         template <typename... Args>
         void EmplaceBack(Args&&... args)
         {
@@ -574,7 +738,7 @@ namespace Engine
             ArraySize += count;
             if (ArraySize > ArrayCapacity)
             {
-                Expansion();
+                Expansion(oldCount);
             }
             return oldCount;
         }
@@ -586,86 +750,91 @@ namespace Engine
             ArraySize += count;
             if (ArraySize > ArrayCapacity)
             {
-                Expansion();
+                Expansion(oldCount);
             }
 
             ElementType* src = Data() + index;
-            Memory::Memmove(src + count, src, (oldCount - index) * sizeof(ElementType));
+            RelocateElements(src + count, src, oldCount - index);
         }
 
-        void Expansion()
+        /**
+         * Grow capacity to hold ArraySize elements
+         * @param liveCount count of constructed elements to keep
+         */
+        void Expansion(SizeType liveCount)
         {
             ArrayCapacity = CalculateGrowth(ArraySize);
             ENSURE(ArraySize <= ArrayCapacity);
-            AllocatorInstance.Resize(ArrayCapacity);
+            AllocatorInstance.Resize(ArrayCapacity, liveCount);
         }
 
         SizeType CalculateGrowth(const SizeType newSize) const
         {
-            SizeType oldCapacity = Capacity();
-            SizeType max = MaxSize();
+            return QuantizeCapacity(GrowthPolicy::CalculateGrowth(newSize, ArrayCapacity));
+        }
 
-            if (oldCapacity > max - oldCapacity / 2)
+        SizeType QuantizeCapacity(SizeType capacity) const
+        {
+            if constexpr (GrowthPolicy::kQuantize)
             {
-                return max;
+                return AllocatorInstance.QuantizeSize(capacity);
             }
-
-            const SizeType geometric = oldCapacity + oldCapacity / 2;
-
-            if (geometric < newSize)
+            else
             {
-                return newSize;
+                return capacity;
             }
-
-            return geometric;
         }
 
-        void BoundCheck() const
+        /** called after removal, shrink the allocation if policy says slack is too large */
+        void CheckShrink()
         {
-            ENSURE(ArraySize >= 0 && ArraySize <= ArrayCapacity);
+            const SizeType shrinkCapacity = GrowthPolicy::CalculateShrink(ArraySize, ArrayCapacity, sizeof(ElementType));
+            if (shrinkCapacity < ArrayCapacity)
+            {
+                const SizeType newCapacity = Math::Max(QuantizeCapacity(shrinkCapacity), AllocatorInstance.GetDefaultSize());
+                if (newCapacity < ArrayCapacity)
+                {
+                    ResizeAllocation(newCapacity);
+                }
+            }
         }
 
-        void AddressCheck(const ElementType* address)
+        void ResizeAllocation(SizeType newCapacity)
         {
-            ENSURE(address < Data() || address >= Data() + ArrayCapacity);
+            ENSURE(newCapacity >= ArraySize);
+            ArrayCapacity = newCapacity;
+            AllocatorInstance.Resize(newCapacity, ArraySize);
         }
 
-        void ConstructElements(ElementType* dest, const ElementType* src, SizeType count)
+        void BoundCheck() const
         {
-            Memory::Memcpy((void*)dest, (void*)src, sizeof(ElementType) * count);
+            ENSURE(ArraySize >= 0 && ArraySize <= ArrayCapacity);
         }
 
-        void DestructElements(ElementType* element, SizeType count)
+        void AddressCheck(const ElementType* address)
         {
-            if constexpr (!std::is_union<ElementType>::value)
-            {
-                while (count)
-                {
-                    std::destroy_at(element);
-                    ++element;
-                    --count;
-                }
-            }
+            ENSURE(address < Data() || address >= Data() + ArrayCapacity);
         }
 
+        /** elements must be destructed before */
         void CopyElement(const ElementType* data, SizeType count)
         {
-            ENSURE(data && count > 0);
+            ENSURE((data || count == 0) && count >= 0);
             ArraySize = count;
             if (ArraySize > ArrayCapacity)
             {
-                Expansion();
+                Expansion(0);
             }
             ConstructElements(Data(), data, count);
         }
 
         void MoveElement(DynamicArray&& other)
         {
-            AllocatorInstance = MoveTemp(other.AllocatorInstance);
+            AllocatorInstance.MoveToEmpty(other.AllocatorInstance, other.ArraySize);
             ArraySize = other.ArraySize;
             ArrayCapacity = other.ArrayCapacity;
             other.ArraySize = 0;
-            other.ArrayCapacity = 0;
+            other.ArrayCapacity = other.AllocatorInstance.GetDefaultSize();
         }
 
     protected:
@@ -673,9 +842,14 @@ namespace Engine
         /** Make sure AllocatorInstance init first */
         AllocatorType AllocatorInstance;
         SizeType ArraySize{ 0 };
-        SizeType ArrayCapacity{ 0 };
+        /** inline and fixed allocators start with their storage as capacity */
+        SizeType ArrayCapacity{ AllocatorInstance.GetDefaultSize() };
     };
 
     template <typename ElementType>
     using DynamicArray64 = DynamicArray<ElementType, HeapSizeAllocator<int64>>;
-}
\ No newline at end of file
+}
+
+/** heap allocation does not move with the array, inline allocators keep elements inside it */
+template <typename ElementType, typename IntType, typename GrowthPolicy>
+struct TIsTriviallyRelocatable<Engine::DynamicArray<ElementType, Engine::HeapSizeAllocator<IntType>, GrowthPolicy>> : std::true_type {};
@@ -23,6 +23,12 @@ namespace Engine
 
         bool operator!= (const FixedString& other) const;
 
+        /** view equals the FixedString it would make, without storing it into the entry pool */
+        bool operator== (FixedStringView view) const;
+
+        /** hash of the FixedString view would make, same as GetHashCode */
+        static uint32 GetViewHashCode(FixedStringView view);
+
         String ToString() const;
 
         FixedEntryId GetEntryId() const {return EntryId;}
@@ -39,9 +45,20 @@ namespace Engine
         uint32 Number{ SUFFIX_NUMBER_NONE };
     };
 
-    template <>
     inline uint32 GetHashCode(const FixedString& name)
     {
-        return (uint32)(name.GetEntryId()) + ((uint32)(name.GetEntryId() >> 32) * 23) + name.GetNumber();
+        return HashCombine(GetHashCode(name.GetEntryId()), name.GetNumber());
     }
+
+    /** look up Map<FixedString, ...> by a string view */
+    template <>
+    struct THeterogeneousKey<FixedString, FixedStringView>
+    {
+        static constexpr bool Value = true;
+
+        static uint32 GetHashCode(const FixedStringView& key)
+        {
+            return FixedString::GetViewHashCode(key);
+        }
+    };
 }
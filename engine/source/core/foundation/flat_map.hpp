@@ -0,0 +1,159 @@
+#pragma once
+
+#include "definitions_core.hpp"
+#include "foundation/flat_set.hpp"
+#include "foundation/map.hpp"
+
+namespace Engine
+{
+    /**
+     * Map on top of FlatSet, pairs are stored inline in the probed slot array.
+     * Same interface as Map, pointers to values are invalidated by Add.
+     */
+    template <typename KeyType, typename ValueType, typename KeyFunc = MapDefaultHashFunc<KeyType, ValueType>, typename MapAllocator = DefaultAllocator>
+    class FlatMap
+    {
+        using TPairType = Pair<KeyType, ValueType>;
+        using TPairContainer = FlatSet<TPairType, KeyFunc, MapAllocator>;
+    public:
+        using ConstIterator = typename TPairContainer::ConstIterator;
+        using Iterator = typename TPairContainer::Iterator;
+    public:
+        FlatMap() = default;
+
+        FlatMap(std::initializer_list<TPairType> initializer)
+        {
+            Reserve((int32)initializer.size());
+            for (const auto& pair : initializer)
+            {
+                Add(pair.Key, pair.Value);
+            }
+        }
+
+        ValueType& Add(const KeyType& key, const ValueType& value)
+        {
+            return Emplace(key, value);
+        }
+
+        ValueType& Add(const KeyType& key, ValueType&& value)
+        {
+            return Emplace(key, MoveTemp(value));
+        }
+
+        ValueType& Add(KeyType&& key, const ValueType& value)
+        {
+            return Emplace(MoveTemp(key), value);
+        }
+
+        ValueType& Add(KeyType&& key, ValueType&& value)
+        {
+            return Emplace(MoveTemp(key), MoveTemp(value));
+        }
+
+        ValueType& FindOrAdd(const KeyType& key, const ValueType& value)
+        {
+            return FindOrAddImpl(key, value);
+        }
+
+        ValueType& FindOrAdd(const KeyType& key, ValueType&& value)
+        {
+            return FindOrAddImpl(key, MoveTemp(value));
+        }
+
+        ValueType& FindOrAdd(KeyType&& key, const ValueType& value)
+        {
+            return FindOrAddImpl(MoveTemp(key), value);
+        }
+
+        ValueType& FindOrAdd(KeyType&& key, ValueType&& value)
+        {
+            return FindOrAddImpl(MoveTemp(key), MoveTemp(value));
+        }
+
+        template <typename ComparableKey>
+        ValueType* Find(const ComparableKey& key) const
+        {
+            if (TPairType* pair = Pairs.Find(key))
+            {
+                return &pair->Value;
+            }
+            return nullptr;
+        }
+
+        template <typename ComparableKey>
+        bool Contains(const ComparableKey& key) const
+        {
+            return Pairs.Contains(key);
+        }
+
+        template <typename ComparableKey>
+        bool Remove(const ComparableKey& key)
+        {
+            return Pairs.Remove(key);
+        }
+
+        void Clear(int32 slack = 0)
+        {
+            Pairs.Clear(slack);
+        }
+
+        int32 Size() const
+        {
+            return Pairs.Size();
+        }
+
+        bool IsEmpty() const
+        {
+            return Pairs.IsEmpty();
+        }
+
+        void Reserve(int32 count)
+        {
+            Pairs.Reserve(count);
+        }
+
+        Iterator begin() { return Pairs.begin(); }
+
+        ConstIterator begin() const { return Pairs.begin(); }
+
+        Iterator end() { return Pairs.end(); }
+
+        ConstIterator end() const { return Pairs.end(); }
+
+    protected:
+        /** hash once, overwrite the value of an existing key */
+        template <typename InKeyType, typename InValueType>
+        ValueType& Emplace(InKeyType&& key, InValueType&& value)
+        {
+            bool found;
+            const int32 index = Pairs.FindOrPrepareInsert(key, KeyFunc::GetHashCode(key), found);
+            TPairType* pair = Pairs.GetSlots() + index;
+            if (found)
+            {
+                pair->Value = Forward<InValueType>(value);
+            }
+            else
+            {
+                new(pair) TPairType(Forward<InKeyType>(key), Forward<InValueType>(value));
+            }
+            return pair->Value;
+        }
+
+        /** hash once, keep the value of an existing key */
+        template <typename InKeyType, typename InValueType>
+        ValueType& FindOrAddImpl(InKeyType&& key, InValueType&& value)
+        {
+            bool found;
+            const int32 index = Pairs.FindOrPrepareInsert(key, KeyFunc::GetHashCode(key), found);
+            TPairType* pair = Pairs.GetSlots() + index;
+            if (!found)
+            {
+                new(pair) TPairType(Forward<InKeyType>(key), Forward<InValueType>(value));
+            }
+            return pair->Value;
+        }
+
+    private:
+        TPairContainer Pairs;
+    };
+}
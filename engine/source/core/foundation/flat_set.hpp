@@ -0,0 +1,609 @@
+#pragma once
+
+#include <bit>
+#include <initializer_list>
+#include "definitions_core.hpp"
+#include "global.hpp"
+#include "math/generic_math.hpp"
+#include "memory/allocator_policies.hpp"
+#include "memory/memory_ops.hpp"
+#include "foundation/set.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+    #define FLAT_SET_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define FLAT_SET_SSE2 0
+#endif
+
+namespace Engine
+{
+    /**
+     * Control bytes of kWidth consecutive FlatSet slots, every match returns one bit per slot.
+     * A full slot stores 7 bits of its hash, so most mismatches are rejected without touching the element.
+     */
+    class FlatSetGroup
+    {
+    public:
+        static constexpr int8 kEmpty = -128;
+        static constexpr int8 kDeleted = -2;
+        static constexpr uint32 kWidth = 16;
+
+        explicit FlatSetGroup(const int8* ctrl)
+        {
+#if FLAT_SET_SSE2
+            Ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+            for (uint32 index = 0; index < kWidth; ++index)
+            {
+                Ctrl[index] = ctrl[index];
+            }
+#endif
+        }
+
+        /** slots whose control byte is h2 */
+        uint32 Match(int8 h2) const
+        {
+#if FLAT_SET_SSE2
+            return (uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), Ctrl));
+#else
+            return MatchIf([h2](int8 ctrl) { return ctrl == h2; });
+#endif
+        }
+
+        uint32 MatchEmpty() const
+        {
+            return Match(kEmpty);
+        }
+
+        uint32 MatchEmptyOrDeleted() const
+        {
+#if FLAT_SET_SSE2
+            // both are below -1, full slots are not negative
+            return (uint32)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), Ctrl));
+#else
+            return MatchIf([](int8 ctrl) { return ctrl < -1; });
+#endif
+        }
+
+    private:
+#if FLAT_SET_SSE2
+        __m128i Ctrl;
+#else
+        template <typename PredicateType>
+        uint32 MatchIf(const PredicateType& predicate) const
+        {
+            uint32 mask = 0;
+            for (uint32 index = 0; index < kWidth; ++index)
+            {
+                mask |= predicate(Ctrl[index]) ? (1u << index) : 0u;
+            }
+            return mask;
+        }
+
+        int8 Ctrl[kWidth];
+#endif
+    };
+
+#pragma region iterator
+    template <typename ContainerType, typename ElementType>
+    class FlatSetIterator
+    {
+    public:
+        FlatSetIterator(ContainerType* container, int32 index)
+            : Container(container)
+            , Index(index)
+        {
+            SkipFree();
+        }
+
+        /** mutable iterator converts to const iterator */
+        template <typename OtherContainerType, typename OtherElementType>
+            requires std::is_convertible_v<OtherElementType*, ElementType*>
+        FlatSetIterator(const FlatSetIterator<OtherContainerType, OtherElementType>& other)
+            : Container(other.Container)
+            , Index(other.Index)
+        {}
+
+        ElementType& operator* () const
+        {
+            ENSURE(Index < Container->SlotCapacity);
+            return Container->GetSlots()[Index];
+        }
+
+        ElementType* operator-> () const
+        {
+            return &**this;
+        }
+
+        FlatSetIterator& operator++ ()
+        {
+            ++Index;
+            SkipFree();
+            return *this;
+        }
+
+        friend bool operator== (const FlatSetIterator& lhs, const FlatSetIterator& rhs)
+        {
+            return lhs.Container == rhs.Container && lhs.Index == rhs.Index;
+        }
+
+        friend bool operator!= (const FlatSetIterator& lhs, const FlatSetIterator& rhs)
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        template <typename OtherContainerType, typename OtherElementType> friend class FlatSetIterator;
+
+        void SkipFree()
+        {
+            while (Index < Container->SlotCapacity && Container->GetCtrl()[Index] < 0)
+            {
+                ++Index;
+            }
+        }
+
+    private:
+        ContainerType* Container;
+        int32 Index;
+    };
+#pragma endregion iterator
+
+    /**
+     * Open addressing hash set in swiss table layout, elements live directly in a slot array and
+     * a parallel array of control bytes is probed kWidth slots at a time, so a lookup usually costs
+     * one control group load plus one element compare. Uses the same KeyFunc as Set.
+     * Capacity is a power of two, at most 7/8 of it is used before growing.
+     * Elements move on rehash, pointers to them are invalidated by Add.
+     */
+    template <typename ElementType, typename KeyFunc = DefaultSetKeyFunc<ElementType>, typename Allocator = DefaultAllocator>
+    class FlatSet
+    {
+        using SlotAllocatorType = typename Allocator::template ElementAllocator<ElementType>;
+        using CtrlAllocatorType = typename Allocator::template ElementAllocator<int8>;
+
+        template <typename ContainerType, typename IterElementType> friend class FlatSetIterator;
+        template <typename K, typename V, typename F, typename A> friend class FlatMap;
+
+        static constexpr uint32 kWidth = FlatSetGroup::kWidth;
+
+    public:
+        using Iterator = FlatSetIterator<FlatSet, ElementType>;
+        using ConstIterator = FlatSetIterator<const FlatSet, const ElementType>;
+
+    public:
+        FlatSet() = default;
+
+        FlatSet(std::initializer_list<ElementType> initializer)
+        {
+            Append(initializer);
+        }
+
+        FlatSet(const FlatSet& other)
+        {
+            CopyElement(other);
+        }
+
+        FlatSet(FlatSet&& other) noexcept
+        {
+            MoveElement(Forward<FlatSet&&>(other));
+        }
+
+        ~FlatSet()
+        {
+            DestructElements();
+        }
+
+        FlatSet& operator= (const FlatSet& other)
+        {
+            ENSURE(this != &other);
+            Clear();
+            CopyElement(other);
+            return *this;
+        }
+
+        FlatSet& operator= (FlatSet&& other) noexcept
+        {
+            ENSURE(this != &other);
+            DestructElements();
+            MoveElement(Forward<FlatSet&&>(other));
+            return *this;
+        }
+
+        /** add element, an equal element already in set is overwritten */
+        void Add(const ElementType& element)
+        {
+            Emplace(element);
+        }
+
+        void Add(ElementType&& element)
+        {
+            Emplace(MoveTemp(element));
+        }
+
+        void Append(std::initializer_list<ElementType> initializer)
+        {
+            Reserve(ElementCount + (int32)initializer.size());
+            for (auto&& element : initializer)
+            {
+                Add(element);
+            }
+        }
+
+        template <typename KeyType>
+        bool Contains(const KeyType& key) const
+        {
+            return FindSlot(key, KeyFunc::GetHashCode(key)) != INDEX_NONE;
+        }
+
+        template <typename KeyType>
+        ElementType* Find(const KeyType& key) const
+        {
+            const int32 index = FindSlot(key, KeyFunc::GetHashCode(key));
+            return index != INDEX_NONE ? GetSlots() + index : nullptr;
+        }
+
+        template <typename KeyType>
+        bool Remove(const KeyType& key)
+        {
+            const int32 index = FindSlot(key, KeyFunc::GetHashCode(key));
+            if (index == INDEX_NONE)
+            {
+                return false;
+            }
+
+            std::destroy_at(GetSlots() + index);
+            EraseCtrl(index);
+            --ElementCount;
+            return true;
+        }
+
+        /** remove all elements, keep room for slack elements */
+        void Clear(int32 slack = 0)
+        {
+            ENSURE(slack >= 0);
+            DestructElements();
+            ElementCount = 0;
+            const int32 capacity = slack > 0 ? CapacityForCount(slack) : 0;
+            if (capacity == SlotCapacity && capacity > 0)
+            {
+                ResetCtrl();
+                return;
+            }
+
+            Slots.Resize(0, 0);
+            Ctrl.Resize(0, 0);
+            SlotCapacity = 0;
+            GrowthLeft = 0;
+            if (capacity > 0)
+            {
+                Rehash(capacity);
+            }
+        }
+
+        int32 Size() const
+        {
+            return ElementCount;
+        }
+
+        bool IsEmpty() const
+        {
+            return ElementCount == 0;
+        }
+
+        /** count of slots, elements are added without rehash up to 7/8 of it */
+        int32 Capacity() const
+        {
+            return SlotCapacity;
+        }
+
+        void Reserve(int32 count)
+        {
+            const int32 capacity = CapacityForCount(count);
+            if (capacity > SlotCapacity)
+            {
+                Rehash(capacity);
+            }
+        }
+
+        Iterator begin() { return Iterator(this, 0); }
+
+        ConstIterator begin() const { return ConstIterator(this, 0); }
+
+        Iterator end() { return Iterator(this, SlotCapacity); }
+
+        ConstIterator end() const { return ConstIterator(this, SlotCapacity); }
+
+    private:
+        template <typename InElementType>
+        ElementType& Emplace(InElementType&& element)
+        {
+            const auto& key = KeyFunc::GetKey(element);
+            bool found;
+            const int32 index = FindOrPrepareInsert(key, KeyFunc::GetHashCode(key), found);
+            ElementType* slot = GetSlots() + index;
+            if (found)
+            {
+                *slot = Forward<InElementType>(element);
+            }
+            else
+            {
+                new(slot) ElementType(Forward<InElementType>(element));
+            }
+            return *slot;
+        }
+
+        /**
+         * 64 bit mix of the key hash, high bits depend on every bit of it even for weak hashes of custom key functions.
+         * Bits from 32 pick the first group and the top 7 bits are stored as control byte.
+         */
+        static uint64 MixHash(uint32 hashCode)
+        {
+            return (uint64)hashCode * 0x9E3779B97F4A7C15ull;
+        }
+
+        static uint32 GetH1(uint64 mixedHash)
+        {
+            return (uint32)(mixedHash >> 32);
+        }
+
+        static int8 GetH2(uint64 mixedHash)
+        {
+            return (int8)(mixedHash >> 57);
+        }
+
+        /** slot of key, INDEX_NONE if not found */
+        template <typename KeyType>
+        int32 FindSlot(const KeyType& key, uint32 hashCode) const
+        {
+            if (ElementCount == 0)
+            {
+                return INDEX_NONE;
+            }
+
+            const uint64 mixedHash = MixHash(hashCode);
+            const int8 h2 = GetH2(mixedHash);
+            const uint32 mask = (uint32)SlotCapacity - 1;
+            const ElementType* slots = GetSlots();
+            uint32 position = GetH1(mixedHash) & mask;
+            // triangular steps over groups visit every group of a power of two table
+            for (uint32 step = kWidth; ; step += kWidth)
+            {
+                const FlatSetGroup group(GetCtrl() + position);
+                for (uint32 bits = group.Match(h2); bits != 0; bits &= bits - 1)
+                {
+                    const uint32 index = (position + std::countr_zero(bits)) & mask;
+                    if (KeyFunc::Equals(KeyFunc::GetKey(slots[index]), key))
+                    {
+                        return (int32)index;
+                    }
+                }
+
+                // an insert would have stopped at the empty slot, key is not further down the sequence
+                if (group.MatchEmpty() != 0)
+                {
+                    return INDEX_NONE;
+                }
+                position = (position + step) & mask;
+            }
+        }
+
+        /** first empty or deleted slot on the probe sequence */
+        uint32 FindFirstNonFull(uint64 mixedHash) const
+        {
+            const uint32 mask = (uint32)SlotCapacity - 1;
+            uint32 position = GetH1(mixedHash) & mask;
+            for (uint32 step = kWidth; ; step += kWidth)
+            {
+                const uint32 bits = FlatSetGroup(GetCtrl() + position).MatchEmptyOrDeleted();
+                if (bits != 0)
+                {
+                    return (position + std::countr_zero(bits)) & mask;
+                }
+                position = (position + step) & mask;
+            }
+        }
+
+        /**
+         * Slot of key, or a raw slot marked full for it when not found, the caller constructs the element there.
+         * The hash is computed once by the caller for both lookup and insert.
+         */
+        template <typename KeyType>
+        int32 FindOrPrepareInsert(const KeyType& key, uint32 hashCode, bool& found)
+        {
+            const int32 index = FindSlot(key, hashCode);
+            found = index != INDEX_NONE;
+            return found ? index : PrepareInsert(hashCode);
+        }
+
+        int32 PrepareInsert(uint32 hashCode)
+        {
+            const uint64 mixedHash = MixHash(hashCode);
+            if (SlotCapacity == 0)
+            {
+                Rehash(kWidth);
+            }
+
+            uint32 index = FindFirstNonFull(mixedHash);
+            // reusing a deleted slot keeps the count of empty slots, so it never needs growth
+            if (GrowthLeft == 0 && GetCtrl()[index] != FlatSetGroup::kDeleted)
+            {
+                Grow();
+                index = FindFirstNonFull(mixedHash);
+            }
+
+            GrowthLeft -= GetCtrl()[index] == FlatSetGroup::kEmpty ? 1 : 0;
+            SetCtrl(index, GetH2(mixedHash));
+            ++ElementCount;
+            return (int32)index;
+        }
+
+        /**
+         * Double capacity, or only drop deleted slots while live ones take at most 25/32 of the table,
+         * that still leaves 3/32 of it as growth so in place rehashes stay amortized.
+         */
+        void Grow()
+        {
+            if (SlotCapacity > (int32)kWidth && (int64)ElementCount * 32 <= (int64)SlotCapacity * 25)
+            {
+                Rehash(SlotCapacity);
+            }
+            else
+            {
+                Rehash(SlotCapacity * 2);
+            }
+        }
+
+        void Rehash(int32 newCapacity)
+        {
+            ENSURE(newCapacity >= (int32)kWidth && std::has_single_bit((uint32)newCapacity));
+            ENSURE(ElementCount <= CapacityToGrowth(newCapacity));
+
+            SlotAllocatorType oldSlots;
+            oldSlots.MoveToEmpty(Slots, 0);
+            CtrlAllocatorType oldCtrl;
+            oldCtrl.MoveToEmpty(Ctrl, 0);
+            const int32 oldCapacity = SlotCapacity;
+
+            Slots.Resize(newCapacity, 0);
+            Ctrl.Resize(newCapacity + (int32)kWidth, 0);
+            SlotCapacity = newCapacity;
+            ResetCtrl();
+            GrowthLeft -= ElementCount;
+
+            ElementType* oldElements = (ElementType*)oldSlots.GetAllocation();
+            const int8* oldCtrlBytes = (const int8*)oldCtrl.GetAllocation();
+            for (int32 oldIndex = 0; oldIndex < oldCapacity; ++oldIndex)
+            {
+                if (oldCtrlBytes[oldIndex] >= 0)
+                {
+                    const uint64 mixedHash = MixHash(KeyFunc::GetHashCode(KeyFunc::GetKey(oldElements[oldIndex])));
+                    const uint32 index = FindFirstNonFull(mixedHash);
+                    SetCtrl(index, GetH2(mixedHash));
+                    RelocateElement(GetSlots() + index, oldElements + oldIndex);
+                }
+            }
+        }
+
+        /** mark every slot empty, growth is reset to an empty table */
+        void ResetCtrl()
+        {
+            Memory::Memset(GetCtrl(), (uint8)FlatSetGroup::kEmpty, SlotCapacity + kWidth);
+            GrowthLeft = CapacityToGrowth(SlotCapacity);
+        }
+
+        /** the first kWidth control bytes are mirrored after the end, so a group load never wraps */
+        void SetCtrl(uint32 index, int8 value)
+        {
+            GetCtrl()[index] = value;
+            if (index < kWidth)
+            {
+                GetCtrl()[SlotCapacity + index] = value;
+            }
+        }
+
+        /**
+         * A removed slot becomes empty again only if no probe could have passed it: if the empties around it
+         * leave no kWidth window of non empty slots, every lookup through here had stopped anyway.
+         */
+        void EraseCtrl(int32 index)
+        {
+            const uint32 mask = (uint32)SlotCapacity - 1;
+            const uint32 emptyAfter = FlatSetGroup(GetCtrl() + index).MatchEmpty();
+            const uint32 emptyBefore = FlatSetGroup(GetCtrl() + (((uint32)index - kWidth) & mask)).MatchEmpty();
+            const bool wasNeverFull = emptyBefore != 0 && emptyAfter != 0
+                && (uint32)(std::countr_zero(emptyAfter) + std::countl_zero((uint16)emptyBefore)) < kWidth;
+
+            SetCtrl(index, wasNeverFull ? FlatSetGroup::kEmpty : FlatSetGroup::kDeleted);
+            GrowthLeft += wasNeverFull ? 1 : 0;
+        }
+
+        static int32 CapacityToGrowth(int32 capacity)
+        {
+            return capacity - capacity / 8;
+        }
+
+        static int32 CapacityForCount(int32 count)
+        {
+            if (count <= 0)
+            {
+                return 0;
+            }
+            return (int32)Math::Max<uint32>(kWidth, std::bit_ceil((uint32)count + (uint32)count / 7 + 1));
+        }
+
+        ElementType* GetSlots() const
+        {
+            return (ElementType*)Slots.GetAllocation();
+        }
+
+        int8* GetCtrl() const
+        {
+            return (int8*)Ctrl.GetAllocation();
+        }
+
+        void DestructElements()
+        {
+            if constexpr (!std::is_trivially_destructible_v<ElementType>)
+            {
+                for (int32 index = 0; index < SlotCapacity && ElementCount > 0; ++index)
+                {
+                    if (GetCtrl()[index] >= 0)
+                    {
+                        std::destroy_at(GetSlots() + index);
+                    }
+                }
+            }
+        }
+
+        /** this must hold no live element */
+        void CopyElement(const FlatSet& other)
+        {
+            if (other.SlotCapacity != SlotCapacity)
+            {
+                Slots.Resize(0, 0);
+                Ctrl.Resize(0, 0);
+                Slots.Resize(other.SlotCapacity, 0);
+                Ctrl.Resize(other.SlotCapacity + (int32)kWidth, 0);
+                SlotCapacity = other.SlotCapacity;
+            }
+
+            if (SlotCapacity > 0)
+            {
+                Memory::Memcpy(GetCtrl(), other.GetCtrl(), SlotCapacity + kWidth);
+                for (int32 index = 0; index < SlotCapacity; ++index)
+                {
+                    if (GetCtrl()[index] >= 0)
+                    {
+                        new(GetSlots() + index) ElementType(other.GetSlots()[index]);
+                    }
+                }
+            }
+            ElementCount = other.ElementCount;
+            GrowthLeft = other.GrowthLeft;
+        }
+
+        /** this must hold no live element */
+        void MoveElement(FlatSet&& other)
+        {
+            Slots.MoveToEmpty(other.Slots, 0);
+            Ctrl.MoveToEmpty(other.Ctrl, 0);
+            SlotCapacity = other.SlotCapacity;
+            ElementCount = other.ElementCount;
+            GrowthLeft = other.GrowthLeft;
+            other.SlotCapacity = 0;
+            other.ElementCount = 0;
+            other.GrowthLeft = 0;
+        }
+
+    private:
+        SlotAllocatorType Slots;
+        /** SlotCapacity + kWidth control bytes */
+        CtrlAllocatorType Ctrl;
+        int32 SlotCapacity{ 0 };
+        int32 ElementCount{ 0 };
+        /** elements which can still be added into empty slots before the table grows */
+        int32 GrowthLeft{ 0 };
+    };
+}
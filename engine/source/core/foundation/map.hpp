@@ -64,11 +64,25 @@ namespace Engine
     public:
         Pair() = default;
 
-        Pair(KeyType key, ValueType value)
+        Pair(const KeyType& key, const ValueType& value)
             : Key(key)
             , Value(value)
         {}
 
+        template <typename InKeyType, typename InValueType>
+            requires std::is_constructible_v<KeyType, InKeyType&&> && std::is_constructible_v<ValueType, InValueType&&>
+        Pair(InKeyType&& key, InValueType&& value)
+            : Key(Forward<InKeyType>(key))
+            , Value(Forward<InValueType>(value))
+        {}
+
+        /** construct the value from valueArgs in place */
+        template <typename InKeyType, typename... ValueArgs>
+        Pair(std::in_place_t, InKeyType&& key, ValueArgs&&... valueArgs)
+            : Key(Forward<InKeyType>(key))
+            , Value(Forward<ValueArgs>(valueArgs)...)
+        {}
+
         explicit Pair(const std::tuple<KeyType, ValueType>& pair)
             : Key(std::get<0>(pair))
             , Value(std::get<1>(pair))
@@ -88,9 +102,15 @@ namespace Engine
     template <typename KeyType, typename ValueType>
     struct MapDefaultHashFunc
     {
-        static uint32 GetHashCode(const KeyType& key)
+        static uint32 GetHashCode(const KeyType& key) requires Hashable<KeyType>
         {
-            return Engine::GetHashCode(key);
+            return HashValue(key);
+        }
+
+        template <HeterogeneousKeyType<KeyType> ComparableKey>
+        static uint32 GetHashCode(const ComparableKey& key)
+        {
+            return THeterogeneousKey<KeyType, ComparableKey>::GetHashCode(key);
         }
 
         static const KeyType& GetKey(const Pair<KeyType, ValueType>& element)
@@ -102,6 +122,12 @@ namespace Engine
         {
             return lKey == rKey;
         }
+
+        template <HeterogeneousKeyType<KeyType> ComparableKey>
+        static bool Equals(const KeyType& lKey, const ComparableKey& rKey)
+        {
+            return lKey == rKey;
+        }
     };
 
     template <typename KeyType, typename ValueType, typename KeyFunc = MapDefaultHashFunc<KeyType, ValueType>, typename MapAllocator = DefaultSetAllocator>
@@ -148,17 +174,17 @@ namespace Engine
 
         ValueType& Add(const KeyType& key, ValueType&& value)
         {
-            return Emplace(key, value);
+            return Emplace(key, MoveTemp(value));
         }
 
         ValueType& Add(KeyType&& key, const ValueType& value)
         {
-            return Emplace(key, value);
+            return Emplace(MoveTemp(key), value);
         }
 
         ValueType& Add(KeyType&& key, ValueType&& value)
         {
-            return Emplace(key, value);
+            return Emplace(MoveTemp(key), MoveTemp(value));
         }
 
         ValueType& FindOrAdd(const KeyType& key, const ValueType& value)
@@ -168,34 +194,79 @@ namespace Engine
 
         ValueType& FindOrAdd(const KeyType& key, ValueType&& value)
         {
-            return FindOrAddImpl(key, value);
+            return FindOrAddImpl(key, MoveTemp(value));
         }
 
         ValueType& FindOrAdd(KeyType&& key, const ValueType& value)
         {
-            return FindOrAddImpl(key, value);
+            return FindOrAddImpl(MoveTemp(key), value);
         }
 
         ValueType& FindOrAdd(KeyType&& key, ValueType&& value)
         {
-            return FindOrAddImpl(key, value);
+            return FindOrAddImpl(MoveTemp(key), MoveTemp(value));
+        }
+
+        /**
+         * Add by the hash of key, the value of an existing key is overwritten.
+         *
+         * @param hashCode must equal KeyFunc::GetHashCode(key)
+         */
+        template <typename InKeyType, typename InValueType>
+        ValueType& AddByHash(uint32 hashCode, InKeyType&& key, InValueType&& value)
+        {
+            ENSURE(hashCode == KeyFunc::GetHashCode(key));
+            return EmplaceHashed(hashCode, Forward<InKeyType>(key), Forward<InValueType>(value));
+        }
+
+        /** value of key, or value added for key, with the hash already computed */
+        template <typename InKeyType, typename InValueType>
+        ValueType& FindOrAddByHash(uint32 hashCode, InKeyType&& key, InValueType&& value)
+        {
+            ENSURE(hashCode == KeyFunc::GetHashCode(key));
+            return FindOrAddHashed(hashCode, Forward<InKeyType>(key), Forward<InValueType>(value));
         }
 
-        ValueType* Find(const KeyType& key) const
+        /**
+         * Constructs the value from valueArgs in place, the value of an existing key is replaced.
+         * The pair of a new key is built directly in its slot, without a temporary.
+         */
+        template <typename InKeyType, typename... ValueArgs>
+        ValueType& Emplace(InKeyType&& key, ValueArgs&&... valueArgs)
         {
-            if (TPairType* pair = Pairs.Find(key))
+            return EmplaceHashed(KeyFunc::GetHashCode(key), Forward<InKeyType>(key), Forward<ValueArgs>(valueArgs)...);
+        }
+
+        template <typename ComparableKey>
+        ValueType* Find(const ComparableKey& key) const
+        {
+            return FindByHash(KeyFunc::GetHashCode(key), key);
+        }
+
+        template <typename ComparableKey>
+        ValueType* FindByHash(uint32 hashCode, const ComparableKey& key) const
+        {
+            if (TPairType* pair = Pairs.FindByHash(hashCode, key))
             {
                 return &pair->Value;
             }
             return nullptr;
         }
 
-        bool Contains(const KeyType& key) const
+        template <typename ComparableKey>
+        bool Contains(const ComparableKey& key) const
         {
             return Pairs.Contains(key);
         }
 
-        bool Remove(const KeyType& key)
+        template <typename ComparableKey>
+        bool Contains(const ComparableKey& key, uint32 hashCode) const
+        {
+            return Pairs.Contains(key, hashCode);
+        }
+
+        template <typename ComparableKey>
+        bool Remove(const ComparableKey& key)
         {
             return Pairs.Remove(key);
         }
@@ -210,6 +281,23 @@ namespace Engine
             return Pairs.Size();
         }
 
+        void Reserve(int32 count)
+        {
+            Pairs.Reserve(count);
+        }
+
+        /** make pairs dense after many Remove, see Set::Compact */
+        void Compact()
+        {
+            Pairs.Compact();
+        }
+
+        /** release the free slots after the last pair, see Set::Shrink */
+        void Shrink()
+        {
+            Pairs.Shrink();
+        }
+
         Iterator begin()
         {
             return Iterator(Pairs.begin());
@@ -227,27 +315,46 @@ namespace Engine
 
         ConstIterator end() const
         {
-            return ConstIterator(Pairs.begin());
+            return ConstIterator(Pairs.end());
         }
     protected:
+        /** hash and probe once, replace the value of an existing key */
+        template <typename InKeyType, typename... ValueArgs>
+        ValueType& EmplaceHashed(uint32 hashCode, InKeyType&& key, ValueArgs&&... valueArgs)
+        {
+            const SetElementIndex index = Pairs.FindIndex(key, hashCode);
+            if (index.IsValid())
+            {
+                ValueType& value = Pairs.Elements[index.Index].Element.Value;
+                if constexpr (sizeof...(ValueArgs) == 1 && (std::is_assignable_v<ValueType&, ValueArgs&&> && ...))
+                {
+                    value = (Forward<ValueArgs>(valueArgs), ...);
+                }
+                else
+                {
+                    value = ValueType(Forward<ValueArgs>(valueArgs)...);
+                }
+                return value;
+            }
+            return Pairs.EmplaceNew(hashCode, std::in_place, Forward<InKeyType>(key), Forward<ValueArgs>(valueArgs)...).Value;
+        }
+
+        /** hash and probe once, keep the value of an existing key */
         template <typename InKeyType, typename InValueType>
-        ValueType& Emplace(InKeyType&& key, InValueType&& value)
+        ValueType& FindOrAddImpl(InKeyType&& key, InValueType&& value)
         {
-            return Pairs.Emplace(Pair(Forward<InKeyType>(key), Forward<InValueType>(value))).Value;
+            return FindOrAddHashed(KeyFunc::GetHashCode(key), Forward<InKeyType>(key), Forward<InValueType>(value));
         }
 
-        //TODO: Calculate hash value twice here
         template <typename InKeyType, typename InValueType>
-        InValueType& FindOrAddImpl(InKeyType&& key, InValueType&& value)
+        ValueType& FindOrAddHashed(uint32 hashCode, InKeyType&& key, InValueType&& value)
         {
-            if (TPairType* pair = Pairs.Find(Forward<InKeyType>(key)))
-            {
-                return pair->Value;
-            }
-            else
+            const SetElementIndex index = Pairs.FindIndex(key, hashCode);
+            if (index.IsValid())
             {
-                return Emplace(Forward<InKeyType>(key), Forward<InValueType>(value));
+                return Pairs.Elements[index.Index].Element.Value;
             }
+            return Pairs.EmplaceNew(hashCode, std::in_place, Forward<InKeyType>(key), Forward<InValueType>(value)).Value;
         }
 
     private:
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <utility>
 #include "misc/type_hash.hpp"
 #include "foundation/sparse_array.hpp"
 
@@ -71,15 +72,36 @@ namespace Engine
 #pragma endregion iterator
 
     /**
-     * Determine default hash function and equals function of set key
+     * Opt in lookup of Key by ComparableKey without building a Key, e.g. FixedString by a string view.
+     * A specialization sets Value and hashes ComparableKey exactly like Engine::GetHashCode of the equal Key.
+     */
+    template <typename Key, typename ComparableKey>
+    struct THeterogeneousKey
+    {
+        static constexpr bool Value = false;
+    };
+
+    /** ComparableKey can look up Key, used as HeterogeneousKeyType<Key> */
+    template <typename ComparableKey, typename Key>
+    concept HeterogeneousKeyType = THeterogeneousKey<Key, ComparableKey>::Value;
+
+    /**
+     * Determine default hash function and equals function of set key, hashing requires a Hashable key.
+     * Key functions with their own hash can derive from it for any key.
      * @tparam Key
      */
     template <typename Key>
     struct DefaultSetKeyFunc
     {
-        static uint32 GetHashCode(const Key& key)
+        static uint32 GetHashCode(const Key& key) requires Hashable<Key>
         {
-            return Engine::GetHashCode(key);
+            return HashValue(key);
+        }
+
+        template <HeterogeneousKeyType<Key> ComparableKey>
+        static uint32 GetHashCode(const ComparableKey& key)
+        {
+            return THeterogeneousKey<Key, ComparableKey>::GetHashCode(key);
         }
 
         static const Key& GetKey(const Key& element)
@@ -91,17 +113,39 @@ namespace Engine
         {
             return lKey == rKey;
         }
+
+        template <HeterogeneousKeyType<Key> ComparableKey>
+        static bool Equals(const Key& lKey, const ComparableKey& rKey)
+        {
+            return lKey == rKey;
+        }
     };
 
-    /** Encapsulates the allocators used by a set in a single type. */
+    /**
+     * Encapsulates the allocators used by a set in a single type.
+     * AutoCompactFreePercent compacts the set once Remove leaves more than that percent of its slots free, 0 never does.
+     * IncrementalRehashBuckets keeps the old buckets when the set grows and moves that many of them to the new
+     * buckets per Add or Remove, so no single insert relinks every element. 0 rehashes at once.
+     */
     template <
         typename InSparseArrayAllocator,
         typename InHashAllocator,
         uint32 ElementsPerHashBucket = 2,
         uint32 MinHashBuckets = 8,
-        uint32 MinCountOfHashedElements = 4>
+        uint32 MinCountOfHashedElements = 4,
+        uint32 InAutoCompactFreePercent = 0,
+        uint32 InIncrementalRehashBuckets = 0>
     struct SetAllocator
     {
+        static_assert(InAutoCompactFreePercent <= 100);
+
+        static constexpr uint32 AutoCompactFreePercent = InAutoCompactFreePercent;
+
+        static constexpr uint32 IncrementalRehashBuckets = InIncrementalRehashBuckets;
+
+        /** slots below this are never auto compacted, small sets iterate fast with holes anyway */
+        static constexpr int32 kMinAutoCompactSlots = 32;
+
         static uint32 GetNumberOfHashBuckets(uint32 hashedElementsCount)
         {
             if (hashedElementsCount >= MinCountOfHashedElements)
@@ -137,20 +181,25 @@ namespace Engine
 
     using DefaultSetAllocator = SetAllocator<DefaultAllocator, DefaultAllocator>;
 
+    /** set allocated from MemStack, see ArenaAllocator */
+    using ArenaSetAllocator = SetAllocator<ArenaAllocator, ArenaAllocator>;
+
+    /** set compacted when half of its slots are free, for long lived sets with heavy Remove traffic */
+    using CompactingSetAllocator = SetAllocator<DefaultAllocator, DefaultAllocator, 2, 8, 4, 50>;
+
+    /** set which spreads rehash over later operations, for large tables where one O(n) insert is a hitch */
+    using IncrementalSetAllocator = SetAllocator<DefaultAllocator, DefaultAllocator, 2, 8, 4, 0, 16>;
+
     template <typename ElementType, typename KeyFunc = DefaultSetKeyFunc<ElementType>, typename SetAllocator = DefaultSetAllocator>
     class Set
     {
         struct SetElement
         {
-            explicit SetElement(const ElementType& element)
-            {
-                Element = element;
-            }
-
-            explicit SetElement(ElementType&& element)
-            {
-                Element = element;
-            }
+            /** construct the element from args in place, the tag keeps copies of SetElement away */
+            template <typename... Args>
+            explicit SetElement(std::in_place_t, Args&&... args)
+                : Element(Forward<Args>(args)...)
+            {}
 
             uint32 HashIndex = 0;
             SetElementIndex HashNextId;
@@ -160,6 +209,18 @@ namespace Engine
         using HashBucketType = typename SetAllocator::HashAllocator::template ElementAllocator<SetElementIndex>;
         using SparseArrayType = SparseArray<SetElement, typename SetAllocator::SparseArrayAllocator>;
 
+        static constexpr bool kIncrementalRehash = SetAllocator::IncrementalRehashBuckets > 0;
+
+        /** buckets before the last growth, elements in buckets from MigrateIndex on are not moved yet */
+        struct IncrementalRehashState
+        {
+            HashBucketType OldHashBucket;
+            uint32 OldBucketCount{ 0 };
+            uint32 MigrateIndex{ 0 };
+        };
+
+        struct NoRehashState {};
+
         friend class ConstSetIterator<Set, ElementType>;
         friend class SetIterator<Set, ElementType>;
         template <typename K, typename V, typename T, typename U> friend class Map;
@@ -219,7 +280,7 @@ namespace Engine
          */
         void Add(const ElementType& element)
         {
-            Emplace(element);
+            EmplaceByHash(KeyFunc::GetHashCode(KeyFunc::GetKey(element)), element, true);
         }
 
         /**
@@ -229,7 +290,38 @@ namespace Engine
          */
         void Add(ElementType&& element)
         {
-            Emplace(element);
+            EmplaceByHash(KeyFunc::GetHashCode(KeyFunc::GetKey(element)), MoveTemp(element), true);
+        }
+
+        /**
+         * Constructs an element from args directly in its slot, an equal element already in set is replaced by it.
+         *
+         * @return the element in set
+         */
+        template <typename... Args>
+        ElementType& Emplace(Args&&... args)
+        {
+            const int32 indexInSparseArray = Elements.AddUnconstructElement();
+            SetElement* item = new(Elements.GetData() + indexInSparseArray) SetElement(std::in_place, Forward<Args>(args)...);
+
+            // the key is only known once constructed, the new slot is not linked yet so it is not found,
+            // without buckets no element is linked and there is nothing to replace
+            const uint32 hashCode = KeyFunc::GetHashCode(KeyFunc::GetKey(item->Element));
+            const SetElementIndex existingIndex = BucketCount ? FindIndex(KeyFunc::GetKey(item->Element), hashCode) : SetElementIndex{};
+            if (existingIndex.IsValid())
+            {
+                auto&& existing = Elements[existingIndex.Index];
+                existing.Element = MoveTemp(item->Element);
+                Elements.RemoveAt(indexInSparseArray);
+                return existing.Element;
+            }
+
+            // only a kept element grows the table, a full rehash links the new slot along with the others
+            if (!CheckRehash(Elements.Size()) || IsMigrating())
+            {
+                LinkElement(SetElementIndex{ indexInSparseArray }, *item, hashCode);
+            }
+            return item->Element;
         }
 
         void Append(std::initializer_list<ElementType> initializer)
@@ -253,32 +345,75 @@ namespace Engine
             return FindIndex(key).IsValid();
         }
 
+        /**
+         * Contains with the hash already computed.
+         *
+         * @param hashCode must equal KeyFunc::GetHashCode(key)
+         */
+        template <typename KeyType>
+        bool Contains(const KeyType& key, uint32 hashCode) const
+        {
+            return FindIndex(key, hashCode).IsValid();
+        }
+
         template <typename KeyType>
         ElementType* Find(const KeyType& key) const
         {
-            ElementType* ret = nullptr;
-            if (Size() > 0)
-            {
-                SetElementIndex* elementIndex = &GetFirstIndex(KeyFunc::GetHashCode(key));
-                while (elementIndex->IsValid())
-                {
-                    auto&& setElement = Elements[elementIndex->Index];
-                    if (KeyFunc::Equals(KeyFunc::GetKey(setElement.Element), key))
-                    {
-                        ret = const_cast<ElementType*>(&setElement.Element);
-                        break;
-                    }
-                    else
-                    {
-                        elementIndex = const_cast<SetElementIndex*>(&setElement.HashNextId);
-                    }
-                }
-            }
-            return ret;
+            return FindByHash(KeyFunc::GetHashCode(key), key);
+        }
+
+        /**
+         * Find with the hash already computed, e.g. cached with the key or shared by several sets.
+         *
+         * @param hashCode must equal KeyFunc::GetHashCode(key)
+         */
+        template <typename KeyType>
+        ElementType* FindByHash(uint32 hashCode, const KeyType& key) const
+        {
+            ENSURE(hashCode == KeyFunc::GetHashCode(key));
+            const SetElementIndex index = FindIndex(key, hashCode);
+            return index.IsValid() ? const_cast<ElementType*>(&Elements[index.Index].Element) : nullptr;
+        }
+
+        /** add element by the hash of its key, an equal element already in set is overwritten */
+        ElementType& AddByHash(uint32 hashCode, const ElementType& element)
+        {
+            ENSURE(hashCode == KeyFunc::GetHashCode(KeyFunc::GetKey(element)));
+            return EmplaceByHash(hashCode, element, true);
+        }
+
+        ElementType& AddByHash(uint32 hashCode, ElementType&& element)
+        {
+            ENSURE(hashCode == KeyFunc::GetHashCode(KeyFunc::GetKey(element)));
+            return EmplaceByHash(hashCode, MoveTemp(element), true);
+        }
+
+        /** return the equal element already in set, or add element */
+        ElementType& FindOrAdd(const ElementType& element)
+        {
+            return EmplaceByHash(KeyFunc::GetHashCode(KeyFunc::GetKey(element)), element, false);
+        }
+
+        ElementType& FindOrAdd(ElementType&& element)
+        {
+            return EmplaceByHash(KeyFunc::GetHashCode(KeyFunc::GetKey(element)), MoveTemp(element), false);
+        }
+
+        ElementType& FindOrAddByHash(uint32 hashCode, const ElementType& element)
+        {
+            ENSURE(hashCode == KeyFunc::GetHashCode(KeyFunc::GetKey(element)));
+            return EmplaceByHash(hashCode, element, false);
+        }
+
+        ElementType& FindOrAddByHash(uint32 hashCode, ElementType&& element)
+        {
+            ENSURE(hashCode == KeyFunc::GetHashCode(KeyFunc::GetKey(element)));
+            return EmplaceByHash(hashCode, MoveTemp(element), false);
         }
 
         /**
          * Removes the specified element from a Set.
+         * With AutoCompactFreePercent set it may compact the set, which invalidates iterators.
          * 
          * @param T key
          * @return boolean true if remove success.
@@ -289,23 +424,21 @@ namespace Engine
             bool ret = false;
             if (Size() > 0)
             {
-                SetElementIndex* elementIndex = &GetFirstIndex(KeyFunc::GetHashCode(key));
-                while (elementIndex->IsValid())
+                MigrateBuckets();
+                const uint32 hashCode = KeyFunc::GetHashCode(key);
+                ret = RemoveFromChain(&GetFirstIndex(hashCode), key);
+                if constexpr (kIncrementalRehash)
                 {
-                    auto&& setElement = Elements[elementIndex->Index];
-                    if (KeyFunc::Equals(KeyFunc::GetKey(setElement.Element), key))
-                    {
-                        uint32 pendingRemoveIndex = elementIndex->Index;
-                        elementIndex->Index = setElement.HashNextId.Index;
-                        Elements.RemoveAt(pendingRemoveIndex);
-                        ret = true;
-                        break;
-                    }
-                    else
+                    if (!ret && IsOldBucketPending(hashCode))
                     {
-                        elementIndex = &setElement.HashNextId;
+                        ret = RemoveFromChain(&GetOldFirstIndex(hashCode), key);
                     }
                 }
+
+                if (ret)
+                {
+                    CheckAutoCompact();
+                }
             }
             return ret;
         }
@@ -313,8 +446,10 @@ namespace Engine
         void Clear(int32 slack = 0)
         {
             ENSURE(slack >= 0);
-            HashBucket.Resize(slack);
             Elements.Clear(slack);
+            // buckets are sized for slack and emptied, stale buckets would link to removed elements
+            BucketCount = slack > 0 ? SetAllocator::GetNumberOfHashBuckets(static_cast<uint32>(slack)) : 0;
+            Rehash();
         }
 
         int32 Size() const
@@ -347,6 +482,22 @@ namespace Engine
             }
         }
 
+        /** make elements dense so iteration skips no hole, element order and iterators are not kept */
+        void Compact()
+        {
+            if (Elements.Compact())
+            {
+                // moved elements are linked by their old index
+                Rehash();
+            }
+        }
+
+        /** release the free slots after the last element, elements do not move */
+        void Shrink()
+        {
+            Elements.Shrink();
+        }
+
         //TODO: impl
         void Resize(int32 capacity)
         {
@@ -355,31 +506,38 @@ namespace Engine
 
         Iterator begin() { return Iterator(Elements.begin()); }
 
-        ConstIterator begin() const { return ConstIterator(const_cast<const SparseArrayType>(Elements).begin()); }
+        ConstIterator begin() const { return ConstIterator(Elements.begin()); }
 
         Iterator end() { return Iterator(Elements.end()); }
 
-        ConstIterator end() const { return ConstIterator(const_cast<const SparseArrayType>(Elements).end()); }
+        ConstIterator end() const { return ConstIterator(Elements.end()); }
 
     private:
+        /** one probe for both the lookup and the insert */
         template <typename InElementType>
-        InElementType& Emplace(InElementType&& element)
+        ElementType& EmplaceByHash(uint32 hashCode, InElementType&& element, bool replaceExisting)
         {
-            uint32 hashCode = KeyFunc::GetHashCode(KeyFunc::GetKey(element));
-
             SetElementIndex index = FindIndex(KeyFunc::GetKey(element), hashCode);
             if (index.IsValid())
             {
                 auto&& setElement = Elements[index.Index];
-                setElement.Element.~ElementType();
-                setElement.Element = element;
+                if (replaceExisting)
+                {
+                    setElement.Element = Forward<InElementType>(element);
+                }
                 return setElement.Element;
             }
 
+            return EmplaceNew(hashCode, Forward<InElementType>(element));
+        }
 
+        /** construct an element known not to be in set from args, hashCode is the hash of its key */
+        template <typename... Args>
+        ElementType& EmplaceNew(uint32 hashCode, Args&&... args)
+        {
             CheckRehash(Elements.Size() + 1);
             int32 indexInSparseArray = Elements.AddUnconstructElement();
-            SetElement* item = new(Elements.GetData() + indexInSparseArray) SetElement(element);
+            SetElement* item = new(Elements.GetData() + indexInSparseArray) SetElement(std::in_place, Forward<Args>(args)...);
             LinkElement(SetElementIndex{ indexInSparseArray }, *item, hashCode);
             return item->Element;
         }
@@ -397,18 +555,53 @@ namespace Engine
         {
             if (Elements.Size() > 0)
             {
-                for (SetElementIndex index = GetFirstIndex(hashCode); index.IsValid(); index = Elements[index].HashNextId)
+                const SetElementIndex index = FindInChain(GetFirstIndex(hashCode), key);
+                if constexpr (kIncrementalRehash)
                 {
-                    if (KeyFunc::Equals(KeyFunc::GetKey(Elements[index].Element), key))
+                    // during migration the key may still sit in its old bucket
+                    if (!index.IsValid() && IsOldBucketPending(hashCode))
                     {
-                        // Return the first match, regardless of whether the set has multiple matches for the key or not.
-                        return index;
+                        return FindInChain(GetOldFirstIndex(hashCode), key);
                     }
                 }
+                return index;
             }
             return SetElementIndex{};
         }
 
+        template <typename KeyType>
+        SetElementIndex FindInChain(SetElementIndex index, const KeyType& key) const
+        {
+            for (; index.IsValid(); index = Elements[index].HashNextId)
+            {
+                if (KeyFunc::Equals(KeyFunc::GetKey(Elements[index].Element), key))
+                {
+                    // Return the first match, regardless of whether the set has multiple matches for the key or not.
+                    return index;
+                }
+            }
+            return SetElementIndex{};
+        }
+
+        /** unlink and remove the element equal to key from the chain starting at elementIndex */
+        template <typename KeyType>
+        bool RemoveFromChain(SetElementIndex* elementIndex, const KeyType& key)
+        {
+            while (elementIndex->IsValid())
+            {
+                auto&& setElement = Elements[elementIndex->Index];
+                if (KeyFunc::Equals(KeyFunc::GetKey(setElement.Element), key))
+                {
+                    uint32 pendingRemoveIndex = elementIndex->Index;
+                    elementIndex->Index = setElement.HashNextId.Index;
+                    Elements.RemoveAt(pendingRemoveIndex);
+                    return true;
+                }
+                elementIndex = &setElement.HashNextId;
+            }
+            return false;
+        }
+
         /** Contains the head of SetElement list */
         SetElementIndex& GetFirstIndex(uint32 hashCode) const
         {
@@ -422,31 +615,149 @@ namespace Engine
             return hashCode & (BucketCount - 1);
         }
 
+        void CheckAutoCompact()
+        {
+            if constexpr (SetAllocator::AutoCompactFreePercent > 0)
+            {
+                const int32 slotCount = Elements.GetMaxIndex();
+                if (slotCount >= SetAllocator::kMinAutoCompactSlots
+                    && static_cast<int64>(slotCount - Elements.Size()) * 100 > static_cast<int64>(slotCount) * SetAllocator::AutoCompactFreePercent)
+                {
+                    Compact();
+                }
+            }
+        }
+
         bool CheckRehash(int32 elementCount)
         {
             uint32 desiredBucketCount = SetAllocator::GetNumberOfHashBuckets(static_cast<uint32>(elementCount));
             if (elementCount > 0 && (!BucketCount || BucketCount < desiredBucketCount))
             {
+                if constexpr (kIncrementalRehash)
+                {
+                    if (Size() > 0)
+                    {
+                        StartMigration(desiredBucketCount);
+                        return true;
+                    }
+                }
                 BucketCount = desiredBucketCount;
                 Rehash();
                 return true;
             }
+            MigrateBuckets();
+            return false;
+        }
+
+        /** keep the current buckets as old ones and link new elements to empty buckets of bucketCount */
+        void StartMigration(uint32 bucketCount)
+        {
+            // growth outran the migration, the rest is finished here
+            FinishMigration();
+
+            RehashState.OldHashBucket = MoveTemp(HashBucket);
+            RehashState.OldBucketCount = BucketCount;
+            RehashState.MigrateIndex = 0;
+            BucketCount = bucketCount;
+            InitHashBucket();
+        }
+
+        /** old buckets are still being migrated, new elements are only linked to the new buckets */
+        bool IsMigrating() const
+        {
+            if constexpr (kIncrementalRehash)
+            {
+                return RehashState.OldBucketCount > 0;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        /** move the elements of the next IncrementalRehashBuckets old buckets to the new buckets */
+        void MigrateBuckets(uint32 bucketCount = SetAllocator::IncrementalRehashBuckets)
+        {
+            if constexpr (kIncrementalRehash)
+            {
+                if (RehashState.OldBucketCount == 0)
+                {
+                    return;
+                }
+
+                SetElementIndex* oldBuckets = (SetElementIndex*)RehashState.OldHashBucket.GetAllocation();
+                const uint32 endIndex = Math::Min(RehashState.OldBucketCount, RehashState.MigrateIndex + bucketCount);
+                for (; RehashState.MigrateIndex < endIndex; ++RehashState.MigrateIndex)
+                {
+                    SetElementIndex index = oldBuckets[RehashState.MigrateIndex];
+                    while (index.IsValid())
+                    {
+                        SetElement& element = Elements[index];
+                        const SetElementIndex nextIndex = element.HashNextId;
+                        LinkElement(index, element, KeyFunc::GetHashCode(KeyFunc::GetKey(element.Element)));
+                        index = nextIndex;
+                    }
+                }
+
+                if (RehashState.MigrateIndex == RehashState.OldBucketCount)
+                {
+                    ResetMigration();
+                }
+            }
+        }
+
+        void FinishMigration()
+        {
+            if constexpr (kIncrementalRehash)
+            {
+                MigrateBuckets(RehashState.OldBucketCount);
+            }
+        }
+
+        void ResetMigration()
+        {
+            if constexpr (kIncrementalRehash)
+            {
+                RehashState.OldHashBucket.Resize(0);
+                RehashState.OldBucketCount = 0;
+                RehashState.MigrateIndex = 0;
+            }
+        }
+
+        /** the old bucket of hashCode is not migrated yet, so it may hold the key */
+        bool IsOldBucketPending(uint32 hashCode) const
+        {
+            if constexpr (kIncrementalRehash)
+            {
+                return RehashState.OldBucketCount > 0 && (hashCode & (RehashState.OldBucketCount - 1)) >= RehashState.MigrateIndex;
+            }
             return false;
         }
 
+        SetElementIndex& GetOldFirstIndex(uint32 hashCode) const
+        {
+            static_assert(kIncrementalRehash);
+            return ((SetElementIndex*)RehashState.OldHashBucket.GetAllocation())[hashCode & (RehashState.OldBucketCount - 1)];
+        }
+
+        void InitHashBucket()
+        {
+            HashBucket.Resize(BucketCount);
+            for (uint32 hashIndex = 0; hashIndex < BucketCount; ++hashIndex)
+            {
+                ((SetElementIndex*)HashBucket.GetAllocation())[hashIndex] = SetElementIndex();
+            }
+        }
+
         void Rehash()
         {
-            // Free the old hash.
+            // Free the old hash, every element is linked again below so a running migration is dropped.
             HashBucket.Resize(0);
+            ResetMigration();
 
             if (BucketCount)
             {
-                HashBucket.Resize(BucketCount);
-                // Init HashBucket
-                for (uint32 hashIndex = 0; hashIndex < BucketCount; ++hashIndex)
-                {
-                    ((SetElementIndex*)HashBucket.GetAllocation())[hashIndex] = SetElementIndex();
-                }
+                InitHashBucket();
 
                 // Add the existing elements to the new hash.
                 for (typename SparseArrayType::Iterator iter = Elements.begin(); iter != Elements.end(); ++iter)
@@ -468,7 +779,21 @@ namespace Engine
 
         void CopyElement(const Set& other)
         {
+            if constexpr (kIncrementalRehash)
+            {
+                // the other set links elements from two bucket arrays, link the copies to one
+                if (other.RehashState.OldBucketCount > 0)
+                {
+                    Elements = other.Elements;
+                    BucketCount = other.BucketCount;
+                    Rehash();
+                    return;
+                }
+                ResetMigration();
+            }
+
             BucketCount = other.BucketCount;
+            static_assert(TIsBitwiseConstructibleV<SetElementIndex, SetElementIndex>);
             HashBucket.Resize(BucketCount);
             Memory::Memcpy(HashBucket.GetAllocation(), const_cast<byte*>(other.HashBucket.GetAllocation()), sizeof(SetElementIndex) * BucketCount);
             Elements = other.Elements;
@@ -480,11 +805,20 @@ namespace Engine
             other.BucketCount = 0;
             HashBucket = MoveTemp(other.HashBucket);
             Elements = MoveTemp(other.Elements);
+            if constexpr (kIncrementalRehash)
+            {
+                RehashState.OldHashBucket = MoveTemp(other.RehashState.OldHashBucket);
+                RehashState.OldBucketCount = other.RehashState.OldBucketCount;
+                RehashState.MigrateIndex = other.RehashState.MigrateIndex;
+                other.RehashState.OldBucketCount = 0;
+                other.RehashState.MigrateIndex = 0;
+            }
         }
 
     private:
         /** count of hash bucket */
         uint32 BucketCount{ 0 };
+        std::conditional_t<kIncrementalRehash, IncrementalRehashState, NoRehashState> RehashState;
         HashBucketType HashBucket;
         SparseArrayType Elements;
     };
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <functional>
+#include "definitions_core.hpp"
+#include "algo/binary_search.hpp"
+#include "algo/stable_sort.hpp"
+#include "foundation/dynamic_array.hpp"
+#include "foundation/map.hpp"
+
+namespace Engine
+{
+#pragma region iterator
+    /** what SortedFlatMap iteration yields, keys and values live in separate arrays so there is no pair to point to */
+    template <typename KeyType, typename ValueType>
+    struct SortedFlatMapPairRef
+    {
+        const KeyType& Key;
+        ValueType& Value;
+    };
+
+    /** ValueType is const for the const iterator */
+    template <typename KeyType, typename ValueType>
+    class SortedFlatMapIterator
+    {
+        template <typename K, typename V> friend class SortedFlatMapIterator;
+    public:
+        SortedFlatMapIterator(const KeyType* key, ValueType* value)
+            : KeyPtr(key)
+            , ValuePtr(value)
+        {}
+
+        /** the iterator converts to the const iterator */
+        template <typename OtherValueType>
+            requires std::is_same_v<const OtherValueType, ValueType>
+        SortedFlatMapIterator(const SortedFlatMapIterator<KeyType, OtherValueType>& other)
+            : KeyPtr(other.KeyPtr)
+            , ValuePtr(other.ValuePtr)
+        {}
+
+        SortedFlatMapPairRef<KeyType, ValueType> operator*() const { return { *KeyPtr, *ValuePtr }; }
+
+        SortedFlatMapIterator& operator++ ()
+        {
+            ++KeyPtr;
+            ++ValuePtr;
+            return *this;
+        }
+
+        friend bool operator== (const SortedFlatMapIterator& lhs, const SortedFlatMapIterator& rhs)
+        {
+            return lhs.KeyPtr == rhs.KeyPtr;
+        }
+
+        friend bool operator!= (const SortedFlatMapIterator& lhs, const SortedFlatMapIterator& rhs)
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        const KeyType* KeyPtr;
+        ValueType* ValuePtr;
+    };
+#pragma endregion iterator
+
+    /**
+     * Map of keys kept sorted in one array and their values in a parallel one, for small read mostly tables
+     * like config or enum names. Lookup is a branchless binary search over keys only, Add and Remove shift
+     * the tail so large maps which change often should use Map.
+     * KeyLess orders keys, a transparent one like std::less<> allows Find by any comparable key.
+     */
+    template <typename KeyType, typename ValueType, typename KeyLess = std::less<>, typename MapAllocator = DefaultAllocator>
+    class SortedFlatMap
+    {
+        using TPairType = Pair<KeyType, ValueType>;
+        using TKeyArray = DynamicArray<KeyType, MapAllocator>;
+        using TValueArray = DynamicArray<ValueType, MapAllocator>;
+    public:
+        using Iterator = SortedFlatMapIterator<KeyType, ValueType>;
+        using ConstIterator = SortedFlatMapIterator<KeyType, const ValueType>;
+
+    public:
+        SortedFlatMap() = default;
+
+        /** sort the pairs once, a later pair overwrites an earlier one with an equal key */
+        SortedFlatMap(std::initializer_list<TPairType> initializer)
+            : SortedFlatMap(initializer.begin(), initializer.end())
+        {}
+
+        template <typename IteratorType>
+        SortedFlatMap(IteratorType begin, IteratorType end)
+        {
+            DynamicArray<TPairType> pairs;
+            for (; begin != end; ++begin)
+            {
+                pairs.Add(*begin);
+            }
+            BuildFromPairs(pairs);
+        }
+
+        /** bulk build from unsorted pairs in O(n log n), pairs is left with moved from elements */
+        explicit SortedFlatMap(DynamicArray<TPairType>&& pairs)
+        {
+            BuildFromPairs(pairs);
+        }
+
+        /** add or overwrite, O(n) for the shift of both arrays */
+        ValueType& Add(const KeyType& key, const ValueType& value)
+        {
+            return Emplace(key, value);
+        }
+
+        ValueType& Add(const KeyType& key, ValueType&& value)
+        {
+            return Emplace(key, MoveTemp(value));
+        }
+
+        ValueType& Add(KeyType&& key, const ValueType& value)
+        {
+            return Emplace(MoveTemp(key), value);
+        }
+
+        ValueType& Add(KeyType&& key, ValueType&& value)
+        {
+            return Emplace(MoveTemp(key), MoveTemp(value));
+        }
+
+        /** return the value of key, or add value if key is not found */
+        ValueType& FindOrAdd(const KeyType& key, const ValueType& value)
+        {
+            return FindOrAddImpl(key, value);
+        }
+
+        ValueType& FindOrAdd(const KeyType& key, ValueType&& value)
+        {
+            return FindOrAddImpl(key, MoveTemp(value));
+        }
+
+        ValueType& FindOrAdd(KeyType&& key, const ValueType& value)
+        {
+            return FindOrAddImpl(MoveTemp(key), value);
+        }
+
+        ValueType& FindOrAdd(KeyType&& key, ValueType&& value)
+        {
+            return FindOrAddImpl(MoveTemp(key), MoveTemp(value));
+        }
+
+        template <typename ComparableKey>
+        ValueType* Find(const ComparableKey& key)
+        {
+            const int32 index = LowerBound(key);
+            return IsMatch(index, key) ? &Values[index] : nullptr;
+        }
+
+        template <typename ComparableKey>
+        const ValueType* Find(const ComparableKey& key) const
+        {
+            const int32 index = LowerBound(key);
+            return IsMatch(index, key) ? &Values[index] : nullptr;
+        }
+
+        template <typename ComparableKey>
+        bool Contains(const ComparableKey& key) const
+        {
+            return IsMatch(LowerBound(key), key);
+        }
+
+        /** index of key in GetKeys() and GetValues(), INDEX_NONE if not found */
+        template <typename ComparableKey>
+        int32 IndexOf(const ComparableKey& key) const
+        {
+            const int32 index = LowerBound(key);
+            return IsMatch(index, key) ? index : INDEX_NONE;
+        }
+
+        template <typename ComparableKey>
+        bool Remove(const ComparableKey& key)
+        {
+            const int32 index = LowerBound(key);
+            if (IsMatch(index, key))
+            {
+                Keys.RemoveAt(index);
+                Values.RemoveAt(index);
+                return true;
+            }
+            return false;
+        }
+
+        void Clear(int32 slack = 0)
+        {
+            Keys.Clear(slack);
+            Values.Clear(slack);
+        }
+
+        int32 Size() const
+        {
+            return Keys.Size();
+        }
+
+        bool IsEmpty() const
+        {
+            return Keys.IsEmpty();
+        }
+
+        void Reserve(int32 count)
+        {
+            Keys.Reserve(count);
+            Values.Reserve(count);
+        }
+
+        /** keys in ascending order */
+        const TKeyArray& GetKeys() const { return Keys; }
+
+        /** values in the order of their keys */
+        const TValueArray& GetValues() const { return Values; }
+
+        Iterator begin() { return Iterator(Keys.Data(), Values.Data()); }
+
+        ConstIterator begin() const { return ConstIterator(Keys.Data(), Values.Data()); }
+
+        Iterator end() { return Iterator(Keys.Data() + Keys.Size(), Values.Data() + Values.Size()); }
+
+        ConstIterator end() const { return ConstIterator(Keys.Data() + Keys.Size(), Values.Data() + Values.Size()); }
+
+    private:
+        template <typename InKeyType, typename InValueType>
+        ValueType& Emplace(InKeyType&& key, InValueType&& value)
+        {
+            const int32 index = LowerBound(key);
+            if (IsMatch(index, key))
+            {
+                Values[index] = Forward<InValueType>(value);
+            }
+            else
+            {
+                Keys.Insert(index, Forward<InKeyType>(key));
+                Values.Insert(index, Forward<InValueType>(value));
+            }
+            return Values[index];
+        }
+
+        template <typename InKeyType, typename InValueType>
+        ValueType& FindOrAddImpl(InKeyType&& key, InValueType&& value)
+        {
+            const int32 index = LowerBound(key);
+            if (!IsMatch(index, key))
+            {
+                Keys.Insert(index, Forward<InKeyType>(key));
+                Values.Insert(index, Forward<InValueType>(value));
+            }
+            return Values[index];
+        }
+
+        template <typename ComparableKey>
+        int32 LowerBound(const ComparableKey& key) const
+        {
+            return Algo::LowerBound(Keys, key, KeyLess());
+        }
+
+        /** key at index, the lower bound of key, is equal to key */
+        template <typename ComparableKey>
+        bool IsMatch(int32 index, const ComparableKey& key) const
+        {
+            return index < Keys.Size() && !KeyLess()(key, Keys[index]);
+        }
+
+        void BuildFromPairs(DynamicArray<TPairType>& pairs)
+        {
+            // stable, so of equal keys the last added one ends up last and is kept
+            Algo::StableSortBy(pairs, &TPairType::Key, KeyLess());
+
+            const int32 count = pairs.Size();
+            Clear(count);
+            for (int32 index = 0; index < count; ++index)
+            {
+                if (index + 1 < count && !KeyLess()(pairs[index].Key, pairs[index + 1].Key))
+                {
+                    continue;
+                }
+                Keys.Add(MoveTemp(pairs[index].Key));
+                Values.Add(MoveTemp(pairs[index].Value));
+            }
+        }
+
+    private:
+        TKeyArray Keys;
+        TValueArray Values;
+    };
+}
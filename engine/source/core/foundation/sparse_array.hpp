@@ -3,6 +3,8 @@
 #include "foundation/bit_array.hpp"
 #include "foundation/dynamic_array.hpp"
 #include "foundation/type_traits.hpp"
+#include "memory/memory_ops.hpp"
+#include <new>
 
 namespace Engine
 {
@@ -79,20 +81,29 @@ namespace Engine
     template <typename ElementType, typename Allocator = DefaultAllocator>
     class SparseArray
     {
+        /**
+         * Storage of an element or the links of a free node. Node is trivially copyable so ElementNodes only moves
+         * bytes, live elements which can not be copied or relocated bitwise are handled by SparseArray itself.
+         */
         union ElementLinkNode
         {
-            ElementType Element;
+            alignas(ElementType) byte ElementStorage[sizeof(ElementType)];
             struct
             {
                 int32 PrevIndex;
                 int32 NextIndex;
             };
+
+            ElementType& GetElement() { return *std::launder(reinterpret_cast<ElementType*>(ElementStorage)); }
+
+            const ElementType& GetElement() const { return *std::launder(reinterpret_cast<const ElementType*>(ElementStorage)); }
         };
 
         using TDynamicArray = DynamicArray<ElementLinkNode, Allocator>;
         using TBitArray = BitArray<DefaultAllocator>;
 
         template <typename T, typename U, typename V> friend class Set;
+        template <typename T, typename U> friend class SparseArray;
 
     public:
         using ConstIterator = ConstSparseIterator<SparseArray, ElementType, TBitArray::ConstValidIterator>;
@@ -117,11 +128,9 @@ namespace Engine
         }
 
         SparseArray(const SparseArray& other)
-            : FirstFreeNodeIndex(other.FirstFreeNodeIndex)
-            , FreeElementCount(other.FreeElementCount)
-            , AllocateFlags(other.AllocateFlags)
-            , ElementNodes(other.ElementNodes)
-        {}
+        {
+            CopyNodes(other);
+        }
 
         SparseArray(SparseArray&& other) noexcept
             : FirstFreeNodeIndex(other.FirstFreeNodeIndex)
@@ -135,11 +144,14 @@ namespace Engine
 
         template <typename OtherAllocator>
         explicit SparseArray(const SparseArray<ElementType, OtherAllocator>& other)
-            : FirstFreeNodeIndex(other.FirstFreeNodeIndex)
-            , FreeElementCount(other.FreeElementCount)
-            , AllocateFlags(other.AllocateFlags)
-            , ElementNodes(other.ElementNodes)
-        {}
+        {
+            CopyNodes(other);
+        }
+
+        ~SparseArray()
+        {
+            DestructLiveElements();
+        }
 
         SparseArray& operator= (std::initializer_list<ElementType> initializer)
         {
@@ -150,16 +162,15 @@ namespace Engine
         SparseArray& operator= (const SparseArray& other)
         {
             ENSURE(this != &other);
-            FirstFreeNodeIndex = other.FirstFreeNodeIndex;
-            FreeElementCount = other.FreeElementCount;
-            AllocateFlags = other.AllocateFlags;
-            ElementNodes = other.ElementNodes;
+            DestructLiveElements();
+            CopyNodes(other);
             return *this;
         }
 
         SparseArray& operator= (SparseArray&& other) noexcept
         {
             ENSURE(this != &other);
+            DestructLiveElements();
             FirstFreeNodeIndex = other.FirstFreeNodeIndex;
             other.FirstFreeNodeIndex = INDEX_NONE;
             FreeElementCount = other.FreeElementCount;
@@ -172,10 +183,8 @@ namespace Engine
         template <typename OtherAllocator>
         SparseArray& operator= (const SparseArray<ElementType, OtherAllocator>& other)
         {
-            FirstFreeNodeIndex = other.FirstFreeNodeIndex;
-            FreeElementCount = other.FreeElementCount;
-            AllocateFlags = other.AllocateFlags;
-            ElementNodes = other.ElementNodes;
+            DestructLiveElements();
+            CopyNodes(other);
             return *this;
         }
 
@@ -204,13 +213,13 @@ namespace Engine
         ElementType& operator[] (int32 index)
         {
             ENSURE(0 <=index && AllocateFlags[index]);
-            return ElementNodes[index].Element;
+            return ElementNodes[index].GetElement();
         }
 
         const ElementType& operator[] (int32 index) const
         {
             ENSURE(0 <= index && AllocateFlags[index]);
-            return ElementNodes[index].Element;
+            return ElementNodes[index].GetElement();
         }
 
         uint32 Add(const ElementType& element)
@@ -220,7 +229,7 @@ namespace Engine
 
         uint32 Add(ElementType&& element)
         {
-            return Emplace(element);
+            return Emplace(MoveTemp(element));
         }
 
         void Insert(int32 index, const ElementType& element)
@@ -239,21 +248,13 @@ namespace Engine
         {
             ENSURE(0 <= index && index < GetMaxIndex());
             ElementLinkNode& node = ElementNodes[index];
-            node.Element.~ElementType();
+            DestructElements(&node.GetElement(), 1);
             RemoveWithoutDestruct(index, &node);
         }
 
         void Clear(int32 slack)
         {
-            if constexpr (HasUserDestructorV<ElementType>)
-            {
-                typedef ElementType DestructItemsElementTypeTypedef;
-                for (Iterator iter = begin(); iter != end(); ++iter)
-                {
-                    *iter.~DestructItemsElementTypeTypedef();
-                }
-            }
-
+            DestructLiveElements();
             FirstFreeNodeIndex = INDEX_NONE;
             FreeElementCount = 0;
             ElementNodes.Clear(slack);
@@ -265,6 +266,7 @@ namespace Engine
             if (GetMaxIndex() < count)
             {
                 int32 elementToAdd = count - GetMaxIndex();
+                ReserveNodes(count);
                 int32 startIndex = ElementNodes.AddUnconstructElement(elementToAdd);
 
                 int32 remain = count;
@@ -285,6 +287,75 @@ namespace Engine
             }
         }
 
+        /**
+         * Move the elements at the end into the holes in front so they take [0, Size()), order is not kept.
+         * Indexes of moved elements change, the allocation is kept.
+         *
+         * @return true if any element moved
+         */
+        bool Compact()
+        {
+            if (FreeElementCount == 0)
+            {
+                return false;
+            }
+
+            const int32 liveCount = Size();
+            bool moved = false;
+            int32 sourceIndex = GetMaxIndex();
+            for (int32 holeIndex = 0; holeIndex < liveCount; ++holeIndex)
+            {
+                if (AllocateFlags[holeIndex])
+                {
+                    continue;
+                }
+
+                // as many live elements lie past liveCount as holes lie before it
+                do
+                {
+                    --sourceIndex;
+                }
+                while (!AllocateFlags[sourceIndex]);
+
+                RelocateElement(&GetData()[holeIndex].GetElement(), &GetData()[sourceIndex].GetElement());
+                AllocateFlags[holeIndex] = true;
+                moved = true;
+            }
+
+            TruncateNodes(liveCount);
+            FirstFreeNodeIndex = INDEX_NONE;
+            FreeElementCount = 0;
+            return moved;
+        }
+
+        /** drop the free slots after the last element and release the capacity they leave, indexes do not change */
+        void Shrink()
+        {
+            int32 maxIndex = GetMaxIndex();
+            while (maxIndex > 0 && !AllocateFlags[maxIndex - 1])
+            {
+                UnlinkFreeNode(--maxIndex);
+                FreeElementCount--;
+            }
+            TruncateNodes(maxIndex);
+
+            if constexpr (TIsTriviallyRelocatableV<ElementType>)
+            {
+                ElementNodes.ShrinkToFit();
+            }
+            else if (ElementNodes.Capacity() > maxIndex)
+            {
+                ReallocateNodes(maxIndex);
+            }
+            AllocateFlags.Resize(maxIndex);
+        }
+
+        /** share of slots below GetMaxIndex() which hold no element */
+        float GetFreeRatio() const
+        {
+            return GetMaxIndex() > 0 ? static_cast<float>(FreeElementCount) / static_cast<float>(GetMaxIndex()) : 0.0f;
+        }
+
         bool HasElement(int32 index) const
         {
             ENSURE(index >= 0 && index < GetMaxIndex());
@@ -329,7 +400,7 @@ namespace Engine
 
         ConstIterator end() const { return ConstIterator(*this, AllocateFlags.CreateValidIterator(AllocateFlags.Size())); }
 
-    private:
+        /** construct an element from args in the first free slot, return its index */
         template <typename... Args>
         int32 Emplace(Args&&... args)
         {
@@ -338,6 +409,8 @@ namespace Engine
             return index;
         }
 
+    private:
+
         void CopyElement(const ElementType* data, int32 count)
         {
             ENSURE(count >= 0);
@@ -359,11 +432,16 @@ namespace Engine
                 index = FirstFreeNodeIndex;
                 AllocateFlags[index] = true;
                 FirstFreeNodeIndex = node.NextIndex;
+                if (FirstFreeNodeIndex != INDEX_NONE)
+                {
+                    ElementNodes[FirstFreeNodeIndex].PrevIndex = INDEX_NONE;
+                }
                 FreeElementCount--;
             }
             else
             {
                 // add new element
+                ReserveNodes(GetMaxIndex() + 1);
                 index = ElementNodes.AddUnconstructElement(1);
                 AllocateFlags.Add(true);
             }
@@ -381,6 +459,13 @@ namespace Engine
             ENSURE(AllocateFlags[index] == false);
 
             FreeElementCount--;
+            UnlinkFreeNode(index);
+            AllocateFlags[index] = true;
+        }
+
+        /** take a free node out of the free list */
+        void UnlinkFreeNode(int32 index)
+        {
             ElementLinkNode& node = ElementNodes[index];
             int32 prevIndex = node.PrevIndex;
             int32 nextIndex = node.NextIndex;
@@ -398,8 +483,82 @@ namespace Engine
             {
                 FirstFreeNodeIndex = nextIndex;
             }
+        }
 
-            AllocateFlags[index] = true;
+        /** drop the nodes from count to the end, they must hold no element */
+        void TruncateNodes(int32 count)
+        {
+            ElementNodes.Resize(count);
+            AllocateFlags.Truncate(count);
+        }
+
+        void DestructLiveElements()
+        {
+            if constexpr (!std::is_trivially_destructible_v<ElementType>)
+            {
+                for (auto iter = AllocateFlags.CreateValidIterator(); (bool)iter; ++iter)
+                {
+                    DestructElements(&ElementNodes[iter.GetIndex()].GetElement(), 1);
+                }
+            }
+        }
+
+        /** this must hold no live element */
+        template <typename OtherAllocator>
+        void CopyNodes(const SparseArray<ElementType, OtherAllocator>& other)
+        {
+            FirstFreeNodeIndex = other.FirstFreeNodeIndex;
+            FreeElementCount = other.FreeElementCount;
+            AllocateFlags = other.AllocateFlags;
+
+            // links of free nodes and elements which allow it are copied as bytes
+            const int32 maxIndex = other.GetMaxIndex();
+            ElementNodes.Clear(maxIndex);
+            if (maxIndex > 0)
+            {
+                ElementNodes.AddUnconstructElement(maxIndex);
+                Memory::Memcpy(ElementNodes.Data(), (void*)other.GetData(), maxIndex * sizeof(ElementLinkNode));
+            }
+
+            if constexpr (!TIsBitwiseConstructibleV<ElementType, ElementType>)
+            {
+                for (auto iter = AllocateFlags.CreateValidIterator(); (bool)iter; ++iter)
+                {
+                    new(&ElementNodes[iter.GetIndex()].GetElement()) ElementType(other[iter.GetIndex()]);
+                }
+            }
+        }
+
+        /** ElementNodes grows by moving bytes, elements which are not trivially relocatable are moved here before */
+        void ReserveNodes(int32 nodeCount)
+        {
+            if constexpr (!TIsTriviallyRelocatableV<ElementType>)
+            {
+                if (nodeCount <= ElementNodes.Capacity())
+                {
+                    return;
+                }
+
+                ReallocateNodes(Math::Max(nodeCount, ElementNodes.CalculateGrowth(nodeCount)));
+            }
+        }
+
+        /** move the nodes to a new allocation of capacity, elements are relocated one by one */
+        void ReallocateNodes(int32 capacity)
+        {
+            TDynamicArray newNodes(capacity);
+            const int32 maxIndex = GetMaxIndex();
+            if (maxIndex > 0)
+            {
+                newNodes.AddUnconstructElement(maxIndex);
+                Memory::Memcpy(newNodes.Data(), ElementNodes.Data(), maxIndex * sizeof(ElementLinkNode));
+                for (auto iter = AllocateFlags.CreateValidIterator(); (bool)iter; ++iter)
+                {
+                    const int32 index = iter.GetIndex();
+                    RelocateElement(&newNodes.Data()[index].GetElement(), &ElementNodes.Data()[index].GetElement());
+                }
+            }
+            ElementNodes = MoveTemp(newNodes);
         }
 
         void RemoveWithoutDestruct(int32 index, ElementLinkNode* node = nullptr)
@@ -42,8 +42,10 @@ namespace Engine
         using Super::Add;
         using Super::Insert;
         using Super::RemoveAt;
+        using Super::RemoveAtSwap;
         using Super::Remove;
         using Super::RemoveMatch;
+        using Super::RemoveAllSwap;
         using Super::At;
     };
 }
@@ -7,6 +7,7 @@
 #include "foundation/dynamic_array.hpp"
 #include "foundation/string_view.hpp"
 #include "foundation/char_utils.hpp"
+#include "misc/type_hash.hpp"
 
 namespace Engine
 {
@@ -108,6 +109,11 @@ namespace Engine
     private:
         InnerString Internal;
     };
+
+    inline uint32 GetHashCode(const String& str)
+    {
+        return static_cast<uint32>(str.GetHash());
+    }
 }
 
 using namespace Engine;
@@ -34,14 +34,18 @@ using EnableIfT = typename std::enable_if<Test, Type>::type;
 template <typename Type>
 using IsPointer = std::is_pointer<Type>;
 
+/** true if Type is one of Types */
+template <typename Type, typename... Types>
+constexpr bool IsAnyOfV = (std::is_same_v<Type, Types> || ...);
+
 template <typename Type>
-constexpr bool IsUnsignedIntegralV = std::_Is_any_of_v<std::remove_cv_t<Type>, uint8, uint16, uint32, uint64>;
+constexpr bool IsUnsignedIntegralV = IsAnyOfV<std::remove_cv_t<Type>, uint8, uint16, uint32, uint64>;
 
 template <typename Type>
-constexpr bool IsSignedIntegralV = std::_Is_any_of_v<std::remove_cv_t<Type>, int8, int16, int32, int64>;
+constexpr bool IsSignedIntegralV = IsAnyOfV<std::remove_cv_t<Type>, int8, int16, int32, int64>;
 
 template <typename Type>
-constexpr bool IsIntegralV = std::_Is_any_of_v<std::remove_cv_t<Type>, int8, uint8, int16, uint16, int32, uint32, int64, uint64>;
+constexpr bool IsIntegralV = IsAnyOfV<std::remove_cv_t<Type>, int8, uint8, int16, uint16, int32, uint32, int64, uint64>;
 
 template <typename Type>
 struct IsUnsignedIntegral : std::bool_constant<IsUnsignedIntegralV<Type>> {};
@@ -50,10 +54,10 @@ template <typename Type>
 struct IsIntegral : std::bool_constant<IsIntegralV<Type>> {};
 
 template <typename Type>
-constexpr bool HasTrivialDestructorV = __has_trivial_destructor(Type);
+constexpr bool HasTrivialDestructorV = std::is_trivially_destructible_v<Type>;
 
 template <typename Type>
-constexpr bool HasUserDestructorV = __has_virtual_destructor(Type) || __has_user_destructor(Type);
+constexpr bool HasUserDestructorV = std::has_virtual_destructor_v<Type> || !std::is_trivially_destructible_v<Type>;
 
 /** return type depend predicate */
 template <bool Predicate, typename TrueType, typename FalseType>
@@ -76,3 +80,26 @@ concept SignedIntegralType = IsSignedIntegralV<T>;
 
 template <typename T>
 concept IntegralType = IsIntegralV<T>;
+
+/**
+ * Type can be moved to another address with memcpy, the source bytes are dropped without calling destructor.
+ * Trivially copyable types qualify, specialize it for types which own memory but never point into themselves.
+ */
+template <typename Type>
+struct TIsTriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<Type>> {};
+
+template <typename Type>
+constexpr bool TIsTriviallyRelocatableV = TIsTriviallyRelocatable<std::remove_cv_t<Type>>::value;
+
+/** DestType can be constructed from SourceType with memcpy */
+template <typename DestType, typename SourceType>
+struct TIsBitwiseConstructible : std::bool_constant<
+    std::is_same_v<std::remove_cv_t<DestType>, std::remove_cv_t<SourceType>> && std::is_trivially_copy_constructible_v<DestType>> {};
+
+/** integers of the same size have the same bits */
+template <typename DestType, typename SourceType>
+    requires IsIntegralV<DestType> && IsIntegralV<SourceType> && (sizeof(DestType) == sizeof(SourceType))
+struct TIsBitwiseConstructible<DestType, SourceType> : std::true_type {};
+
+template <typename DestType, typename SourceType>
+constexpr bool TIsBitwiseConstructibleV = TIsBitwiseConstructible<DestType, SourceType>::value;
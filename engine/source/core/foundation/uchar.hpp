@@ -3,6 +3,7 @@
 #include "definitions_core.hpp"
 #include "global.hpp"
 #include "log/logger.hpp"
+#include "foundation/type_traits.hpp"
 
 namespace Engine
 {
@@ -252,7 +253,7 @@ namespace Engine
     #define K_UTF16_TO_UCHAR(str) reinterpret_cast<const UChar*>(str)
 
     template <typename Type>
-    constexpr bool IsCharV = std::_Is_any_of_v<std::remove_cv_t<Type>, char, wchar_t, char8_t, char16_t, char32_t, UChar>;
+    constexpr bool IsCharV = IsAnyOfV<std::remove_cv_t<Type>, char, wchar_t, char8_t, char16_t, char32_t, UChar>;
 
     template <typename T>
     concept CharConcept = IsCharV<T>;
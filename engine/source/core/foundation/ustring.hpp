@@ -6,6 +6,7 @@
 #include "foundation/char_utils.hpp"
 #include "foundation/dynamic_array.hpp"
 #include "foundation/string_type.hpp"
+#include "misc/type_hash.hpp"
 
 namespace Engine
 {
@@ -18,6 +19,8 @@ namespace Engine
         using SourceType = DynamicArray<UChar, InlineAllocator<8>>;
         using Iterator = SourceType::Iterator;
         using ConstIterator = SourceType::ConstIterator;
+        using ReverseIterator = SourceType::ReverseIterator;
+        using ConstReverseIterator = SourceType::ConstReverseIterator;
 
     public:
         UString() = default;
@@ -228,15 +231,15 @@ namespace Engine
         inline Iterator end();
         inline ConstIterator end() const;
 
-        inline Iterator rbegin();
-        inline ConstIterator rbegin() const;
-        inline Iterator rend();
-        inline ConstIterator rend() const;
+        inline ReverseIterator rbegin();
+        inline ConstReverseIterator rbegin() const;
+        inline ReverseIterator rend();
+        inline ConstReverseIterator rend() const;
 
-        inline ConstIterator cbegin();
-        inline ConstIterator cend();
-        inline ConstIterator crbegin();
-        inline ConstIterator crend();
+        inline ConstIterator cbegin() const;
+        inline ConstIterator cend() const;
+        inline ConstReverseIterator crbegin() const;
+        inline ConstReverseIterator crend() const;
 
         template <typename... Args>
         static UString Formats(const char* fmt, Args&&... args)
@@ -449,50 +452,50 @@ namespace Engine
 
     UString::Iterator UString::end()
     {
-        return Iterator(Source, Length());
+        return Source.begin() + Length();
     }
 
     UString::ConstIterator UString::end() const
     {
-        return ConstIterator(Source, Length());
+        return Source.begin() + Length();
     }
 
-    UString::Iterator UString::rbegin()
+    UString::ReverseIterator UString::rbegin()
     {
-        return Iterator(Source, Length());
+        return ReverseIterator(end());
     }
 
-    UString::ConstIterator UString::rbegin() const
+    UString::ConstReverseIterator UString::rbegin() const
     {
-        return ConstIterator(Source, Length());
+        return ConstReverseIterator(end());
     }
 
-    UString::Iterator UString::rend()
+    UString::ReverseIterator UString::rend()
     {
         return Source.rend();
     }
 
-    UString::ConstIterator UString::rend() const
+    UString::ConstReverseIterator UString::rend() const
     {
         return Source.rend();
     }
 
-    UString::ConstIterator UString::cbegin()
+    UString::ConstIterator UString::cbegin() const
     {
         return Source.cbegin();
     }
 
-    UString::ConstIterator UString::cend()
+    UString::ConstIterator UString::cend() const
     {
-        return ConstIterator(Source, Length());
+        return end();
     }
 
-    UString::ConstIterator UString::crbegin()
+    UString::ConstReverseIterator UString::crbegin() const
     {
-        return ConstIterator(Source, Length());
+        return rbegin();
     }
 
-    UString::ConstIterator UString::crend()
+    UString::ConstReverseIterator UString::crend() const
     {
         return Source.crend();
     }
@@ -503,7 +506,7 @@ struct CORE_API std::hash<UString>
 {
     size_t operator()(const UString& str) const
     {
-        return 1;
+        return HashBytes(str.Data(), str.Length() * sizeof(UChar));
     }
 };
 
@@ -512,7 +515,7 @@ struct CORE_API std::less<UString>
 {
     bool operator()(const UString& lhs, const UString& rhs) const
     {
-        return lhs.Compare(rhs);
+        return lhs.Compare(rhs) < 0;
     }
 };
 
@@ -13,4 +13,7 @@
 #else
     #define LIKELY(expr)    expr
     #define UNLIKELY(expr)  expr
-#endif
\ No newline at end of file
+#endif
+
+#define PL_CONCAT_IMPL(a, b) a##b
+#define PL_CONCAT(a, b) PL_CONCAT_IMPL(a, b)
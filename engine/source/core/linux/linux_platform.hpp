@@ -0,0 +1,24 @@
+#pragma once
+
+#include "global/details/platform_type.hpp"
+
+namespace Engine
+{
+    struct LinuxPlatformType : public PlatformType
+    {
+        // keep the same types as std, long and long long are different types on lp64
+        typedef __SIZE_TYPE__           size_t;
+        typedef __PTRDIFF_TYPE__        ptrdiff;
+        typedef __INTPTR_TYPE__         intptr;
+        typedef uint32                  wcharsize;
+    };
+
+    typedef LinuxPlatformType CorePlatformType;
+
+    #define DLLIMPORT
+    #define DLLEXPORT __attribute__((visibility("default")))
+
+    #define NODISCARD [[nodiscard]]
+
+    #define FORCEINLINE inline __attribute__((always_inline))
+}
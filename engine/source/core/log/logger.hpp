@@ -6,6 +6,7 @@
 #include "spdlog/pattern_formatter.h"
 #include "global.hpp"
 #include "foundation/smart_ptr.hpp"
+#include "memory/memory_tracker.hpp"
 
 namespace Engine
 {
@@ -86,9 +87,14 @@ namespace Engine
 
         LogSystem()
         {
+            MEMORY_TAG_SCOPE(Log);
             std::vector<spdlog::sink_ptr> sinks;
             auto colorSink = MakeSharedPtr<spdlog::sinks::stdout_color_sink_mt>();
+#if PLATFORM_WINDOWS
             colorSink->set_color(spdlog::level::info, colorSink->WHITE);
+#else
+            colorSink->set_color(spdlog::level::info, colorSink->white);
+#endif
             sinks.push_back(colorSink);
             sinks.push_back(MakeSharedPtr<spdlog::sinks::basic_file_sink_mt>("engine_log", "logs/engine_log.txt"));
             Logger = MakeSharedPtr<spdlog::logger>("engine_log", begin(sinks), end(sinks));
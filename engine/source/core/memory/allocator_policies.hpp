@@ -3,6 +3,9 @@
 #include "global.hpp"
 #include "foundation/type_traits.hpp"
 #include "memory/memory.hpp"
+#include "memory/memory_ops.hpp"
+#include "math/generic_math.hpp"
+#include "memory/mem_stack.hpp"
 #include "log/logger.hpp"
 #include "math/limit.hpp"
 
@@ -29,10 +32,25 @@ namespace Engine
                 other.Data = nullptr;
             }
 
+            ~ElementAllocator()
+            {
+                if (Data != nullptr)
+                {
+                    Memory::Free(Data);
+                }
+            }
+
             ElementAllocator& operator= (ElementAllocator&& other) noexcept
             {
-                Data = other.Data;
-                other.Data = nullptr;
+                if (this != &other)
+                {
+                    if (Data != nullptr)
+                    {
+                        Memory::Free(Data);
+                    }
+                    Data = other.Data;
+                    other.Data = nullptr;
+                }
                 return *this;
             }
 
@@ -51,18 +69,88 @@ namespace Engine
                 return Data;
             }
 
+            /** element count global malloc would really reserve for size elements */
+            SizeType QuantizeSize(SizeType size) const
+            {
+                if (size <= 0)
+                {
+                    return size;
+                }
+
+                const size_t quantized = Memory::QuantizeSize(size * sizeof(ElementType), GetAlignment()) / sizeof(ElementType);
+                return (SizeType)Math::Min<size_t>(quantized, (size_t)NumericLimits<SizeType>::Max());
+            }
+
+            size_t GetAllocatedSize(SizeType capacity) const
+            {
+                return Data != nullptr ? capacity * sizeof(ElementType) : 0;
+            }
+
+            /** resize without knowing the content, only for trivially relocatable elements */
             void Resize(SizeType size)
             {
-                if (Data != nullptr || size > 0)
+                static_assert(TIsTriviallyRelocatableV<ElementType>, "use Resize(size, elementCount) for elements not trivially relocatable");
+                if (size <= 0)
                 {
-                    if (Data == nullptr)
-                    {
-                        Data = (byte*)Memory::Malloc(size * sizeof(ElementType));
-                    }
-                    else
-                    {
-                        Data = (byte*)Memory::Realloc(Data, size * sizeof(ElementType));
-                    }
+                    Release();
+                }
+                else if (Data == nullptr)
+                {
+                    Data = (byte*)Memory::Malloc(size * sizeof(ElementType), GetAlignment());
+                }
+                else if (!Memory::TryResizeInPlace(Data, size * sizeof(ElementType)))
+                {
+                    // growth into slack of current allocation needs no copy
+                    Data = (byte*)Memory::Realloc(Data, size * sizeof(ElementType), GetAlignment());
+                }
+            }
+
+            /** resize keeping the first elementCount elements alive */
+            void Resize(SizeType size, SizeType elementCount)
+            {
+                ENSURE(elementCount <= size);
+                if constexpr (TIsTriviallyRelocatableV<ElementType>)
+                {
+                    Resize(size);
+                }
+                else if (size <= 0)
+                {
+                    Release();
+                }
+                else if (Data == nullptr || !Memory::TryResizeInPlace(Data, size * sizeof(ElementType)))
+                {
+                    // realloc would memcpy, move elements one by one instead
+                    byte* newData = (byte*)Memory::Malloc(size * sizeof(ElementType), GetAlignment());
+                    RelocateElements((ElementType*)newData, (ElementType*)Data, elementCount);
+                    Release();
+                    Data = newData;
+                }
+            }
+
+            /** take the allocation of other, this must hold no live element */
+            void MoveToEmpty(ElementAllocator& other, SizeType /*elementCount*/)
+            {
+                if (this != &other)
+                {
+                    Release();
+                    Data = other.Data;
+                    other.Data = nullptr;
+                }
+            }
+
+        private:
+            /** over aligned elements ask malloc for their own alignment */
+            static uint32 GetAlignment()
+            {
+                return Math::Max((uint32)alignof(ElementType), PlatformMemory::GetDefaultAlignment());
+            }
+
+            void Release()
+            {
+                if (Data != nullptr)
+                {
+                    Memory::Free(Data);
+                    Data = nullptr;
                 }
             }
 
@@ -73,6 +161,10 @@ namespace Engine
 
     using DefaultAllocator = HeapSizeAllocator<int32>;
 
+    /**
+     * Keep up to InlineSize elements inside the container, larger arrays spill to SecondaryAllocator.
+     * Shrinking back to InlineSize moves the elements inline again and frees the secondary allocation.
+     */
     template <uint32 InlineSize, typename SecondaryAllocator = DefaultAllocator>
     class InlineAllocator
     {
@@ -89,11 +181,13 @@ namespace Engine
 
             ElementAllocator(const ElementAllocator& other) = delete;
 
+            /** inline slots are moved as bytes, containers use MoveToEmpty which knows the live elements */
             ElementAllocator(ElementAllocator&& other) noexcept
             {
+                static_assert(TIsTriviallyRelocatableV<ElementType>, "use MoveToEmpty for elements not trivially relocatable");
                 if (other.SecondaryData.Empty())
                 {
-                    Memory::Memmove(InlineData, other.InlineData, sizeof(ElementType) * InlineSize);
+                    Memory::Memcpy(InlineData, other.InlineData, sizeof(InlineData));
                 }
 
                 SecondaryData = MoveTemp(other.SecondaryData);
@@ -101,12 +195,16 @@ namespace Engine
 
             ElementAllocator& operator= (ElementAllocator&& other) noexcept
             {
-                if (other.SecondaryData.Empty())
+                static_assert(TIsTriviallyRelocatableV<ElementType>, "use MoveToEmpty for elements not trivially relocatable");
+                if (this != &other)
                 {
-                    Memory::Memcpy(InlineData, other.InlineData, sizeof(ElementType) * InlineSize);
-                }
+                    if (other.SecondaryData.Empty())
+                    {
+                        Memory::Memcpy(InlineData, other.InlineData, sizeof(InlineData));
+                    }
 
-                SecondaryData = MoveTemp(other.SecondaryData);
+                    SecondaryData = MoveTemp(other.SecondaryData);
+                }
                 return *this;
             }
 
@@ -127,25 +225,72 @@ namespace Engine
                 return InlineSize;
             }
 
-            void Resize(int32 size)
+            SizeType QuantizeSize(SizeType size) const
+            {
+                return size <= (SizeType)InlineSize ? size : SecondaryData.QuantizeSize(size);
+            }
+
+            /** inline elements are not counted */
+            size_t GetAllocatedSize(SizeType capacity) const
+            {
+                return SecondaryData.GetAllocatedSize(capacity);
+            }
+
+            /** resize without knowing the content, only for trivially relocatable elements */
+            void Resize(SizeType size)
+            {
+                static_assert(TIsTriviallyRelocatableV<ElementType>, "use Resize(size, elementCount) for elements not trivially relocatable");
+                Resize(size, Math::Min(size, (SizeType)InlineSize));
+            }
+
+            /** resize keeping the first elementCount elements alive */
+            void Resize(SizeType size, SizeType elementCount)
             {
+                ENSURE(elementCount <= size);
+                if (size <= (SizeType)InlineSize)
+                {
+                    if (!SecondaryData.Empty())
+                    {
+                        RelocateElements(GetInlineElements(), (ElementType*)SecondaryData.GetAllocation(), elementCount);
+                        SecondaryData.Resize(0, 0);
+                    }
+                    return;
+                }
+
                 if (!SecondaryData.Empty())
                 {
-                    SecondaryData.Resize(size);
+                    SecondaryData.Resize(size, elementCount);
                     return;
                 }
 
-                if (size <= InlineSize)
+                SecondaryData.Resize(size, 0);
+                RelocateElements((ElementType*)SecondaryData.GetAllocation(), GetInlineElements(), elementCount);
+            }
+
+            /** take elementCount live elements of other, this must hold no live element */
+            void MoveToEmpty(ElementAllocator& other, SizeType elementCount)
+            {
+                if (this == &other)
                 {
                     return;
                 }
 
-                SecondaryData.Resize(size);
-                Memory::Memcpy(SecondaryData.GetAllocation(), InlineData, sizeof(ElementType) * InlineSize);
+                SecondaryData.MoveToEmpty(other.SecondaryData, elementCount);
+                if (SecondaryData.Empty())
+                {
+                    RelocateElements(GetInlineElements(), other.GetInlineElements(), elementCount);
+                }
+            }
+
+        private:
+            ElementType* GetInlineElements()
+            {
+                return reinterpret_cast<ElementType*>(InlineData);
             }
 
         private:
-            ElementType InlineData[InlineSize];
+            /** raw storage, elements are constructed by the container */
+            alignas(ElementType) byte InlineData[InlineSize * sizeof(ElementType)];
 
             SecondaryAllocatorType SecondaryData;
         };
@@ -166,9 +311,11 @@ namespace Engine
 
             ElementAllocator(const ElementAllocator& other) = delete;
 
+            /** slots are moved as bytes, containers use MoveToEmpty which knows the live elements */
             ElementAllocator(ElementAllocator&& other) noexcept
             {
-                Memory::Memcpy(Data, other.Data, sizeof(ElementType) * Size);
+                static_assert(TIsTriviallyRelocatableV<ElementType>, "use MoveToEmpty for elements not trivially relocatable");
+                Memory::Memcpy(Data, other.Data, sizeof(Data));
             }
 
             byte* GetAllocation() const
@@ -181,13 +328,189 @@ namespace Engine
                 return Size;
             }
 
-            void Resize(SizeType size)
+            SizeType QuantizeSize(SizeType size) const
+            {
+                return size;
+            }
+
+            size_t GetAllocatedSize(SizeType /*capacity*/) const
+            {
+                return 0;
+            }
+
+            void Resize(SizeType size, SizeType /*elementCount*/ = 0)
             {
                 ENSURE(size <= Size);
             }
 
+            /** take elementCount live elements of other, this must hold no live element */
+            void MoveToEmpty(ElementAllocator& other, SizeType elementCount)
+            {
+                if (this != &other)
+                {
+                    RelocateElements(reinterpret_cast<ElementType*>(Data), reinterpret_cast<ElementType*>(other.Data), elementCount);
+                }
+            }
+
+        private:
+            /** raw storage, elements are constructed by the container */
+            alignas(ElementType) byte Data[Size * sizeof(ElementType)];
+        };
+    };
+
+    /**
+     * Allocate elements from MemStack of current thread, memory is released when the enclosing MemMark pops.
+     * Container using it must not outlive the mark, and must not be resized on another thread.
+     */
+    class ArenaAllocator
+    {
+    public:
+
+        template <typename ElementType>
+        class ElementAllocator
+        {
+        public:
+            using SizeType = int32;
+
+            ElementAllocator() = default;
+
+            ElementAllocator(const ElementAllocator& other) = delete;
+
+            ElementAllocator(ElementAllocator&& other) noexcept
+            {
+                Data = other.Data;
+                Capacity = other.Capacity;
+                other.Data = nullptr;
+                other.Capacity = 0;
+            }
+
+            ElementAllocator& operator= (ElementAllocator&& other) noexcept
+            {
+                Data = other.Data;
+                Capacity = other.Capacity;
+                other.Data = nullptr;
+                other.Capacity = 0;
+                return *this;
+            }
+
+            bool Empty() const
+            {
+                return Data == nullptr;
+            }
+
+            SizeType GetDefaultSize() const
+            {
+                return 0;
+            }
+
+            byte* GetAllocation() const
+            {
+                return Data;
+            }
+
+            SizeType QuantizeSize(SizeType size) const
+            {
+                return size;
+            }
+
+            /** bytes taken from the stack, shrinking never gives them back */
+            size_t GetAllocatedSize(SizeType /*capacity*/) const
+            {
+                return Capacity * sizeof(ElementType);
+            }
+
+            void Resize(SizeType size)
+            {
+                Resize(size, Capacity);
+            }
+
+            void Resize(SizeType size, SizeType elementCount)
+            {
+                // arena memory is only released by mark, shrinking keeps the allocation
+                if (size <= Capacity)
+                {
+                    return;
+                }
+
+                MemStack& stack = MemStack::Get();
+                if (Data != nullptr && stack.TryGrow(Data, Capacity * sizeof(ElementType), size * sizeof(ElementType)))
+                {
+                    Capacity = size;
+                    return;
+                }
+
+                byte* newData = (byte*)stack.Alloc(size * sizeof(ElementType), alignof(ElementType));
+                if (Data != nullptr)
+                {
+                    RelocateElements((ElementType*)newData, (ElementType*)Data, Math::Min(elementCount, Capacity));
+                }
+                Data = newData;
+                Capacity = size;
+            }
+
+            void MoveToEmpty(ElementAllocator& other, SizeType /*elementCount*/)
+            {
+                if (this != &other)
+                {
+                    *this = MoveTemp(other);
+                }
+            }
+
         private:
-            ElementType Data[Size];
+            byte* Data{ nullptr };
+            SizeType Capacity{ 0 };
         };
     };
-}
\ No newline at end of file
+
+    /**
+     * Capacity policy of DynamicArray.
+     * Grows geometrically by GrowNumerator / GrowDenominator, with Quantize the capacity is rounded up to what
+     * the allocator really reserves so slack of a size class becomes usable elements.
+     * Removal shrinks once less than 1 / ShrinkDivisor of the capacity is used and at least MinShrinkBytes would
+     * be released, ShrinkDivisor 0 never shrinks automatically.
+     */
+    template <uint32 GrowNumerator = 3, uint32 GrowDenominator = 2, uint32 ShrinkDivisor = 4, uint32 MinShrinkBytes = 16 * 1024, bool Quantize = true>
+    struct GrowthPolicy
+    {
+        static_assert(GrowDenominator > 0 && GrowNumerator > GrowDenominator, "growth factor must be larger than 1");
+
+        static constexpr bool kQuantize = Quantize;
+
+        /** capacity to hold newSize elements */
+        template <typename SizeType>
+        static SizeType CalculateGrowth(SizeType newSize, SizeType capacity)
+        {
+            const uint64 max = (uint64)NumericLimits<SizeType>::Max();
+            const uint64 geometric = (uint64)capacity * GrowNumerator / GrowDenominator;
+            if (geometric >= max)
+            {
+                return (SizeType)max;
+            }
+            return Math::Max(newSize, (SizeType)geometric);
+        }
+
+        /** capacity after removal, capacity itself if shrinking is not worth it */
+        template <typename SizeType>
+        static SizeType CalculateShrink(SizeType size, SizeType capacity, size_t elementSize)
+        {
+            if constexpr (ShrinkDivisor == 0)
+            {
+                return capacity;
+            }
+            else
+            {
+                if ((uint64)size * ShrinkDivisor >= (uint64)capacity || (size_t)(capacity - size) * elementSize < MinShrinkBytes)
+                {
+                    return capacity;
+                }
+                // keep a growth step of room, refilling right after a shrink would reallocate at once
+                return Math::Min(capacity, (SizeType)((uint64)size * GrowNumerator / GrowDenominator));
+            }
+        }
+    };
+
+    using DefaultGrowthPolicy = GrowthPolicy<>;
+
+    /** capacity only ever grows unless ShrinkToFit is called */
+    using NoShrinkGrowthPolicy = GrowthPolicy<3, 2, 0>;
+}
@@ -5,10 +5,19 @@
 
 namespace Engine
 {
+    enum class EAnsiMallocMode : uint8
+    {
+        /** over allocate and store raw pointer and size before the block, works with any crt */
+        Header,
+        /** malloc for default alignment and posix_memalign for over aligned request, no extra bytes per allocation,
+         *  the _aligned_* family of msvc crt on windows, which keeps the alignment of a block before it */
+        Aligned
+    };
+
     class CORE_API AnsiCMalloc final : public IMalloc, public SystemNewDeleteObject
     {
     public:
-        AnsiCMalloc() = default;
+        explicit AnsiCMalloc(EAnsiMallocMode mode = EAnsiMallocMode::Aligned);
 
         virtual ~AnsiCMalloc() = default;
 
@@ -18,6 +27,22 @@ namespace Engine
 
         virtual void* Realloc(void* ptr, size_t size, uint32 alignment) final;
 
-        size_t GetAllocateSize(void* ptr);
+        virtual size_t GetAllocationSize(void* ptr) final;
+
+        virtual bool TryResizeInPlace(void* ptr, size_t size) final;
+
+        EAnsiMallocMode GetMode() const;
+
+    private:
+        void* MallocWithHeader(size_t size, uint32 alignment);
+
+        void* ReallocWithHeader(void* ptr, size_t size, uint32 alignment);
+
+        void* MallocAligned(size_t size, uint32 alignment);
+
+        void* ReallocAligned(void* ptr, size_t size, uint32 alignment);
+
+    private:
+        EAnsiMallocMode Mode;
     };
-}
\ No newline at end of file
+}
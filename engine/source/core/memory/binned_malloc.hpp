@@ -5,12 +5,34 @@
 
 namespace Engine
 {
+    /**
+     * Size-class allocator, small allocations are carved from 64KB blocks requested from os,
+     * every size class (bin) owns its blocks and every thread keeps a small cache of free slots per bin,
+     * large allocations go to os directly.
+     *
+     * The header of a block always lives at the 64KB aligned address below a pointer, so Free and Realloc
+     * find the bin of any pointer without extra lookup.
+     */
     class CORE_API BinnedMalloc final : public IMalloc, public SystemNewDeleteObject
     {
     public:
-        BinnedMalloc() = default;
+        struct BlockHeader;
+        struct Bin;
+        struct ThreadCache;
+        struct OSCache;
 
-        virtual ~BinnedMalloc() = default;
+        /** size of block allocated from os, blocks are aligned to it */
+        static constexpr size_t kBlockSize = 64 * 1024;
+        /** allocations larger than it go to os directly */
+        static constexpr uint32 kMaxSmallSize = 8192;
+        /** alignment of every slot in a small block */
+        static constexpr uint32 kMinAlignment = 16;
+        /** max alignment small bins can serve, larger alignments go to os */
+        static constexpr uint32 kMaxSmallAlignment = 64;
+
+        BinnedMalloc();
+
+        virtual ~BinnedMalloc();
 
         virtual void* Malloc(size_t size, uint32 alignment) final;
 
@@ -18,8 +40,47 @@ namespace Engine
 
         virtual void* Realloc(void* ptr, size_t size, uint32 alignment) final;
 
+        virtual size_t GetAllocationSize(void* ptr) final;
+
+        /** succeed while new size fits and doesn't waste more than half of the allocation */
+        virtual bool TryResizeInPlace(void* ptr, size_t size) final;
+
+        /** slot size of the bin for small requests, whole pages minus header for large ones */
+        virtual size_t QuantizeSize(size_t size, uint32 alignment) final;
+
+        /** create the bin cache of current thread, called lazily on first Malloc of a thread */
         virtual void SetupCurrentThreadTLS() final;
 
+        /** return all slots cached by current thread to bins, runs by itself when a thread exits */
+        virtual void ClearCurrentThreadTLS() final;
+
+    private:
+        ThreadCache* GetThreadCache();
+
+        uint32 SelectBin(size_t size, uint32 alignment) const;
+
+        void* MallocSmall(uint32 binIndex);
+
+        void* MallocLarge(size_t size, uint32 alignment);
+
+        /** move up to count slots from bin to cache, allocate a new block if bin is empty */
+        void RefillCache(ThreadCache& cache, uint32 binIndex, uint32 count);
+
+        /** move count slots from cache back to bin */
+        void FlushCache(ThreadCache& cache, uint32 binIndex, uint32 count);
+
+        /** return a slot to its block, caller must hold the lock of bin */
+        void FreeSlotToBlock(Bin& bin, void* ptr);
+
+        /** allocate from os or reuse a cached os allocation, size is updated to the real size */
+        void* AllocFromOS(size_t& size);
+
+        /** keep small os allocations for reuse, release the oldest ones when cache is full */
+        void FreeToOS(void* ptr, size_t size);
+
     private:
+        Bin* Bins{ nullptr };
+        OSCache* CachedOS{ nullptr };
+        uint32 TlsSlot{ 0 };
     };
-}
\ No newline at end of file
+}
@@ -3,37 +3,256 @@
 #include "memory/memory.hpp"
 #include "math/align_utils.hpp"
 #include "math/generic_math.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <malloc.h>
 
 namespace Engine
 {
+    namespace
+    {
+        /** raw pointer and requested size are stored before the returned address */
+        constexpr size_t kHeaderSize = sizeof(void*) + sizeof(size_t);
+        /** alignment malloc always guarantees */
+        constexpr uint32 kCrtAlignment = alignof(std::max_align_t);
+
+        void*& GetRawPtr(void* ptr)
+        {
+            return *((void**)((uint8*)ptr - sizeof(void*)));
+        }
+
+        size_t& GetStoredSize(void* ptr)
+        {
+            return *((size_t*)((uint8*)ptr - sizeof(void*) - sizeof(size_t)));
+        }
+
+        size_t GetRawUsableSize(void* rawPtr)
+        {
+#if PLATFORM_WINDOWS
+            return ::_msize(rawPtr);
+#else
+            return ::malloc_usable_size(rawPtr);
+#endif
+        }
+
+#if PLATFORM_WINDOWS
+        /** _aligned_msize needs the alignment of the block back, it is stored right before the returned address */
+        constexpr size_t kAlignmentSize = sizeof(size_t);
+
+        size_t& GetStoredAlignment(void* ptr)
+        {
+            return *((size_t*)((uint8*)ptr - kAlignmentSize));
+        }
+
+        void* GetAlignedBlock(void* ptr)
+        {
+            return (uint8*)ptr - kAlignmentSize;
+        }
+#endif
+
+        size_t GetAlignedUsableSize(void* ptr)
+        {
+#if PLATFORM_WINDOWS
+            return ::_aligned_msize(GetAlignedBlock(ptr), GetStoredAlignment(ptr), kAlignmentSize) - kAlignmentSize;
+#else
+            return ::malloc_usable_size(ptr);
+#endif
+        }
+
+        void FreeAligned(void* ptr)
+        {
+#if PLATFORM_WINDOWS
+            ::_aligned_free(GetAlignedBlock(ptr));
+#else
+            free(ptr);
+#endif
+        }
+    }
+
+    AnsiCMalloc::AnsiCMalloc(EAnsiMallocMode mode)
+        : Mode(mode)
+    {
+    }
+
     void* AnsiCMalloc::Malloc(size_t size, uint32 alignment)
     {
-        void* ptr = malloc(size + alignment + sizeof(void*) + sizeof(size_t));
-        void* result;
-        result = Align((uint8*)ptr + sizeof(void*) + sizeof(size_t), alignment);
-        *((void**)((uint8*)result - sizeof(void*))) = ptr;
-        *((size_t*)((uint8*)result - sizeof(void*) - sizeof(size_t))) = size;
-        return result;
+        return Mode == EAnsiMallocMode::Aligned ? MallocAligned(size, alignment) : MallocWithHeader(size, alignment);
     }
 
     void AnsiCMalloc::Free(void* ptr)
     {
-        free(*((void**)((uint8*)ptr - sizeof(void*))));
+        if (ptr == nullptr)
+        {
+            return;
+        }
+        if (Mode == EAnsiMallocMode::Aligned)
+        {
+            FreeAligned(ptr);
+        }
+        else
+        {
+            free(GetRawPtr(ptr));
+        }
     }
 
     void* AnsiCMalloc::Realloc(void* ptr, size_t size, uint32 alignment)
+    {
+        if (ptr == nullptr)
+        {
+            return Malloc(size, alignment);
+        }
+
+        if (size == 0)
+        {
+            Free(ptr);
+            return nullptr;
+        }
+
+        if (((uintptr_t)ptr & (alignment - 1)) == 0 && TryResizeInPlace(ptr, size))
+        {
+            return ptr;
+        }
+
+        return Mode == EAnsiMallocMode::Aligned ? ReallocAligned(ptr, size, alignment) : ReallocWithHeader(ptr, size, alignment);
+    }
+
+    size_t AnsiCMalloc::GetAllocationSize(void* ptr)
+    {
+        if (Mode == EAnsiMallocMode::Aligned)
+        {
+            return GetAlignedUsableSize(ptr);
+        }
+
+        void* rawPtr = GetRawPtr(ptr);
+        return GetRawUsableSize(rawPtr) - ((uint8*)ptr - (uint8*)rawPtr);
+    }
+
+    bool AnsiCMalloc::TryResizeInPlace(void* ptr, size_t size)
+    {
+        if (ptr == nullptr)
+        {
+            return false;
+        }
+
+        // keep the block until more than half of it is wasted
+        const size_t usableSize = GetAllocationSize(ptr);
+        if (size <= usableSize && size > usableSize / 2)
+        {
+            if (Mode == EAnsiMallocMode::Header)
+            {
+                GetStoredSize(ptr) = size;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    EAnsiMallocMode AnsiCMalloc::GetMode() const
+    {
+        return Mode;
+    }
+
+    void* AnsiCMalloc::MallocWithHeader(size_t size, uint32 alignment)
+    {
+        void* ptr = malloc(size + alignment + kHeaderSize);
+        void* result;
+        result = Align((uint8*)ptr + kHeaderSize, alignment);
+        GetRawPtr(result) = ptr;
+        GetStoredSize(result) = size;
+        return result;
+    }
+
+    void* AnsiCMalloc::ReallocWithHeader(void* ptr, size_t size, uint32 alignment)
     {
         alignment = Math::Max(size >= 16 ? (uint32)16 : (uint32)8, alignment);
 
-        void* newPtr = Malloc(size, alignment);
-        size_t rawSize = GetAllocateSize(ptr);
-        Memory::Memcpy(newPtr, ptr, Math::Min(size, rawSize));
-        Free(ptr);
-        return newPtr;
+        // let crt grow or shrink the block, it can extend in place or remap pages instead of copy
+        void* rawPtr = GetRawPtr(ptr);
+        const size_t offset = (uint8*)ptr - (uint8*)rawPtr;
+        const size_t oldSize = GetStoredSize(ptr);
+        void* newRawPtr = realloc(rawPtr, Math::Max(size + alignment + kHeaderSize, offset + size));
+        if (newRawPtr == nullptr)
+        {
+            return nullptr;
+        }
+
+        void* result = Align((uint8*)newRawPtr + kHeaderSize, alignment);
+        if (static_cast<size_t>((uint8*)result - (uint8*)newRawPtr) != offset)
+        {
+            // alignment of the new block is different, move data to the new aligned address
+            Memory::Memmove(result, (uint8*)newRawPtr + offset, Math::Min(oldSize, size));
+        }
+        GetRawPtr(result) = newRawPtr;
+        GetStoredSize(result) = size;
+        return result;
+    }
+
+    void* AnsiCMalloc::MallocAligned(size_t size, uint32 alignment)
+    {
+#if PLATFORM_WINDOWS
+        // msvc crt can't free aligned blocks with free, every block of this mode goes through _aligned_*
+        alignment = Math::Max(alignment, kCrtAlignment);
+        uint8* block = (uint8*)::_aligned_offset_malloc(size + kAlignmentSize, alignment, kAlignmentSize);
+        if (block == nullptr)
+        {
+            return nullptr;
+        }
+        void* result = block + kAlignmentSize;
+        GetStoredAlignment(result) = alignment;
+        return result;
+#else
+        if (alignment <= kCrtAlignment)
+        {
+            return malloc(size);
+        }
+
+        void* result = nullptr;
+        if (::posix_memalign(&result, Math::Max<size_t>(alignment, sizeof(void*)), size) != 0)
+        {
+            return nullptr;
+        }
+        return result;
+#endif
     }
 
-    size_t AnsiCMalloc::GetAllocateSize(void* ptr)
+    void* AnsiCMalloc::ReallocAligned(void* ptr, size_t size, uint32 alignment)
     {
-        return *((size_t*)((uint8*)ptr - sizeof(void*) - sizeof(size_t)));
+#if PLATFORM_WINDOWS
+        alignment = Math::Max(alignment, kCrtAlignment);
+        if (GetStoredAlignment(ptr) != alignment)
+        {
+            // _aligned_realloc can't change alignment of a block
+            void* result = MallocAligned(size, alignment);
+            if (result != nullptr)
+            {
+                Memory::Memcpy(result, ptr, Math::Min(size, GetAlignedUsableSize(ptr)));
+                FreeAligned(ptr);
+            }
+            return result;
+        }
+
+        uint8* block = (uint8*)::_aligned_offset_realloc(GetAlignedBlock(ptr), size + kAlignmentSize, alignment, kAlignmentSize);
+        if (block == nullptr)
+        {
+            return nullptr;
+        }
+        void* result = block + kAlignmentSize;
+        GetStoredAlignment(result) = alignment;
+        return result;
+#else
+        if (alignment <= kCrtAlignment)
+        {
+            return realloc(ptr, size);
+        }
+
+        // crt has no aligned realloc, the usable size is an upper bound of the valid data
+        void* result = MallocAligned(size, alignment);
+        if (result != nullptr)
+        {
+            Memory::Memcpy(result, ptr, Math::Min(size, GetRawUsableSize(ptr)));
+            free(ptr);
+        }
+        return result;
+#endif
     }
-}
\ No newline at end of file
+}
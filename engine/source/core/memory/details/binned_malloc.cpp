@@ -1,23 +1,619 @@
 //#include "precompiled_core.hpp"
+#include <mutex>
 #include "memory/binned_malloc.hpp"
+#include "memory/platform_memory.hpp"
+#include "thread/platform_tls.hpp"
+#include "math/generic_math.hpp"
 
 namespace Engine
 {
+    namespace
+    {
+        constexpr uint32 kBlockMagic = 0xB1AA3D01;
+        constexpr uint32 kLargeBinIndex = 0xffffffff;
+        constexpr uint32 kInvalidBinIndex = 0xfffffffe;
+        /** reserved bytes at the begin of a block, keep slots aligned to kMaxSmallAlignment */
+        constexpr uint32 kBlockHeaderSize = BinnedMalloc::kMaxSmallAlignment;
+        /** bytes cached per bin per thread */
+        constexpr uint32 kThreadCacheBytes = 32 * 1024;
+        constexpr uint32 kMinThreadCacheCount = 4;
+        constexpr uint32 kMaxThreadCacheCount = 256;
+        /** freed os allocations kept for reuse, avoid calling os on every large allocation */
+        constexpr uint32 kOSCacheCount = 32;
+        constexpr size_t kMaxOSCacheBytes = 8 * 1024 * 1024;
+        constexpr size_t kMaxCachedOSSize = 1024 * 1024;
+
+        constexpr uint32 kBinSizes[] =
+        {
+            16, 32, 48, 64, 80, 96, 112, 128,
+            160, 192, 224, 256, 320, 384, 448, 512,
+            640, 768, 896, 1024, 1280, 1536, 1792, 2048,
+            2560, 3072, 3584, 4096, 5120, 6144, 7168, 8192
+        };
+        constexpr uint32 kBinCount = sizeof(kBinSizes) / sizeof(kBinSizes[0]);
+        static_assert(kBinSizes[kBinCount - 1] == BinnedMalloc::kMaxSmallSize, "last bin must match kMaxSmallSize");
+
+        /** map (size - 1) / kMinAlignment to bin index */
+        uint8 GSizeToBin[BinnedMalloc::kMaxSmallSize / BinnedMalloc::kMinAlignment];
+
+        struct FreeSlot
+        {
+            FreeSlot* Next;
+        };
+    }
+
+    struct BinnedMalloc::BlockHeader
+    {
+        uint32 Magic;
+        /** kLargeBinIndex if memory is a large allocation */
+        uint32 BinIndex;
+        /** size requested from os */
+        size_t OSSize;
+        FreeSlot* FreeList;
+        BlockHeader* Prev;
+        BlockHeader* Next;
+        /** count of free slots, include slots never handed out */
+        uint32 FreeCount;
+        /** slots after it are never handed out */
+        uint32 UnusedIndex;
+    };
+    static_assert(sizeof(BinnedMalloc::BlockHeader) <= kBlockHeaderSize, "block header is too large");
+
+    struct BinnedMalloc::Bin
+    {
+        std::mutex Mutex;
+        /** blocks which have at least one free slot */
+        BlockHeader* PartialBlocks{ nullptr };
+        uint32 SlotSize{ 0 };
+        uint32 SlotsPerBlock{ 0 };
+        /** max count of slots cached per thread */
+        uint32 CacheCapacity{ 0 };
+    };
+
+    struct BinnedMalloc::ThreadCache : public SystemNewDeleteObject
+    {
+        struct BinCache
+        {
+            FreeSlot* Head{ nullptr };
+            uint32 Count{ 0 };
+        };
+
+        BinCache Caches[kBinCount];
+        BinnedMalloc* Owner{ nullptr };
+        /** next cache of the same thread, a thread has one per BinnedMalloc it allocated from */
+        ThreadCache* NextInThread{ nullptr };
+    };
+
+    namespace
+    {
+        /** set once the exit guard of the thread is gone, trivially destructible so it stays readable after */
+        thread_local bool GThreadExited = false;
+
+        /** flush every cache of a thread back to its BinnedMalloc when the thread exits */
+        struct ThreadExitGuard
+        {
+            BinnedMalloc::ThreadCache* Head{ nullptr };
+
+            ~ThreadExitGuard()
+            {
+                // ClearCurrentThreadTLS unlinks the head
+                while (Head != nullptr)
+                {
+                    Head->Owner->ClearCurrentThreadTLS();
+                }
+                GThreadExited = true;
+            }
+        };
+
+        thread_local ThreadExitGuard GThreadExitGuard;
+
+        void UnlinkFromThread(BinnedMalloc::ThreadCache* cache)
+        {
+            if (GThreadExited)
+            {
+                return;
+            }
+            for (BinnedMalloc::ThreadCache** link = &GThreadExitGuard.Head; *link != nullptr; link = &(*link)->NextInThread)
+            {
+                if (*link == cache)
+                {
+                    *link = cache->NextInThread;
+                    return;
+                }
+            }
+        }
+    }
+
+    struct BinnedMalloc::OSCache
+    {
+        struct Entry
+        {
+            void* Ptr;
+            size_t Size;
+        };
+
+        std::mutex Mutex;
+        Entry Entries[kOSCacheCount];
+        uint32 Count{ 0 };
+        size_t CachedBytes{ 0 };
+    };
+
+    static BinnedMalloc::BlockHeader* GetBlockHeader(void* ptr)
+    {
+        return reinterpret_cast<BinnedMalloc::BlockHeader*>(reinterpret_cast<uintptr_t>(ptr) & ~(BinnedMalloc::kBlockSize - 1));
+    }
+
+    static void LinkBlock(BinnedMalloc::BlockHeader*& head, BinnedMalloc::BlockHeader* block)
+    {
+        block->Prev = nullptr;
+        block->Next = head;
+        if (head != nullptr)
+        {
+            head->Prev = block;
+        }
+        head = block;
+    }
+
+    static void UnlinkBlock(BinnedMalloc::BlockHeader*& head, BinnedMalloc::BlockHeader* block)
+    {
+        if (block->Prev != nullptr)
+        {
+            block->Prev->Next = block->Next;
+        }
+        else
+        {
+            head = block->Next;
+        }
+
+        if (block->Next != nullptr)
+        {
+            block->Next->Prev = block->Prev;
+        }
+        block->Prev = nullptr;
+        block->Next = nullptr;
+    }
+
+    BinnedMalloc::BinnedMalloc()
+    {
+        ENSURE(PlatformMemory::GetBinnedAllocationGranularity() % kBlockSize == 0);
+
+        Bins = static_cast<Bin*>(std::malloc(sizeof(Bin) * kBinCount));
+        for (uint32 binIndex = 0; binIndex < kBinCount; ++binIndex)
+        {
+            Bin* bin = new(Bins + binIndex) Bin();
+            bin->SlotSize = kBinSizes[binIndex];
+            bin->SlotsPerBlock = static_cast<uint32>((kBlockSize - kBlockHeaderSize) / bin->SlotSize);
+            bin->CacheCapacity = Math::Clamp(kThreadCacheBytes / bin->SlotSize, kMinThreadCacheCount, kMaxThreadCacheCount);
+        }
+
+        uint32 binIndex = 0;
+        for (uint32 idx = 0; idx < kMaxSmallSize / kMinAlignment; ++idx)
+        {
+            const uint32 size = (idx + 1) * kMinAlignment;
+            while (kBinSizes[binIndex] < size)
+            {
+                ++binIndex;
+            }
+            GSizeToBin[idx] = static_cast<uint8>(binIndex);
+        }
+
+        CachedOS = new(std::malloc(sizeof(OSCache))) OSCache();
+
+        TlsSlot = PlatformTLS::AllocTls();
+        ENSURE(PlatformTLS::IsTlsIndexValid(TlsSlot));
+    }
+
+    BinnedMalloc::~BinnedMalloc()
+    {
+        // blocks are not returned to os, static objects may still hold memory allocated here
+        ClearCurrentThreadTLS();
+        PlatformTLS::FreeTls(TlsSlot);
+
+        for (uint32 binIndex = 0; binIndex < kBinCount; ++binIndex)
+        {
+            Bins[binIndex].~Bin();
+        }
+        std::free(Bins);
+        Bins = nullptr;
+
+        for (uint32 idx = 0; idx < CachedOS->Count; ++idx)
+        {
+            PlatformMemory::BinnedFreeToOS(CachedOS->Entries[idx].Ptr, CachedOS->Entries[idx].Size);
+        }
+        CachedOS->~OSCache();
+        std::free(CachedOS);
+        CachedOS = nullptr;
+    }
+
     void* BinnedMalloc::Malloc(size_t size, uint32 alignment)
     {
-        return nullptr;
+        if (size <= kMaxSmallSize && alignment <= kMaxSmallAlignment)
+        {
+            const uint32 binIndex = SelectBin(size, alignment);
+            if (binIndex != kInvalidBinIndex)
+            {
+                return MallocSmall(binIndex);
+            }
+        }
+        return MallocLarge(size, alignment);
     }
 
     void BinnedMalloc::Free(void* ptr)
     {
+        if (ptr == nullptr)
+        {
+            return;
+        }
+
+        BlockHeader* block = GetBlockHeader(ptr);
+        ENSURE(block->Magic == kBlockMagic);
+
+        if (block->BinIndex == kLargeBinIndex)
+        {
+            FreeToOS(block, block->OSSize);
+            return;
+        }
+
+        ThreadCache& cache = *GetThreadCache();
+        ThreadCache::BinCache& binCache = cache.Caches[block->BinIndex];
+        FreeSlot* slot = static_cast<FreeSlot*>(ptr);
+        slot->Next = binCache.Head;
+        binCache.Head = slot;
+        ++binCache.Count;
+
+        const uint32 capacity = Bins[block->BinIndex].CacheCapacity;
+        if (binCache.Count > capacity)
+        {
+            FlushCache(cache, block->BinIndex, binCache.Count - capacity / 2);
+        }
     }
 
     void* BinnedMalloc::Realloc(void* ptr, size_t size, uint32 alignment)
     {
-        return nullptr;
+        if (ptr == nullptr)
+        {
+            return Malloc(size, alignment);
+        }
+
+        if (size == 0)
+        {
+            Free(ptr);
+            return nullptr;
+        }
+
+        const bool aligned = (reinterpret_cast<uintptr_t>(ptr) & (alignment - 1)) == 0;
+        if (aligned)
+        {
+            // size class of over aligned allocation may be larger than size needs
+            const uint32 binIndex = GetBlockHeader(ptr)->BinIndex;
+            const bool sameBin = binIndex != kLargeBinIndex && size <= kMaxSmallSize && alignment <= kMaxSmallAlignment && SelectBin(size, alignment) == binIndex;
+            if (sameBin || TryResizeInPlace(ptr, size))
+            {
+                return ptr;
+            }
+        }
+
+        const size_t usableSize = GetAllocationSize(ptr);
+        void* newPtr = Malloc(size, alignment);
+        if (newPtr == nullptr)
+        {
+            // like realloc, the old block stays valid when the new one can not be allocated
+            return nullptr;
+        }
+        PlatformMemory::Memcpy(newPtr, ptr, Math::Min(size, usableSize));
+        Free(ptr);
+        return newPtr;
     }
 
     void BinnedMalloc::SetupCurrentThreadTLS()
     {
+        if (PlatformTLS::GetTlsValue(TlsSlot) == nullptr)
+        {
+            ThreadCache* cache = new ThreadCache();
+            cache->Owner = this;
+            // after the guard is gone only static destruction of main thread allocates, its cache is left to the os
+            if (!GThreadExited)
+            {
+                cache->NextInThread = GThreadExitGuard.Head;
+                GThreadExitGuard.Head = cache;
+            }
+            PlatformTLS::SetTlsValue(TlsSlot, cache);
+        }
+    }
+
+    void BinnedMalloc::ClearCurrentThreadTLS()
+    {
+        ThreadCache* cache = static_cast<ThreadCache*>(PlatformTLS::GetTlsValue(TlsSlot));
+        if (cache == nullptr)
+        {
+            return;
+        }
+
+        for (uint32 binIndex = 0; binIndex < kBinCount; ++binIndex)
+        {
+            FlushCache(*cache, binIndex, cache->Caches[binIndex].Count);
+        }
+        PlatformTLS::SetTlsValue(TlsSlot, nullptr);
+        UnlinkFromThread(cache);
+        delete cache;
+    }
+
+    BinnedMalloc::ThreadCache* BinnedMalloc::GetThreadCache()
+    {
+        void* cache = PlatformTLS::GetTlsValue(TlsSlot);
+        if (UNLIKELY(cache == nullptr))
+        {
+            SetupCurrentThreadTLS();
+            cache = PlatformTLS::GetTlsValue(TlsSlot);
+        }
+        return static_cast<ThreadCache*>(cache);
+    }
+
+    uint32 BinnedMalloc::SelectBin(size_t size, uint32 alignment) const
+    {
+        ENSURE(size <= kMaxSmallSize);
+        uint32 binIndex = GSizeToBin[size > 0 ? (size - 1) / kMinAlignment : 0];
+        if (alignment > kMinAlignment)
+        {
+            // slots of a bin are aligned to the largest power of two divides slot size
+            while (binIndex < kBinCount && kBinSizes[binIndex] % alignment != 0)
+            {
+                ++binIndex;
+            }
+        }
+        return binIndex < kBinCount ? binIndex : kInvalidBinIndex;
+    }
+
+    void* BinnedMalloc::MallocSmall(uint32 binIndex)
+    {
+        ThreadCache& cache = *GetThreadCache();
+        ThreadCache::BinCache& binCache = cache.Caches[binIndex];
+        if (UNLIKELY(binCache.Head == nullptr))
+        {
+            RefillCache(cache, binIndex, Bins[binIndex].CacheCapacity / 2 + 1);
+            if (binCache.Head == nullptr)
+            {
+                return nullptr;
+            }
+        }
+
+        FreeSlot* slot = binCache.Head;
+        binCache.Head = slot->Next;
+        --binCache.Count;
+        return slot;
+    }
+
+    void* BinnedMalloc::MallocLarge(size_t size, uint32 alignment)
+    {
+        const size_t offset = Math::Max<size_t>(kBlockHeaderSize, alignment);
+        if (offset >= kBlockSize)
+        {
+            ENSURE(false);
+            return nullptr;
+        }
+
+        size_t osSize = Math::CeilToMultiple(offset + size, PlatformMemory::GetPageSize());
+        BlockHeader* block = static_cast<BlockHeader*>(AllocFromOS(osSize));
+        if (block == nullptr)
+        {
+            return nullptr;
+        }
+        ENSURE(GetBlockHeader(block) == block);
+
+        block->Magic = kBlockMagic;
+        block->BinIndex = kLargeBinIndex;
+        block->OSSize = osSize;
+        block->FreeList = nullptr;
+        block->Prev = nullptr;
+        block->Next = nullptr;
+        block->FreeCount = 0;
+        block->UnusedIndex = 0;
+        return reinterpret_cast<uint8*>(block) + offset;
+    }
+
+    void BinnedMalloc::RefillCache(ThreadCache& cache, uint32 binIndex, uint32 count)
+    {
+        Bin& bin = Bins[binIndex];
+        ThreadCache::BinCache& binCache = cache.Caches[binIndex];
+
+        std::lock_guard lock(bin.Mutex);
+        while (count > 0)
+        {
+            BlockHeader* block = bin.PartialBlocks;
+            if (block == nullptr)
+            {
+                size_t osSize = kBlockSize;
+                block = static_cast<BlockHeader*>(AllocFromOS(osSize));
+                if (block == nullptr)
+                {
+                    return;
+                }
+                ENSURE(GetBlockHeader(block) == block);
+
+                block->Magic = kBlockMagic;
+                block->BinIndex = binIndex;
+                block->OSSize = osSize;
+                block->FreeList = nullptr;
+                block->FreeCount = bin.SlotsPerBlock;
+                block->UnusedIndex = 0;
+                LinkBlock(bin.PartialBlocks, block);
+            }
+
+            // take slots of this block as many as possible
+            while (count > 0 && block->FreeCount > 0)
+            {
+                FreeSlot* slot = block->FreeList;
+                if (slot != nullptr)
+                {
+                    block->FreeList = slot->Next;
+                }
+                else
+                {
+                    ENSURE(block->UnusedIndex < bin.SlotsPerBlock);
+                    slot = reinterpret_cast<FreeSlot*>(reinterpret_cast<uint8*>(block) + kBlockHeaderSize + block->UnusedIndex * bin.SlotSize);
+                    ++block->UnusedIndex;
+                }
+                --block->FreeCount;
+
+                slot->Next = binCache.Head;
+                binCache.Head = slot;
+                ++binCache.Count;
+                --count;
+            }
+
+            if (block->FreeCount == 0)
+            {
+                UnlinkBlock(bin.PartialBlocks, block);
+            }
+        }
+    }
+
+    void BinnedMalloc::FlushCache(ThreadCache& cache, uint32 binIndex, uint32 count)
+    {
+        Bin& bin = Bins[binIndex];
+        ThreadCache::BinCache& binCache = cache.Caches[binIndex];
+        ENSURE(count <= binCache.Count);
+
+        std::lock_guard lock(bin.Mutex);
+        while (count > 0)
+        {
+            FreeSlot* slot = binCache.Head;
+            binCache.Head = slot->Next;
+            --binCache.Count;
+            --count;
+            FreeSlotToBlock(bin, slot);
+        }
+    }
+
+    void BinnedMalloc::FreeSlotToBlock(Bin& bin, void* ptr)
+    {
+        BlockHeader* block = GetBlockHeader(ptr);
+        ENSURE(block->Magic == kBlockMagic && block->BinIndex != kLargeBinIndex);
+
+        FreeSlot* slot = static_cast<FreeSlot*>(ptr);
+        slot->Next = block->FreeList;
+        block->FreeList = slot;
+
+        if (block->FreeCount++ == 0)
+        {
+            // block was full, make it visible to allocation again
+            LinkBlock(bin.PartialBlocks, block);
+        }
+
+        // release empty block, but always keep one to avoid allocating from os back and forth
+        const bool onlyBlock = bin.PartialBlocks == block && block->Next == nullptr;
+        if (block->FreeCount == bin.SlotsPerBlock && !onlyBlock)
+        {
+            UnlinkBlock(bin.PartialBlocks, block);
+            FreeToOS(block, block->OSSize);
+        }
+    }
+
+    size_t BinnedMalloc::GetAllocationSize(void* ptr)
+    {
+        BlockHeader* block = GetBlockHeader(ptr);
+        ENSURE(block->Magic == kBlockMagic);
+        if (block->BinIndex == kLargeBinIndex)
+        {
+            return block->OSSize - (reinterpret_cast<uint8*>(ptr) - reinterpret_cast<uint8*>(block));
+        }
+        return Bins[block->BinIndex].SlotSize;
+    }
+
+    bool BinnedMalloc::TryResizeInPlace(void* ptr, size_t size)
+    {
+        if (ptr == nullptr)
+        {
+            return false;
+        }
+
+        // keep the allocation until more than half of it is wasted
+        const size_t usableSize = GetAllocationSize(ptr);
+        return size <= usableSize && size > usableSize / 2;
+    }
+
+    size_t BinnedMalloc::QuantizeSize(size_t size, uint32 alignment)
+    {
+        if (size <= kMaxSmallSize && alignment <= kMaxSmallAlignment)
+        {
+            const uint32 binIndex = SelectBin(size, alignment);
+            if (binIndex != kInvalidBinIndex)
+            {
+                return kBinSizes[binIndex];
+            }
+        }
+
+        const size_t offset = Math::Max<size_t>(kBlockHeaderSize, alignment);
+        return Math::CeilToMultiple(offset + size, PlatformMemory::GetPageSize()) - offset;
+    }
+
+    void* BinnedMalloc::AllocFromOS(size_t& size)
+    {
+        if (size <= kMaxCachedOSSize)
+        {
+            std::lock_guard lock(CachedOS->Mutex);
+
+            // best fit, but never waste more than half of the memory
+            uint32 bestIndex = kOSCacheCount;
+            for (uint32 idx = 0; idx < CachedOS->Count; ++idx)
+            {
+                const size_t cachedSize = CachedOS->Entries[idx].Size;
+                if (cachedSize >= size && cachedSize <= size * 2 && (bestIndex == kOSCacheCount || cachedSize < CachedOS->Entries[bestIndex].Size))
+                {
+                    bestIndex = idx;
+                }
+            }
+
+            if (bestIndex != kOSCacheCount)
+            {
+                OSCache::Entry entry = CachedOS->Entries[bestIndex];
+                for (uint32 idx = bestIndex + 1; idx < CachedOS->Count; ++idx)
+                {
+                    CachedOS->Entries[idx - 1] = CachedOS->Entries[idx];
+                }
+                --CachedOS->Count;
+                CachedOS->CachedBytes -= entry.Size;
+
+                size = entry.Size;
+                return entry.Ptr;
+            }
+        }
+
+        return PlatformMemory::BinnedAllocFromOS(size);
+    }
+
+    void BinnedMalloc::FreeToOS(void* ptr, size_t size)
+    {
+        if (size > kMaxCachedOSSize)
+        {
+            PlatformMemory::BinnedFreeToOS(ptr, size);
+            return;
+        }
+
+        std::lock_guard lock(CachedOS->Mutex);
+
+        // evict the oldest entries until there is enough room
+        uint32 evictCount = 0;
+        size_t evictBytes = 0;
+        while (CachedOS->Count - evictCount == kOSCacheCount || CachedOS->CachedBytes - evictBytes + size > kMaxOSCacheBytes)
+        {
+            const OSCache::Entry& entry = CachedOS->Entries[evictCount];
+            PlatformMemory::BinnedFreeToOS(entry.Ptr, entry.Size);
+            evictBytes += entry.Size;
+            ++evictCount;
+        }
+
+        if (evictCount > 0)
+        {
+            for (uint32 idx = evictCount; idx < CachedOS->Count; ++idx)
+            {
+                CachedOS->Entries[idx - evictCount] = CachedOS->Entries[idx];
+            }
+            CachedOS->Count -= evictCount;
+            CachedOS->CachedBytes -= evictBytes;
+        }
+
+        CachedOS->Entries[CachedOS->Count++] = { ptr, size };
+        CachedOS->CachedBytes += size;
     }
-}
\ No newline at end of file
+}
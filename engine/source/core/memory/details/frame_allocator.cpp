@@ -0,0 +1,120 @@
+//#include "precompiled_core.hpp"
+#include "memory/frame_allocator.hpp"
+#include "memory/memory.hpp"
+#include "math/generic_math.hpp"
+
+namespace Engine
+{
+    FrameAllocator::FrameAllocator(uint32 bufferCount, size_t bufferSize)
+        : BufferCount(Math::Clamp<uint32>(bufferCount, 1, kMaxBufferCount))
+        , BufferSize(Math::CeilToMultiple(bufferSize, PlatformMemory::GetPageSize()))
+    {
+        // os memory doesn't depend on global malloc, buffers can outlive Memory::Shutdown
+        for (uint32 index = 0; index < BufferCount; ++index)
+        {
+            Buffer& buffer = Buffers[index];
+            buffer.Base = static_cast<uint8*>(PlatformMemory::Reserve(BufferSize));
+            if (buffer.Base == nullptr || !PlatformMemory::Commit(buffer.Base, BufferSize))
+            {
+                ENSURE(false);
+                buffer.Base = nullptr;
+            }
+        }
+    }
+
+    FrameAllocator::~FrameAllocator()
+    {
+        for (uint32 index = 0; index < BufferCount; ++index)
+        {
+            Buffer& buffer = Buffers[index];
+            ENSURE(buffer.Overflow == nullptr);
+            if (buffer.Base != nullptr)
+            {
+                PlatformMemory::Release(buffer.Base, BufferSize);
+                buffer.Base = nullptr;
+            }
+        }
+    }
+
+    FrameAllocator& FrameAllocator::Get()
+    {
+        static FrameAllocator allocator;
+        return allocator;
+    }
+
+    void* FrameAllocator::Alloc(size_t size, uint32 alignment)
+    {
+        Buffer& buffer = Buffers[CurrentIndex];
+        size_t offset = buffer.Offset.load(std::memory_order_relaxed);
+        while (true)
+        {
+            const size_t alignedOffset = Math::CeilToMultiple(reinterpret_cast<uintptr_t>(buffer.Base) + offset, static_cast<uintptr_t>(alignment)) - reinterpret_cast<uintptr_t>(buffer.Base);
+            const size_t newOffset = alignedOffset + size;
+            if (buffer.Base == nullptr || newOffset > BufferSize)
+            {
+                return AllocOverflow(buffer, size, alignment);
+            }
+
+            if (buffer.Offset.compare_exchange_weak(offset, newOffset, std::memory_order_relaxed))
+            {
+                return buffer.Base + alignedOffset;
+            }
+        }
+    }
+
+    void FrameAllocator::BeginFrame()
+    {
+        Buffer& finished = Buffers[CurrentIndex];
+        Stats.LastFrameOverflowBytes = finished.OverflowBytes;
+        Stats.LastFrameBytes = finished.Offset.load(std::memory_order_relaxed) + finished.OverflowBytes;
+        Stats.HighWaterMark = Math::Max(Stats.HighWaterMark, Stats.LastFrameBytes);
+        ++Stats.FrameCount;
+
+        CurrentIndex = (CurrentIndex + 1) % BufferCount;
+        RecycleBuffer(Buffers[CurrentIndex]);
+    }
+
+    void FrameAllocator::Reset()
+    {
+        for (uint32 index = 0; index < BufferCount; ++index)
+        {
+            RecycleBuffer(Buffers[index]);
+        }
+        CurrentIndex = 0;
+    }
+
+    const FrameAllocatorStats& FrameAllocator::GetStats() const
+    {
+        return Stats;
+    }
+
+    void* FrameAllocator::AllocOverflow(Buffer& buffer, size_t size, uint32 alignment)
+    {
+        // block link sits before the returned address, keep the address aligned
+        const size_t headerSize = Math::Max<size_t>(alignment, sizeof(OverflowBlock));
+        uint8* raw = static_cast<uint8*>(Memory::Malloc(headerSize + size, Math::Max<uint32>(alignment, alignof(OverflowBlock))));
+        if (raw == nullptr)
+        {
+            return nullptr;
+        }
+
+        OverflowBlock* block = reinterpret_cast<OverflowBlock*>(raw);
+        std::lock_guard lock(buffer.OverflowMutex);
+        block->Next = buffer.Overflow;
+        buffer.Overflow = block;
+        buffer.OverflowBytes += size;
+        return raw + headerSize;
+    }
+
+    void FrameAllocator::RecycleBuffer(Buffer& buffer)
+    {
+        while (buffer.Overflow != nullptr)
+        {
+            OverflowBlock* block = buffer.Overflow;
+            buffer.Overflow = block->Next;
+            Memory::Free(block);
+        }
+        buffer.OverflowBytes = 0;
+        buffer.Offset.store(0, std::memory_order_relaxed);
+    }
+}
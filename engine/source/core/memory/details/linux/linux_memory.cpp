@@ -0,0 +1,189 @@
+#include "global.hpp"
+
+#if PLATFORM_LINUX
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include "memory/details/linux/linux_memory.hpp"
+#include "memory/ansi_c_malloc.hpp"
+#include "memory/binned_malloc.hpp"
+#include "memory/simd_memory.hpp"
+#include "math/generic_math.hpp"
+
+namespace Engine
+{
+    namespace
+    {
+        /** same as the allocation granularity of windows, so binned blocks work on both platforms */
+        constexpr size_t kAllocationGranularity = 64 * 1024;
+        constexpr size_t kDefaultHugePageSize = 2 * 1024 * 1024;
+
+        /** map size bytes at an address aligned to alignment, over map then trim the head and tail */
+        void* MapAligned(size_t size, size_t alignment, int32 prot, int32 flags)
+        {
+            if (alignment <= LinuxMemory::GetPageSize())
+            {
+                void* ptr = ::mmap(nullptr, size, prot, flags, -1, 0);
+                return ptr != MAP_FAILED ? ptr : nullptr;
+            }
+
+            const size_t mapSize = size + alignment;
+            uint8* ptr = static_cast<uint8*>(::mmap(nullptr, mapSize, prot, flags, -1, 0));
+            if (ptr == MAP_FAILED)
+            {
+                return nullptr;
+            }
+
+            uint8* alignedPtr = reinterpret_cast<uint8*>(Math::CeilToMultiple(reinterpret_cast<uintptr_t>(ptr), static_cast<uintptr_t>(alignment)));
+            const size_t headSize = alignedPtr - ptr;
+            const size_t tailSize = mapSize - headSize - size;
+            if (headSize > 0)
+            {
+                ::munmap(ptr, headSize);
+            }
+            if (tailSize > 0)
+            {
+                ::munmap(alignedPtr + size, tailSize);
+            }
+            return alignedPtr;
+        }
+
+        size_t GetReserveSize(size_t size, EHugePage hugePage)
+        {
+            const size_t pageSize = hugePage == EHugePage::None ? LinuxMemory::GetPageSize() : LinuxMemory::GetHugePageSize();
+            return Math::CeilToMultiple(size, pageSize);
+        }
+    }
+
+    uint32 LinuxMemory::SDefaultAlignment = 16;
+
+    IMalloc* LinuxMemory::GetDefaultMalloc()
+    {
+#ifdef PL_BINNED_MALLOC
+        return new BinnedMalloc();
+#else
+        return new AnsiCMalloc();
+#endif
+    }
+
+    uint32 LinuxMemory::GetDefaultAlignment()
+    {
+        return SDefaultAlignment;
+    }
+
+    size_t LinuxMemory::GetBinnedAllocationGranularity()
+    {
+        return kAllocationGranularity;
+    }
+
+    size_t LinuxMemory::GetPageSize()
+    {
+        static size_t pageSize = 0;
+        if (pageSize == 0)
+        {
+            pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        }
+        return pageSize;
+    }
+
+    size_t LinuxMemory::GetHugePageSize()
+    {
+        static size_t hugePageSize = 0;
+        if (hugePageSize == 0)
+        {
+            hugePageSize = kDefaultHugePageSize;
+            if (FILE* file = std::fopen("/proc/meminfo", "r"))
+            {
+                char line[256];
+                unsigned long sizeInKB = 0;
+                while (std::fgets(line, sizeof(line), file) != nullptr)
+                {
+                    if (std::sscanf(line, "Hugepagesize: %lu kB", &sizeInKB) == 1)
+                    {
+                        hugePageSize = static_cast<size_t>(sizeInKB) * 1024;
+                        break;
+                    }
+                }
+                std::fclose(file);
+            }
+        }
+        return hugePageSize;
+    }
+
+    void* LinuxMemory::BinnedAllocFromOS(size_t size)
+    {
+        size = Math::CeilToMultiple(size, GetPageSize());
+        return MapAligned(size, kAllocationGranularity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS);
+    }
+
+    void LinuxMemory::BinnedFreeToOS(void* ptr, size_t size)
+    {
+        ::munmap(ptr, Math::CeilToMultiple(size, GetPageSize()));
+    }
+
+    void* LinuxMemory::Reserve(size_t size, EHugePage hugePage)
+    {
+        size = GetReserveSize(size, hugePage);
+        const int32 flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+
+        if (hugePage == EHugePage::Explicit)
+        {
+            // hugetlb mapping is always aligned to huge page
+            void* ptr = ::mmap(nullptr, size, PROT_NONE, flags | MAP_HUGETLB, -1, 0);
+            return ptr != MAP_FAILED ? ptr : nullptr;
+        }
+
+        if (hugePage == EHugePage::Transparent)
+        {
+            void* ptr = MapAligned(size, GetHugePageSize(), PROT_NONE, flags);
+            if (ptr != nullptr)
+            {
+                ::madvise(ptr, size, MADV_HUGEPAGE);
+            }
+            return ptr;
+        }
+
+        return MapAligned(size, kAllocationGranularity, PROT_NONE, flags);
+    }
+
+    void LinuxMemory::Release(void* ptr, size_t size, EHugePage hugePage)
+    {
+        ::munmap(ptr, GetReserveSize(size, hugePage));
+    }
+
+    bool LinuxMemory::Commit(void* ptr, size_t size)
+    {
+        ENSURE(reinterpret_cast<uintptr_t>(ptr) % GetPageSize() == 0);
+        return ::mprotect(ptr, size, PROT_READ | PROT_WRITE) == 0;
+    }
+
+    bool LinuxMemory::Decommit(void* ptr, size_t size)
+    {
+        ENSURE(reinterpret_cast<uintptr_t>(ptr) % GetPageSize() == 0);
+        // drop the pages first, the range reads zero after committed again
+        return ::madvise(ptr, size, MADV_DONTNEED) == 0 && ::mprotect(ptr, size, PROT_NONE) == 0;
+    }
+
+    void LinuxMemory::Memcpy(void* dest, void* src, size_t size)
+    {
+        SimdMemory::Memcpy(dest, src, size);
+    }
+
+    void LinuxMemory::Memmove(void* dest, void* src, size_t size)
+    {
+        ::memmove(dest, src, size);
+    }
+
+    void LinuxMemory::Memset(void* dest, uint8 byte, size_t size)
+    {
+        SimdMemory::Memset(dest, byte, size);
+    }
+
+    bool LinuxMemory::Memcmp(void* lBuffer, void* rBuffer, size_t size)
+    {
+        return SimdMemory::Memcmp(lBuffer, rBuffer, size);
+    }
+}
+#endif
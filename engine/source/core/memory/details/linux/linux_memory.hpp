@@ -0,0 +1,59 @@
+#pragma once
+
+#include "definitions_core.hpp"
+#include "global.hpp"
+#include "memory/malloc_interface.hpp"
+#include "memory/memory_type.hpp"
+
+namespace Engine
+{
+    class CORE_API LinuxMemory
+    {
+    public:
+        static IMalloc* GetDefaultMalloc();
+
+        static uint32 GetDefaultAlignment();
+
+        /** granularity of BinnedAllocFromOS and Reserve, address returned from them is always aligned to it */
+        static size_t GetBinnedAllocationGranularity();
+
+        /** page size of virtual memory */
+        static size_t GetPageSize();
+
+        /** size of a default huge page, read from /proc/meminfo */
+        static size_t GetHugePageSize();
+
+        /** allocate committed memory directly from os, the size will be rounded up to page size */
+        static void* BinnedAllocFromOS(size_t size);
+
+        /** return memory allocated by BinnedAllocFromOS to os */
+        static void BinnedFreeToOS(void* ptr, size_t size);
+
+        /**
+         * Reserve address space without physical memory, it must be committed before access.
+         * With huge page, size is rounded up to huge page size and the address is aligned to huge page.
+         */
+        static void* Reserve(size_t size, EHugePage hugePage = EHugePage::None);
+
+        /** release address space returned by Reserve, size and hugePage must be the same as Reserve */
+        static void Release(void* ptr, size_t size, EHugePage hugePage = EHugePage::None);
+
+        /** back a page aligned range of reserved memory with physical memory */
+        static bool Commit(void* ptr, size_t size);
+
+        /** return physical memory of a page aligned range to os, the address space is kept reserved */
+        static bool Decommit(void* ptr, size_t size);
+
+        static void Memcpy(void* dest, void* src, size_t size);
+
+        static void Memmove(void* dest, void* src, size_t size);
+
+        static void Memset(void* dest, uint8 byte, size_t size);
+
+        static bool Memcmp(void* lBuffer, void* rBuffer, size_t size);
+    private:
+        static uint32 SDefaultAlignment;
+    };
+
+    typedef LinuxMemory PlatformMemory;
+}
@@ -0,0 +1,146 @@
+//#include "precompiled_core.hpp"
+#include <cstdint>
+#include "memory/mem_stack.hpp"
+#include "memory/memory.hpp"
+#include "math/generic_math.hpp"
+
+namespace Engine
+{
+    namespace
+    {
+        constexpr size_t kChunkHeaderSize = 16;
+    }
+
+    MemStack::~MemStack()
+    {
+        ENSURE(MarkCount == 0);
+        PopChunks(nullptr);
+        Trim();
+    }
+
+    MemStack& MemStack::Get()
+    {
+        static thread_local MemStack stack;
+        return stack;
+    }
+
+    void* MemStack::Alloc(size_t size, uint32 alignment)
+    {
+        ENSURE(MarkCount > 0);
+
+        uint8* result = reinterpret_cast<uint8*>(Math::CeilToMultiple(reinterpret_cast<uintptr_t>(Top), static_cast<uintptr_t>(alignment)));
+        if (Top == nullptr || result + size > End)
+        {
+            PushChunk(size + alignment);
+            result = reinterpret_cast<uint8*>(Math::CeilToMultiple(reinterpret_cast<uintptr_t>(Top), static_cast<uintptr_t>(alignment)));
+        }
+
+        Top = result + size;
+        return result;
+    }
+
+    bool MemStack::TryGrow(void* ptr, size_t oldSize, size_t newSize)
+    {
+        uint8* bytes = static_cast<uint8*>(ptr);
+        if (bytes + oldSize != Top || bytes + newSize > End)
+        {
+            return false;
+        }
+
+        Top = bytes + newSize;
+        return true;
+    }
+
+    int32 MemStack::GetMarkCount() const
+    {
+        return MarkCount;
+    }
+
+    size_t MemStack::GetUsedBytes() const
+    {
+        return UsedBytes;
+    }
+
+    void MemStack::Trim()
+    {
+        while (FreeChunks != nullptr)
+        {
+            Chunk* chunk = FreeChunks;
+            FreeChunks = chunk->Next;
+            Memory::Free(chunk);
+        }
+    }
+
+    void MemStack::PushChunk(size_t minSize)
+    {
+        Chunk* chunk = nullptr;
+        if (minSize + kChunkHeaderSize <= kChunkSize && FreeChunks != nullptr)
+        {
+            chunk = FreeChunks;
+            FreeChunks = chunk->Next;
+        }
+        else
+        {
+            // oversize allocation gets a chunk of its own
+            const size_t chunkSize = Math::Max(kChunkSize, minSize + kChunkHeaderSize);
+            chunk = static_cast<Chunk*>(Memory::Malloc(chunkSize, kChunkHeaderSize));
+            chunk->Size = chunkSize;
+        }
+
+        chunk->Next = TopChunk;
+        TopChunk = chunk;
+        Top = reinterpret_cast<uint8*>(chunk) + kChunkHeaderSize;
+        End = reinterpret_cast<uint8*>(chunk) + chunk->Size;
+        UsedBytes += chunk->Size;
+    }
+
+    void MemStack::PopChunks(Chunk* chunk)
+    {
+        while (TopChunk != chunk)
+        {
+            Chunk* popped = TopChunk;
+            TopChunk = popped->Next;
+            UsedBytes -= popped->Size;
+
+            if (popped->Size == kChunkSize)
+            {
+                popped->Next = FreeChunks;
+                FreeChunks = popped;
+            }
+            else
+            {
+                Memory::Free(popped);
+            }
+        }
+    }
+
+    MemMark::MemMark(MemStack& stack)
+        : Stack(stack)
+        , Top(stack.Top)
+        , End(stack.End)
+        , TopChunk(stack.TopChunk)
+        , UsedBytes(stack.UsedBytes)
+        , MarkIndex(stack.MarkCount++)
+    {
+    }
+
+    MemMark::~MemMark()
+    {
+        if (MarkIndex != INDEX_NONE)
+        {
+            Pop();
+        }
+    }
+
+    void MemMark::Pop()
+    {
+        ENSURE(MarkIndex == Stack.MarkCount - 1);
+
+        Stack.PopChunks(TopChunk);
+        Stack.Top = Top;
+        Stack.End = End;
+        ENSURE(Stack.UsedBytes == UsedBytes);
+        --Stack.MarkCount;
+        MarkIndex = INDEX_NONE;
+    }
+}
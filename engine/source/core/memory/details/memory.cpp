@@ -2,12 +2,24 @@
 #include "core_minimal_private.hpp"
 #include "memory/memory.hpp"
 #include "memory/malloc_interface.hpp"
+#include "memory/memory_tracker.hpp"
 #include "math/limit.hpp"
 
 namespace Engine
 {
     IMalloc* GMalloc = nullptr;
 
+#ifdef PL_STATIC_MALLOC
+    StaticMalloc* Memory::SStaticMalloc = nullptr;
+
+    StaticMalloc* Memory::CreateStaticMalloc()
+    {
+        // GMalloc keeps pointing to it for code asking for the IMalloc interface
+        SStaticMalloc = new StaticMalloc();
+        GMalloc = SStaticMalloc;
+        return SStaticMalloc;
+    }
+#else
     void* Memory::Malloc(size_t size)
     {
         return Malloc(size, PlatformMemory::GetDefaultAlignment());
@@ -30,6 +42,25 @@ namespace Engine
         IMalloc* gMalloc = GetGMalloc();
         return gMalloc->Realloc(ptr, newSize, alignment);
     }
+#endif
+
+    size_t Memory::GetAllocationSize(void* ptr)
+    {
+        IMalloc* gMalloc = GetGMalloc();
+        return gMalloc->GetAllocationSize(ptr);
+    }
+
+    bool Memory::TryResizeInPlace(void* ptr, size_t newSize)
+    {
+        IMalloc* gMalloc = GetGMalloc();
+        return gMalloc->TryResizeInPlace(ptr, newSize);
+    }
+
+    size_t Memory::QuantizeSize(size_t size, uint32 alignment)
+    {
+        IMalloc* gMalloc = GetGMalloc();
+        return gMalloc->QuantizeSize(size, alignment);
+    }
 
     void Memory::Memcpy(void* dest, void* src, size_t size)
     {
@@ -287,11 +318,22 @@ namespace Engine
 
     void Memory::Shutdown()
     {
+#ifdef PL_OVERRIDE_NEW_DELETE
+        // static destructors still delete through global malloc after shutdown, keep it alive
+        if (GMalloc != nullptr)
+        {
+            GMalloc->ClearCurrentThreadTLS();
+        }
+#else
         if (GMalloc != nullptr)
         {
             delete GMalloc;
             GMalloc = nullptr;
         }
+#ifdef PL_STATIC_MALLOC
+        SStaticMalloc = nullptr;
+#endif
+#endif
     }
 
     void Memory::NormalizeOffset(uint32* data, int32& offset)
@@ -311,11 +353,20 @@ namespace Engine
 
     IMalloc* Memory::GetGMalloc()
     {
+#ifdef PL_STATIC_MALLOC
+        // never wrapped by TrackingMalloc, memory.hpp rejects PL_MEMORY_TRACKER with PL_STATIC_MALLOC
+        return GetStaticMalloc();
+#else
         if (GMalloc == nullptr)
         {
+#ifdef PL_MEMORY_TRACKER
+            GMalloc = new TrackingMalloc(PlatformMemory::GetDefaultMalloc());
+#else
             GMalloc = PlatformMemory::GetDefaultMalloc();
+#endif
         }
         ENSURE(GMalloc);
         return GMalloc;
+#endif
     }
 }
\ No newline at end of file
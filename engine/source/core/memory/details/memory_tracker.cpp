@@ -0,0 +1,418 @@
+//#include "precompiled_core.hpp"
+#include "memory/memory_tracker.hpp"
+#include "memory/memory.hpp"
+#include "math/generic_math.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+
+namespace Engine
+{
+    namespace
+    {
+        const ansi* const kTagNames[] =
+        {
+            "Untagged",
+            "Strings",
+            "Modules",
+            "Render",
+            "Log",
+        };
+        static_assert(sizeof(kTagNames) / sizeof(kTagNames[0]) == static_cast<size_t>(EMemoryTag::Count));
+
+        /** one cache line per tag, threads allocating with different tags don't share lines */
+        struct alignas(64) TagCounter
+        {
+            std::atomic<int64> CurrentBytes{ 0 };
+            std::atomic<int64> PeakBytes{ 0 };
+            std::atomic<int64> TotalAllocations{ 0 };
+            std::atomic<int64> TotalFrees{ 0 };
+        };
+
+        TagCounter GTagCounters[static_cast<size_t>(EMemoryTag::Count)];
+
+        void UpdatePeak(TagCounter& counter, int64 current)
+        {
+            int64 peak = counter.PeakBytes.load(std::memory_order_relaxed);
+            while (current > peak && !counter.PeakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        /** trivial type, thread local access needs no initialization guard */
+        struct TagStack
+        {
+            EMemoryTag Tags[MemoryTracker::kMaxTagDepth];
+            int32 Depth;
+        };
+
+        thread_local TagStack GTagStack;
+
+        /** flush pending counters of a thread after this many operations or bytes */
+        constexpr int32 kFlushOpCount = 32;
+        constexpr int64 kFlushBytes = 256 * 1024;
+
+        void RegisterThreadExitFlush();
+
+        /**
+         * Counters of current thread not yet added to global ones, saves atomics on every allocation.
+         * Trivially destructible, frees during static destruction still land here after thread locals with
+         * destructors are gone, they are flushed right away then.
+         */
+        struct PendingCounters
+        {
+            int64 Bytes[static_cast<size_t>(EMemoryTag::Count)];
+            int64 Allocations[static_cast<size_t>(EMemoryTag::Count)];
+            int64 Frees[static_cast<size_t>(EMemoryTag::Count)];
+            int32 OpCount;
+            bool ExitFlushRegistered;
+            bool ThreadExited;
+
+            void Flush()
+            {
+                for (size_t index = 0; index < static_cast<size_t>(EMemoryTag::Count); ++index)
+                {
+                    if (Allocations[index] == 0 && Frees[index] == 0 && Bytes[index] == 0)
+                    {
+                        continue;
+                    }
+
+                    TagCounter& counter = GTagCounters[index];
+                    const int64 current = counter.CurrentBytes.fetch_add(Bytes[index], std::memory_order_relaxed) + Bytes[index];
+                    counter.TotalAllocations.fetch_add(Allocations[index], std::memory_order_relaxed);
+                    counter.TotalFrees.fetch_add(Frees[index], std::memory_order_relaxed);
+                    UpdatePeak(counter, current);
+                    Bytes[index] = 0;
+                    Allocations[index] = 0;
+                    Frees[index] = 0;
+                }
+                OpCount = 0;
+            }
+
+            void Add(EMemoryTag tag, int64 bytes, int64 allocations, int64 frees)
+            {
+                const size_t index = static_cast<size_t>(tag);
+                Bytes[index] += bytes;
+                Allocations[index] += allocations;
+                Frees[index] += frees;
+                if (UNLIKELY(!ExitFlushRegistered))
+                {
+                    ExitFlushRegistered = true;
+                    RegisterThreadExitFlush();
+                }
+                if (++OpCount >= kFlushOpCount || bytes >= kFlushBytes || bytes <= -kFlushBytes || ThreadExited)
+                {
+                    Flush();
+                }
+            }
+        };
+
+        thread_local PendingCounters GPendingCounters;
+
+        /** the only thread local of the tracker with a destructor, hands the rest of the counts over on thread exit */
+        struct ThreadExitFlush
+        {
+            bool Active{ false };
+
+            ~ThreadExitFlush()
+            {
+                GPendingCounters.Flush();
+                GPendingCounters.ThreadExited = true;
+            }
+        };
+
+        thread_local ThreadExitFlush GThreadExitFlush;
+
+        void RegisterThreadExitFlush()
+        {
+            // first use constructs the guard and registers its destructor
+            GThreadExitFlush.Active = true;
+        }
+
+        /** csv dump state, only touched by the thread calling Tick and SetCsvDump */
+        struct CsvDumpSetting
+        {
+            ansi Path[260]{ 0 };
+            double IntervalSeconds{ 0.0 };
+            std::chrono::steady_clock::time_point LastDump;
+            /** a failed dump is reported once, not every interval */
+            bool ReportedFailure{ false };
+        };
+
+        CsvDumpSetting GCsvDump;
+
+        const std::chrono::steady_clock::time_point GStartTime = std::chrono::steady_clock::now();
+    }
+
+    void MemoryTracker::PushTag(EMemoryTag tag)
+    {
+        TagStack& stack = GTagStack;
+        ENSURE(stack.Depth < kMaxTagDepth);
+        stack.Tags[stack.Depth++] = tag;
+    }
+
+    void MemoryTracker::PopTag()
+    {
+        TagStack& stack = GTagStack;
+        ENSURE(stack.Depth > 0);
+        --stack.Depth;
+    }
+
+    EMemoryTag MemoryTracker::GetCurrentTag()
+    {
+        const TagStack& stack = GTagStack;
+        return stack.Depth > 0 ? stack.Tags[stack.Depth - 1] : EMemoryTag::Untagged;
+    }
+
+    MemoryTagStats MemoryTracker::GetTagStats(EMemoryTag tag)
+    {
+        const TagCounter& counter = GTagCounters[static_cast<size_t>(tag)];
+        MemoryTagStats stats;
+        stats.CurrentBytes = counter.CurrentBytes.load(std::memory_order_relaxed);
+        stats.PeakBytes = counter.PeakBytes.load(std::memory_order_relaxed);
+        stats.TotalAllocations = counter.TotalAllocations.load(std::memory_order_relaxed);
+        stats.LiveAllocations = stats.TotalAllocations - counter.TotalFrees.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    const ansi* MemoryTracker::GetTagName(EMemoryTag tag)
+    {
+        return tag < EMemoryTag::Count ? kTagNames[static_cast<size_t>(tag)] : "Invalid";
+    }
+
+    void MemoryTracker::OnAlloc(EMemoryTag tag, size_t size)
+    {
+        GPendingCounters.Add(tag, static_cast<int64>(size), 1, 0);
+    }
+
+    void MemoryTracker::OnFree(EMemoryTag tag, size_t size)
+    {
+        GPendingCounters.Add(tag, -static_cast<int64>(size), 0, 1);
+    }
+
+    void MemoryTracker::OnResize(EMemoryTag tag, size_t oldSize, size_t newSize)
+    {
+        GPendingCounters.Add(tag, static_cast<int64>(newSize) - static_cast<int64>(oldSize), 0, 0);
+    }
+
+    void MemoryTracker::FlushThreadCounters()
+    {
+        GPendingCounters.Flush();
+    }
+
+    bool MemoryTracker::DumpCsv(const ansi* path)
+    {
+        FlushThreadCounters();
+
+        // crt file io, writing the dump must not allocate from the tracked malloc
+        FILE* file = std::fopen(path, "a");
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        std::fseek(file, 0, SEEK_END);
+        if (std::ftell(file) == 0)
+        {
+            std::fprintf(file, "Time,Tag,CurrentBytes,PeakBytes,LiveAllocations,TotalAllocations\n");
+        }
+
+        const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - GStartTime).count();
+        for (uint8 index = 0; index < static_cast<uint8>(EMemoryTag::Count); ++index)
+        {
+            const EMemoryTag tag = static_cast<EMemoryTag>(index);
+            const MemoryTagStats stats = GetTagStats(tag);
+            std::fprintf(file, "%.3f,%s,%lld,%lld,%lld,%lld\n", time, GetTagName(tag),
+                (long long)stats.CurrentBytes, (long long)stats.PeakBytes, (long long)stats.LiveAllocations, (long long)stats.TotalAllocations);
+        }
+
+        std::fclose(file);
+        return true;
+    }
+
+    void MemoryTracker::SetCsvDump(const ansi* path, double intervalSeconds)
+    {
+        std::snprintf(GCsvDump.Path, sizeof(GCsvDump.Path), "%s", path != nullptr ? path : "");
+        GCsvDump.IntervalSeconds = intervalSeconds;
+        GCsvDump.LastDump = std::chrono::steady_clock::now();
+        GCsvDump.ReportedFailure = false;
+
+        // fopen does not create directories, a missing logs directory would fail every dump
+        const std::filesystem::path directory = std::filesystem::path(GCsvDump.Path).parent_path();
+        if (!directory.empty())
+        {
+            std::error_code error;
+            std::filesystem::create_directories(directory, error);
+        }
+    }
+
+    void MemoryTracker::Tick()
+    {
+        if (GCsvDump.Path[0] == 0)
+        {
+            return;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(now - GCsvDump.LastDump).count() >= GCsvDump.IntervalSeconds)
+        {
+            GCsvDump.LastDump = now;
+            if (!DumpCsv(GCsvDump.Path) && !GCsvDump.ReportedFailure)
+            {
+                GCsvDump.ReportedFailure = true;
+                std::fprintf(stderr, "MemoryTracker: can not open csv dump file %s\n", GCsvDump.Path);
+            }
+        }
+    }
+
+    struct TrackingMalloc::AllocationHeader
+    {
+        /** requested size */
+        size_t Size;
+        /** distance from block of inner malloc to the returned address */
+        uint32 Offset;
+        EMemoryTag Tag;
+    };
+
+    namespace
+    {
+        constexpr uint32 kTrackingHeaderSize = 16;
+
+        uint32 GetTrackingOffset(uint32 alignment)
+        {
+            return Math::Max(alignment, kTrackingHeaderSize);
+        }
+    }
+
+    TrackingMalloc::TrackingMalloc(IMalloc* inner)
+        : Inner(inner)
+    {
+        static_assert(sizeof(AllocationHeader) <= kTrackingHeaderSize);
+    }
+
+    TrackingMalloc::~TrackingMalloc()
+    {
+        delete Inner;
+    }
+
+    void* TrackingMalloc::Malloc(size_t size, uint32 alignment)
+    {
+        const uint32 offset = GetTrackingOffset(alignment);
+        uint8* raw = static_cast<uint8*>(Inner->Malloc(size + offset, offset));
+        if (raw == nullptr)
+        {
+            return nullptr;
+        }
+
+        void* result = raw + offset;
+        AllocationHeader* header = GetHeader(result);
+        header->Size = size;
+        header->Offset = offset;
+        header->Tag = MemoryTracker::GetCurrentTag();
+        MemoryTracker::OnAlloc(header->Tag, size);
+        return result;
+    }
+
+    void TrackingMalloc::Free(void* ptr)
+    {
+        if (ptr == nullptr)
+        {
+            return;
+        }
+
+        AllocationHeader* header = GetHeader(ptr);
+        MemoryTracker::OnFree(header->Tag, header->Size);
+        Inner->Free(static_cast<uint8*>(ptr) - header->Offset);
+    }
+
+    void* TrackingMalloc::Realloc(void* ptr, size_t size, uint32 alignment)
+    {
+        if (ptr == nullptr)
+        {
+            return Malloc(size, alignment);
+        }
+
+        if (size == 0)
+        {
+            Free(ptr);
+            return nullptr;
+        }
+
+        AllocationHeader* header = GetHeader(ptr);
+        const uint32 offset = header->Offset;
+        if (offset != GetTrackingOffset(alignment))
+        {
+            // header has to move, fallback to a new block with the same tag
+            MemoryTagScope scope(header->Tag);
+            void* result = Malloc(size, alignment);
+            if (result != nullptr)
+            {
+                Memory::Memcpy(result, ptr, Math::Min(size, header->Size));
+                Free(ptr);
+            }
+            return result;
+        }
+
+        // the block keeps the tag it was allocated with
+        const EMemoryTag tag = header->Tag;
+        const size_t oldSize = header->Size;
+        uint8* raw = static_cast<uint8*>(Inner->Realloc(static_cast<uint8*>(ptr) - offset, size + offset, offset));
+        if (raw == nullptr)
+        {
+            return nullptr;
+        }
+
+        MemoryTracker::OnResize(tag, oldSize, size);
+        void* result = raw + offset;
+        GetHeader(result)->Size = size;
+        return result;
+    }
+
+    size_t TrackingMalloc::GetAllocationSize(void* ptr)
+    {
+        AllocationHeader* header = GetHeader(ptr);
+        const size_t rawSize = Inner->GetAllocationSize(static_cast<uint8*>(ptr) - header->Offset);
+        return rawSize > header->Offset ? rawSize - header->Offset : 0;
+    }
+
+    bool TrackingMalloc::TryResizeInPlace(void* ptr, size_t size)
+    {
+        if (ptr == nullptr)
+        {
+            return false;
+        }
+
+        AllocationHeader* header = GetHeader(ptr);
+        if (!Inner->TryResizeInPlace(static_cast<uint8*>(ptr) - header->Offset, size + header->Offset))
+        {
+            return false;
+        }
+
+        MemoryTracker::OnResize(header->Tag, header->Size, size);
+        header->Size = size;
+        return true;
+    }
+
+    size_t TrackingMalloc::QuantizeSize(size_t size, uint32 alignment)
+    {
+        const uint32 offset = GetTrackingOffset(alignment);
+        return Inner->QuantizeSize(size + offset, offset) - offset;
+    }
+
+    void TrackingMalloc::SetupCurrentThreadTLS()
+    {
+        Inner->SetupCurrentThreadTLS();
+    }
+
+    void TrackingMalloc::ClearCurrentThreadTLS()
+    {
+        MemoryTracker::FlushThreadCounters();
+        Inner->ClearCurrentThreadTLS();
+    }
+
+    TrackingMalloc::AllocationHeader* TrackingMalloc::GetHeader(void* ptr)
+    {
+        return reinterpret_cast<AllocationHeader*>(static_cast<uint8*>(ptr) - kTrackingHeaderSize);
+    }
+}
@@ -0,0 +1,396 @@
+//#include "precompiled_core.hpp"
+#include "memory/simd_memory.hpp"
+#include <atomic>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define SIMD_MEMORY_X64 1
+    #include <immintrin.h>
+    #if defined(COMPILER_MSVC)
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#else
+    #define SIMD_MEMORY_X64 0
+#endif
+
+namespace Engine
+{
+    namespace
+    {
+        typedef void (*MemcpyFunc)(void*, const void*, size_t);
+        typedef void (*MemsetFunc)(void*, uint8, size_t);
+        typedef bool (*MemcmpFunc)(const void*, const void*, size_t);
+
+        struct KernelTable
+        {
+            MemcpyFunc Memcpy;
+            MemsetFunc Memset;
+            MemcmpFunc Memcmp;
+            ESimdLevel Level;
+        };
+
+        namespace Crt
+        {
+            void Memcpy(void* dest, const void* src, size_t size)
+            {
+                ::memcpy(dest, src, size);
+            }
+
+            void Memset(void* dest, uint8 byte, size_t size)
+            {
+                ::memset(dest, byte, size);
+            }
+
+            bool Memcmp(const void* lBuffer, const void* rBuffer, size_t size)
+            {
+                return ::memcmp(lBuffer, rBuffer, size) == 0;
+            }
+        }
+
+#if SIMD_MEMORY_X64
+        /** blocks shorter than 16 bytes, copied with two overlapping scalar moves */
+        FORCEINLINE void CopySmall(uint8* dest, const uint8* src, size_t size)
+        {
+            if (size >= 8)
+            {
+                uint64 first, last;
+                ::memcpy(&first, src, 8);
+                ::memcpy(&last, src + size - 8, 8);
+                ::memcpy(dest, &first, 8);
+                ::memcpy(dest + size - 8, &last, 8);
+            }
+            else if (size >= 4)
+            {
+                uint32 first, last;
+                ::memcpy(&first, src, 4);
+                ::memcpy(&last, src + size - 4, 4);
+                ::memcpy(dest, &first, 4);
+                ::memcpy(dest + size - 4, &last, 4);
+            }
+            else if (size > 0)
+            {
+                const uint8 first = src[0];
+                const uint8 middle = src[size / 2];
+                const uint8 last = src[size - 1];
+                dest[0] = first;
+                dest[size / 2] = middle;
+                dest[size - 1] = last;
+            }
+        }
+
+        FORCEINLINE void SetSmall(uint8* dest, uint8 byte, size_t size)
+        {
+            const uint64 value = 0x0101010101010101ull * byte;
+            if (size >= 8)
+            {
+                ::memcpy(dest, &value, 8);
+                ::memcpy(dest + size - 8, &value, 8);
+            }
+            else if (size >= 4)
+            {
+                ::memcpy(dest, &value, 4);
+                ::memcpy(dest + size - 4, &value, 4);
+            }
+            else if (size > 0)
+            {
+                dest[0] = byte;
+                dest[size / 2] = byte;
+                dest[size - 1] = byte;
+            }
+        }
+
+        FORCEINLINE bool CompareSmall(const uint8* l, const uint8* r, size_t size)
+        {
+            if (size >= 8)
+            {
+                uint64 l0, l1, r0, r1;
+                ::memcpy(&l0, l, 8);
+                ::memcpy(&l1, l + size - 8, 8);
+                ::memcpy(&r0, r, 8);
+                ::memcpy(&r1, r + size - 8, 8);
+                return ((l0 ^ r0) | (l1 ^ r1)) == 0;
+            }
+
+            if (size >= 4)
+            {
+                uint32 l0, l1, r0, r1;
+                ::memcpy(&l0, l, 4);
+                ::memcpy(&l1, l + size - 4, 4);
+                ::memcpy(&r0, r, 4);
+                ::memcpy(&r1, r + size - 4, 4);
+                return ((l0 ^ r0) | (l1 ^ r1)) == 0;
+            }
+
+            for (size_t index = 0; index < size; ++index)
+            {
+                if (l[index] != r[index])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        namespace Sse2Kernels
+        {
+            typedef __m128i VectorType;
+            constexpr size_t kVectorSize = 16;
+
+            FORCEINLINE VectorType Load(const uint8* ptr) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)); }
+            FORCEINLINE void Store(uint8* ptr, VectorType value) { _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), value); }
+            FORCEINLINE void StoreAligned(uint8* ptr, VectorType value) { _mm_store_si128(reinterpret_cast<__m128i*>(ptr), value); }
+            FORCEINLINE VectorType Broadcast(uint8 byte) { return _mm_set1_epi8(static_cast<char>(byte)); }
+            FORCEINLINE VectorType Xor(VectorType a, VectorType b) { return _mm_xor_si128(a, b); }
+            FORCEINLINE VectorType Or(VectorType a, VectorType b) { return _mm_or_si128(a, b); }
+            FORCEINLINE bool IsZero(VectorType value) { return _mm_movemask_epi8(_mm_cmpeq_epi8(value, _mm_setzero_si128())) == 0xFFFF; }
+
+            FORCEINLINE void CopyBelowVector(uint8* dest, const uint8* src, size_t size) { CopySmall(dest, src, size); }
+            FORCEINLINE void SetBelowVector(uint8* dest, uint8 byte, size_t size) { SetSmall(dest, byte, size); }
+            FORCEINLINE bool CompareBelowVector(const uint8* l, const uint8* r, size_t size) { return CompareSmall(l, r, size); }
+
+            #include "memory/details/simd_memory_kernels.inl"
+        }
+
+#if !defined(COMPILER_MSVC)
+    #pragma GCC push_options
+    #pragma GCC target("avx2")
+#endif
+        namespace Avx2Kernels
+        {
+            typedef __m256i VectorType;
+            constexpr size_t kVectorSize = 32;
+
+            FORCEINLINE VectorType Load(const uint8* ptr) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr)); }
+            FORCEINLINE void Store(uint8* ptr, VectorType value) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), value); }
+            FORCEINLINE void StoreAligned(uint8* ptr, VectorType value) { _mm256_store_si256(reinterpret_cast<__m256i*>(ptr), value); }
+            FORCEINLINE VectorType Broadcast(uint8 byte) { return _mm256_set1_epi8(static_cast<char>(byte)); }
+            FORCEINLINE VectorType Xor(VectorType a, VectorType b) { return _mm256_xor_si256(a, b); }
+            FORCEINLINE VectorType Or(VectorType a, VectorType b) { return _mm256_or_si256(a, b); }
+            FORCEINLINE bool IsZero(VectorType value) { return _mm256_testz_si256(value, value) != 0; }
+
+            FORCEINLINE void CopyBelowVector(uint8* dest, const uint8* src, size_t size)
+            {
+                if (size >= 16)
+                {
+                    const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+                    const __m128i last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + size - 16));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), first);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + size - 16), last);
+                    return;
+                }
+                CopySmall(dest, src, size);
+            }
+
+            FORCEINLINE void SetBelowVector(uint8* dest, uint8 byte, size_t size)
+            {
+                if (size >= 16)
+                {
+                    const __m128i value = _mm_set1_epi8(static_cast<char>(byte));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), value);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + size - 16), value);
+                    return;
+                }
+                SetSmall(dest, byte, size);
+            }
+
+            FORCEINLINE bool CompareBelowVector(const uint8* l, const uint8* r, size_t size)
+            {
+                if (size >= 16)
+                {
+                    const __m128i diff = _mm_or_si128(
+                        _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(l)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(r))),
+                        _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(l + size - 16)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(r + size - 16))));
+                    return _mm_testz_si128(diff, diff) != 0;
+                }
+                return CompareSmall(l, r, size);
+            }
+
+            #include "memory/details/simd_memory_kernels.inl"
+        }
+#if !defined(COMPILER_MSVC)
+    #pragma GCC pop_options
+    #pragma GCC push_options
+    #pragma GCC target("avx2,avx512f,avx512bw")
+#endif
+        namespace Avx512Kernels
+        {
+            typedef __m512i VectorType;
+            constexpr size_t kVectorSize = 64;
+
+            FORCEINLINE VectorType Load(const uint8* ptr) { return _mm512_loadu_si512(ptr); }
+            FORCEINLINE void Store(uint8* ptr, VectorType value) { _mm512_storeu_si512(ptr, value); }
+            FORCEINLINE void StoreAligned(uint8* ptr, VectorType value) { _mm512_store_si512(ptr, value); }
+            FORCEINLINE VectorType Broadcast(uint8 byte) { return _mm512_set1_epi8(static_cast<char>(byte)); }
+            FORCEINLINE VectorType Xor(VectorType a, VectorType b) { return _mm512_xor_si512(a, b); }
+            FORCEINLINE VectorType Or(VectorType a, VectorType b) { return _mm512_or_si512(a, b); }
+            FORCEINLINE bool IsZero(VectorType value) { return _mm512_test_epi64_mask(value, value) == 0; }
+
+            /** masked access never touches bytes past size, one instruction for any tail */
+            FORCEINLINE __mmask64 GetTailMask(size_t size)
+            {
+                return size >= 64 ? ~__mmask64(0) : (__mmask64(1) << size) - 1;
+            }
+
+            FORCEINLINE void CopyBelowVector(uint8* dest, const uint8* src, size_t size)
+            {
+                const __mmask64 mask = GetTailMask(size);
+                _mm512_mask_storeu_epi8(dest, mask, _mm512_maskz_loadu_epi8(mask, src));
+            }
+
+            FORCEINLINE void SetBelowVector(uint8* dest, uint8 byte, size_t size)
+            {
+                _mm512_mask_storeu_epi8(dest, GetTailMask(size), Broadcast(byte));
+            }
+
+            FORCEINLINE bool CompareBelowVector(const uint8* l, const uint8* r, size_t size)
+            {
+                const __mmask64 mask = GetTailMask(size);
+                return _mm512_mask_cmpneq_epi8_mask(mask, _mm512_maskz_loadu_epi8(mask, l), _mm512_maskz_loadu_epi8(mask, r)) == 0;
+            }
+
+            #include "memory/details/simd_memory_kernels.inl"
+        }
+#if !defined(COMPILER_MSVC)
+    #pragma GCC pop_options
+#endif
+
+        ESimdLevel DetectLevel()
+        {
+            uint32 regs[4];
+            auto cpuid = [&regs](uint32 leaf, uint32 subLeaf)
+            {
+#if defined(COMPILER_MSVC)
+                __cpuidex(reinterpret_cast<int*>(regs), static_cast<int>(leaf), static_cast<int>(subLeaf));
+#else
+                __cpuid_count(leaf, subLeaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+            };
+
+            cpuid(0, 0);
+            const uint32 maxLeaf = regs[0];
+            cpuid(1, 0);
+            const bool osxsave = (regs[2] & (1u << 27)) != 0;
+            const bool avx = (regs[2] & (1u << 28)) != 0;
+            if (!osxsave || !avx || maxLeaf < 7)
+            {
+                return ESimdLevel::Sse2;
+            }
+
+            // os must save ymm and zmm registers on context switch
+#if defined(COMPILER_MSVC)
+            const uint64 xcr0 = _xgetbv(0);
+#else
+            uint32 xcr0Low, xcr0High;
+            __asm__ volatile("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+            const uint64 xcr0 = (static_cast<uint64>(xcr0High) << 32) | xcr0Low;
+#endif
+            if ((xcr0 & 0x6) != 0x6)
+            {
+                return ESimdLevel::Sse2;
+            }
+
+            cpuid(7, 0);
+            const bool avx2 = (regs[1] & (1u << 5)) != 0;
+            const bool avx512 = (regs[1] & (1u << 16)) != 0 && (regs[1] & (1u << 30)) != 0;
+            if (avx2 && avx512 && (xcr0 & 0xE6) == 0xE6)
+            {
+                return ESimdLevel::Avx512;
+            }
+            return avx2 ? ESimdLevel::Avx2 : ESimdLevel::Sse2;
+        }
+#else
+        ESimdLevel DetectLevel()
+        {
+            return ESimdLevel::None;
+        }
+#endif
+
+        const KernelTable kKernelTables[] =
+        {
+            { Crt::Memcpy, Crt::Memset, Crt::Memcmp, ESimdLevel::None },
+#if SIMD_MEMORY_X64
+            { Sse2Kernels::Memcpy, Sse2Kernels::Memset, Sse2Kernels::Memcmp, ESimdLevel::Sse2 },
+            { Avx2Kernels::Memcpy, Avx2Kernels::Memset, Avx2Kernels::Memcmp, ESimdLevel::Avx2 },
+            { Avx512Kernels::Memcpy, Avx512Kernels::Memset, Avx512Kernels::Memcmp, ESimdLevel::Avx512 },
+#endif
+        };
+
+        const KernelTable& GetSupportedKernels()
+        {
+            static const ESimdLevel supportedLevel = DetectLevel();
+            return kKernelTables[static_cast<size_t>(supportedLevel)];
+        }
+
+        /** first call through the table detects cpu and replaces it, no branch on later calls */
+        namespace Resolver
+        {
+            void Memcpy(void* dest, const void* src, size_t size);
+            void Memset(void* dest, uint8 byte, size_t size);
+            bool Memcmp(const void* lBuffer, const void* rBuffer, size_t size);
+        }
+
+        const KernelTable kResolverTable = { Resolver::Memcpy, Resolver::Memset, Resolver::Memcmp, ESimdLevel::None };
+
+        std::atomic<const KernelTable*> GKernels{ &kResolverTable };
+
+        const KernelTable& ResolveKernels()
+        {
+            const KernelTable* kernels = &GetSupportedKernels();
+            GKernels.store(kernels, std::memory_order_relaxed);
+            return *kernels;
+        }
+
+        namespace Resolver
+        {
+            void Memcpy(void* dest, const void* src, size_t size)
+            {
+                ResolveKernels().Memcpy(dest, src, size);
+            }
+
+            void Memset(void* dest, uint8 byte, size_t size)
+            {
+                ResolveKernels().Memset(dest, byte, size);
+            }
+
+            bool Memcmp(const void* lBuffer, const void* rBuffer, size_t size)
+            {
+                return ResolveKernels().Memcmp(lBuffer, rBuffer, size);
+            }
+        }
+    }
+
+    void SimdMemory::Memcpy(void* dest, const void* src, size_t size)
+    {
+        GKernels.load(std::memory_order_relaxed)->Memcpy(dest, src, size);
+    }
+
+    void SimdMemory::Memset(void* dest, uint8 byte, size_t size)
+    {
+        GKernels.load(std::memory_order_relaxed)->Memset(dest, byte, size);
+    }
+
+    bool SimdMemory::Memcmp(const void* lBuffer, const void* rBuffer, size_t size)
+    {
+        return GKernels.load(std::memory_order_relaxed)->Memcmp(lBuffer, rBuffer, size);
+    }
+
+    ESimdLevel SimdMemory::GetSupportedLevel()
+    {
+        return GetSupportedKernels().Level;
+    }
+
+    ESimdLevel SimdMemory::GetLevel()
+    {
+        const KernelTable* kernels = GKernels.load(std::memory_order_relaxed);
+        return kernels == &kResolverTable ? GetSupportedLevel() : kernels->Level;
+    }
+
+    void SimdMemory::SetLevel(ESimdLevel level)
+    {
+        const ESimdLevel supportedLevel = GetSupportedLevel();
+        const ESimdLevel clamped = level < supportedLevel ? level : supportedLevel;
+        GKernels.store(&kKernelTables[static_cast<size_t>(clamped)], std::memory_order_relaxed);
+    }
+}
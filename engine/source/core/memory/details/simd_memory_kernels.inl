@@ -0,0 +1,158 @@
+// Kernels shared by every simd level, included inside a namespace that defines
+// VectorType, kVectorSize, Load, Store, StoreAligned, Broadcast, Xor, Or, IsZero,
+// CopyBelowVector, SetBelowVector and CompareBelowVector.
+
+static void Memcpy(void* dest, const void* src, size_t size)
+{
+    uint8* d = static_cast<uint8*>(dest);
+    const uint8* s = static_cast<const uint8*>(src);
+    if (size < kVectorSize)
+    {
+        CopyBelowVector(d, s, size);
+        return;
+    }
+
+    if (size <= 2 * kVectorSize)
+    {
+        const VectorType first = Load(s);
+        const VectorType last = Load(s + size - kVectorSize);
+        Store(d, first);
+        Store(d + size - kVectorSize, last);
+        return;
+    }
+
+    if (size <= 4 * kVectorSize)
+    {
+        const VectorType v0 = Load(s);
+        const VectorType v1 = Load(s + kVectorSize);
+        const VectorType v2 = Load(s + size - 2 * kVectorSize);
+        const VectorType v3 = Load(s + size - kVectorSize);
+        Store(d, v0);
+        Store(d + kVectorSize, v1);
+        Store(d + size - 2 * kVectorSize, v2);
+        Store(d + size - kVectorSize, v3);
+        return;
+    }
+
+    if (size > SimdMemory::kLargeSize)
+    {
+        ::memcpy(dest, src, size);
+        return;
+    }
+
+    // unaligned head and tail overlap the aligned body, they are loaded before any store
+    uint8* const end = d + size;
+    const VectorType head = Load(s);
+    const VectorType tail0 = Load(s + size - 4 * kVectorSize);
+    const VectorType tail1 = Load(s + size - 3 * kVectorSize);
+    const VectorType tail2 = Load(s + size - 2 * kVectorSize);
+    const VectorType tail3 = Load(s + size - kVectorSize);
+
+    const size_t skew = kVectorSize - (reinterpret_cast<uintptr_t>(d) & (kVectorSize - 1));
+    Store(d, head);
+    d += skew;
+    s += skew;
+    size -= skew;
+
+    while (size > 4 * kVectorSize)
+    {
+        const VectorType v0 = Load(s);
+        const VectorType v1 = Load(s + kVectorSize);
+        const VectorType v2 = Load(s + 2 * kVectorSize);
+        const VectorType v3 = Load(s + 3 * kVectorSize);
+        StoreAligned(d, v0);
+        StoreAligned(d + kVectorSize, v1);
+        StoreAligned(d + 2 * kVectorSize, v2);
+        StoreAligned(d + 3 * kVectorSize, v3);
+        d += 4 * kVectorSize;
+        s += 4 * kVectorSize;
+        size -= 4 * kVectorSize;
+    }
+
+    Store(end - 4 * kVectorSize, tail0);
+    Store(end - 3 * kVectorSize, tail1);
+    Store(end - 2 * kVectorSize, tail2);
+    Store(end - kVectorSize, tail3);
+}
+
+static void Memset(void* dest, uint8 byte, size_t size)
+{
+    uint8* d = static_cast<uint8*>(dest);
+    if (size < kVectorSize)
+    {
+        SetBelowVector(d, byte, size);
+        return;
+    }
+
+    const VectorType value = Broadcast(byte);
+    if (size <= 2 * kVectorSize)
+    {
+        Store(d, value);
+        Store(d + size - kVectorSize, value);
+        return;
+    }
+
+    if (size <= 4 * kVectorSize)
+    {
+        Store(d, value);
+        Store(d + kVectorSize, value);
+        Store(d + size - 2 * kVectorSize, value);
+        Store(d + size - kVectorSize, value);
+        return;
+    }
+
+    if (size > SimdMemory::kLargeSize)
+    {
+        ::memset(dest, byte, size);
+        return;
+    }
+
+    uint8* const end = d + size;
+    Store(d, value);
+    uint8* aligned = reinterpret_cast<uint8*>((reinterpret_cast<uintptr_t>(d) + kVectorSize) & ~static_cast<uintptr_t>(kVectorSize - 1));
+    while (aligned + 4 * kVectorSize < end)
+    {
+        StoreAligned(aligned, value);
+        StoreAligned(aligned + kVectorSize, value);
+        StoreAligned(aligned + 2 * kVectorSize, value);
+        StoreAligned(aligned + 3 * kVectorSize, value);
+        aligned += 4 * kVectorSize;
+    }
+
+    Store(end - 4 * kVectorSize, value);
+    Store(end - 3 * kVectorSize, value);
+    Store(end - 2 * kVectorSize, value);
+    Store(end - kVectorSize, value);
+}
+
+static bool Memcmp(const void* lBuffer, const void* rBuffer, size_t size)
+{
+    const uint8* l = static_cast<const uint8*>(lBuffer);
+    const uint8* r = static_cast<const uint8*>(rBuffer);
+    if (size < kVectorSize)
+    {
+        return CompareBelowVector(l, r, size);
+    }
+
+    size_t offset = 0;
+    for (; offset + 4 * kVectorSize <= size; offset += 4 * kVectorSize)
+    {
+        const VectorType diff0 = Or(Xor(Load(l + offset), Load(r + offset)), Xor(Load(l + offset + kVectorSize), Load(r + offset + kVectorSize)));
+        const VectorType diff1 = Or(Xor(Load(l + offset + 2 * kVectorSize), Load(r + offset + 2 * kVectorSize)), Xor(Load(l + offset + 3 * kVectorSize), Load(r + offset + 3 * kVectorSize)));
+        if (!IsZero(Or(diff0, diff1)))
+        {
+            return false;
+        }
+    }
+
+    for (; offset + kVectorSize <= size; offset += kVectorSize)
+    {
+        if (!IsZero(Xor(Load(l + offset), Load(r + offset))))
+        {
+            return false;
+        }
+    }
+
+    // last vector overlaps bytes already compared
+    return offset == size || IsZero(Xor(Load(l + size - kVectorSize), Load(r + size - kVectorSize)));
+}
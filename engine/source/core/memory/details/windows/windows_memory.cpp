@@ -1,6 +1,12 @@
 #include "precompiled_core.hpp"
+#include "global.hpp"
+
+#if PLATFORM_WINDOWS
 #include "memory/details/windows/windows_memory.hpp"
 #include "memory/ansi_c_malloc.hpp"
+#include "memory/binned_malloc.hpp"
+#include "memory/simd_memory.hpp"
+#include "math/generic_math.hpp"
 
 namespace Engine
 {
@@ -8,7 +14,11 @@ namespace Engine
 
     IMalloc* WindowsMemory::GetDefaultMalloc()
     {
+#ifdef PL_BINNED_MALLOC
+        return new BinnedMalloc();
+#else
         return new AnsiCMalloc();
+#endif
     }
 
     uint32 WindowsMemory::GetDefaultAlignment()
@@ -16,9 +26,76 @@ namespace Engine
         return SDefaultAlignment;
     }
 
+    size_t WindowsMemory::GetBinnedAllocationGranularity()
+    {
+        static size_t granularity = 0;
+        if (granularity == 0)
+        {
+            SYSTEM_INFO info;
+            ::GetSystemInfo(&info);
+            granularity = info.dwAllocationGranularity;
+        }
+        return granularity;
+    }
+
+    size_t WindowsMemory::GetPageSize()
+    {
+        static size_t pageSize = 0;
+        if (pageSize == 0)
+        {
+            SYSTEM_INFO info;
+            ::GetSystemInfo(&info);
+            pageSize = info.dwPageSize;
+        }
+        return pageSize;
+    }
+
+    size_t WindowsMemory::GetHugePageSize()
+    {
+        static size_t hugePageSize = ::GetLargePageMinimum();
+        return hugePageSize;
+    }
+
+    void* WindowsMemory::BinnedAllocFromOS(size_t size)
+    {
+        return ::VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+
+    void WindowsMemory::BinnedFreeToOS(void* ptr, size_t size)
+    {
+        ::VirtualFree(ptr, 0, MEM_RELEASE);
+    }
+
+    void* WindowsMemory::Reserve(size_t size, EHugePage hugePage)
+    {
+        const size_t hugePageSize = GetHugePageSize();
+        if (hugePage == EHugePage::Explicit && hugePageSize > 0)
+        {
+            // large pages can't be reserved without commit
+            size = Math::CeilToMultiple(size, hugePageSize);
+            return ::VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        }
+        return ::VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+    }
+
+    void WindowsMemory::Release(void* ptr, size_t size, EHugePage hugePage)
+    {
+        ::VirtualFree(ptr, 0, MEM_RELEASE);
+    }
+
+    bool WindowsMemory::Commit(void* ptr, size_t size)
+    {
+        return ::VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+    }
+
+    bool WindowsMemory::Decommit(void* ptr, size_t size)
+    {
+        return ::VirtualFree(ptr, size, MEM_DECOMMIT) != 0;
+    }
+
     void WindowsMemory::Memcpy(void* dest, void* src, size_t size)
     {
-        ::memcpy(dest, src, size);
+        SimdMemory::Memcpy(dest, src, size);
     }
 
     void WindowsMemory::Memmove(void* dest, void* src, size_t size)
@@ -28,11 +105,12 @@ namespace Engine
 
     void WindowsMemory::Memset(void *dest, uint8 byte, size_t size)
     {
-        ::memset(dest, byte, size);
+        SimdMemory::Memset(dest, byte, size);
     }
 
     bool WindowsMemory::Memcmp(void* lBuffer, void* rBuffer, size_t size)
     {
-        return ::memcmp(lBuffer, rBuffer, size) == 0;
+        return SimdMemory::Memcmp(lBuffer, rBuffer, size);
     }
-}
\ No newline at end of file
+}
+#endif
@@ -3,6 +3,7 @@
 #include "definitions_core.hpp"
 #include "global.hpp"
 #include "memory/malloc_interface.hpp"
+#include "memory/memory_type.hpp"
 
 namespace Engine
 {
@@ -13,6 +14,36 @@ namespace Engine
 
         static uint32 GetDefaultAlignment();
 
+        /** granularity of BinnedAllocFromOS, address returned from os is always aligned to it */
+        static size_t GetBinnedAllocationGranularity();
+
+        /** page size of virtual memory */
+        static size_t GetPageSize();
+
+        /** minimum size of a large page, 0 if large page is not supported */
+        static size_t GetHugePageSize();
+
+        /** allocate committed memory directly from os, the size will be rounded up to page size */
+        static void* BinnedAllocFromOS(size_t size);
+
+        /** return memory allocated by BinnedAllocFromOS to os */
+        static void BinnedFreeToOS(void* ptr, size_t size);
+
+        /**
+         * Reserve address space without physical memory, it must be committed before access.
+         * Windows has no transparent huge page, explicit huge page is committed on reserve and needs SeLockMemoryPrivilege.
+         */
+        static void* Reserve(size_t size, EHugePage hugePage = EHugePage::None);
+
+        /** release address space returned by Reserve */
+        static void Release(void* ptr, size_t size, EHugePage hugePage = EHugePage::None);
+
+        /** back a page aligned range of reserved memory with physical memory */
+        static bool Commit(void* ptr, size_t size);
+
+        /** return physical memory of a page aligned range to os, the address space is kept reserved */
+        static bool Decommit(void* ptr, size_t size);
+
         static void Memcpy(void* dest, void* src, size_t size);
 
         static void Memmove(void* dest, void* src, size_t size);
@@ -25,4 +56,4 @@ namespace Engine
     };
 
     typedef WindowsMemory PlatformMemory;
-}
\ No newline at end of file
+}
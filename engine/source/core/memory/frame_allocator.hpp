@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include "definitions_core.hpp"
+#include "global.hpp"
+
+namespace Engine
+{
+    struct FrameAllocatorStats
+    {
+        /** bytes allocated in the last finished frame, overflow included */
+        size_t LastFrameBytes{ 0 };
+        /** bytes of the last finished frame served by global malloc because the buffer was full */
+        size_t LastFrameOverflowBytes{ 0 };
+        /** max bytes allocated in one frame since start, size buffers above it */
+        size_t HighWaterMark{ 0 };
+        uint64 FrameCount{ 0 };
+    };
+
+    /**
+     * Memory living for BufferCount frames, allocation bumps a pointer and nothing is freed one by one.
+     * Buffers flip in BeginFrame, data allocated in frame N stays valid through frame N + BufferCount - 1,
+     * so with two buffers the render thread can read data of last frame while game thread builds next one.
+     * Destructors of objects allocated here are never called.
+     */
+    class CORE_API FrameAllocator
+    {
+    public:
+        static constexpr uint32 kMaxBufferCount = 4;
+        static constexpr size_t kDefaultBufferSize = 4 * 1024 * 1024;
+
+        explicit FrameAllocator(uint32 bufferCount = 2, size_t bufferSize = kDefaultBufferSize);
+
+        FrameAllocator(const FrameAllocator& other) = delete;
+
+        FrameAllocator& operator= (const FrameAllocator& other) = delete;
+
+        ~FrameAllocator();
+
+        /** frame allocator ticked by EngineLoop */
+        static FrameAllocator& Get();
+
+        /** thread safe, fallback to global malloc when buffer of current frame is full */
+        NODISCARD void* Alloc(size_t size, uint32 alignment = 16);
+
+        template <typename T>
+        NODISCARD T* AllocArray(size_t count)
+        {
+            return static_cast<T*>(Alloc(sizeof(T) * count, alignof(T)));
+        }
+
+        /** flip to next buffer and recycle it, must not run concurrently with Alloc */
+        void BeginFrame();
+
+        /** recycle all buffers, call before global malloc shuts down */
+        void Reset();
+
+        const FrameAllocatorStats& GetStats() const;
+
+    private:
+        struct OverflowBlock
+        {
+            OverflowBlock* Next;
+        };
+
+        struct Buffer
+        {
+            uint8* Base{ nullptr };
+            std::atomic<size_t> Offset{ 0 };
+            std::mutex OverflowMutex;
+            OverflowBlock* Overflow{ nullptr };
+            size_t OverflowBytes{ 0 };
+        };
+
+        void* AllocOverflow(Buffer& buffer, size_t size, uint32 alignment);
+
+        void RecycleBuffer(Buffer& buffer);
+
+    private:
+        Buffer Buffers[kMaxBufferCount];
+        uint32 BufferCount;
+        size_t BufferSize;
+        uint32 CurrentIndex{ 0 };
+        FrameAllocatorStats Stats;
+    };
+}
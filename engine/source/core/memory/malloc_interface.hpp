@@ -15,6 +15,17 @@ namespace Engine
 
         virtual void* Realloc(void* ptr, size_t size, uint32 alignment) = 0;
 
+        /** usable size of an allocation, may be larger than requested, 0 if unknown */
+        virtual size_t GetAllocationSize(void* /*ptr*/) { return 0; }
+
+        /** resize an allocation without moving it, return false if it has to move */
+        virtual bool TryResizeInPlace(void* /*ptr*/, size_t /*size*/) { return false; }
+
+        /** usable size Malloc would return for a request, lets containers turn the rounding into capacity */
+        virtual size_t QuantizeSize(size_t size, uint32 /*alignment*/) { return size; }
+
         virtual void SetupCurrentThreadTLS() {};
+
+        virtual void ClearCurrentThreadTLS() {};
     };
 }
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "definitions_core.hpp"
+#include "global.hpp"
+
+namespace Engine
+{
+    /**
+     * Linear arena, allocation bumps a pointer inside 64KB chunks and nothing is freed one by one.
+     * Memory allocated after a MemMark is released at once when the mark pops, chunks are kept for reuse.
+     * Every thread owns its stack, see Get.
+     */
+    class CORE_API MemStack
+    {
+    public:
+        static constexpr size_t kChunkSize = 64 * 1024;
+
+        MemStack() = default;
+
+        MemStack(const MemStack& other) = delete;
+
+        MemStack& operator= (const MemStack& other) = delete;
+
+        ~MemStack();
+
+        /** stack of current thread */
+        static MemStack& Get();
+
+        /** allocate from top of the stack, there must be a mark alive */
+        NODISCARD void* Alloc(size_t size, uint32 alignment);
+
+        /** grow the top most allocation without moving it, false if ptr is not on the top or chunk is full */
+        bool TryGrow(void* ptr, size_t oldSize, size_t newSize);
+
+        int32 GetMarkCount() const;
+
+        /** bytes of chunks holding live allocations, cached chunks are not counted */
+        size_t GetUsedBytes() const;
+
+        /** release cached chunks which are not in use */
+        void Trim();
+
+    private:
+        friend class MemMark;
+
+        struct Chunk
+        {
+            Chunk* Next;
+            size_t Size;
+        };
+
+        void PushChunk(size_t minSize);
+
+        /** pop chunks until top chunk is chunk */
+        void PopChunks(Chunk* chunk);
+
+    private:
+        uint8* Top{ nullptr };
+        uint8* End{ nullptr };
+        Chunk* TopChunk{ nullptr };
+        /** standard size chunks ready for reuse */
+        Chunk* FreeChunks{ nullptr };
+        size_t UsedBytes{ 0 };
+        int32 MarkCount{ 0 };
+    };
+
+    /** scope of a MemStack, pops everything allocated after it when destructed */
+    class CORE_API MemMark
+    {
+    public:
+        explicit MemMark(MemStack& stack = MemStack::Get());
+
+        MemMark(const MemMark& other) = delete;
+
+        MemMark& operator= (const MemMark& other) = delete;
+
+        ~MemMark();
+
+        /** pop before leaving scope, marks must be popped in reverse order */
+        void Pop();
+
+    private:
+        MemStack& Stack;
+        uint8* Top;
+        uint8* End;
+        MemStack::Chunk* TopChunk;
+        size_t UsedBytes;
+        int32 MarkIndex;
+    };
+}
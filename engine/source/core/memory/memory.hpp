@@ -1,12 +1,52 @@
 #pragma once
 
 #include "memory/platform_memory.hpp"
+#ifdef PL_STATIC_MALLOC
+#ifdef PL_MEMORY_TRACKER
+#error "memory tracker wraps GMalloc, static malloc bypasses it"
+#endif
+#ifdef PL_BINNED_MALLOC
+#include "memory/binned_malloc.hpp"
+#else
+#include "memory/ansi_c_malloc.hpp"
+#endif
+#endif
 
 namespace Engine
 {
+#ifdef PL_STATIC_MALLOC
+    /** global malloc picked at compile time, calls through the final class skip the vtable */
+#ifdef PL_BINNED_MALLOC
+    typedef BinnedMalloc StaticMalloc;
+#else
+    typedef AnsiCMalloc StaticMalloc;
+#endif
+#endif
+
     class CORE_API Memory
     {
     public:
+#ifdef PL_STATIC_MALLOC
+        NODISCARD static FORCEINLINE void* Malloc(size_t size)
+        {
+            return GetStaticMalloc()->Malloc(size, PlatformMemory::GetDefaultAlignment());
+        }
+
+        NODISCARD static FORCEINLINE void* Malloc(size_t size, uint32 alignment)
+        {
+            return GetStaticMalloc()->Malloc(size, alignment);
+        }
+
+        static FORCEINLINE void Free(void* ptr)
+        {
+            GetStaticMalloc()->Free(ptr);
+        }
+
+        static FORCEINLINE void* Realloc(void* ptr, size_t newSize, uint32 alignment = PlatformMemory::GetDefaultAlignment())
+        {
+            return GetStaticMalloc()->Realloc(ptr, newSize, alignment);
+        }
+#else
         NODISCARD static void* Malloc(size_t size);
 
         NODISCARD static void* Malloc(size_t size, uint32 alignment);
@@ -14,6 +54,16 @@ namespace Engine
         static void Free(void* ptr);
 
         static void* Realloc(void* ptr, size_t newSize, uint32 alignment = PlatformMemory::GetDefaultAlignment());
+#endif
+
+        /** usable size of an allocation, 0 if global malloc can't tell */
+        static size_t GetAllocationSize(void* ptr);
+
+        /** resize an allocation without moving it, return false if it has to move */
+        static bool TryResizeInPlace(void* ptr, size_t newSize);
+
+        /** usable size global malloc would return for a request, size itself if it can't tell */
+        static size_t QuantizeSize(size_t size, uint32 alignment = PlatformMemory::GetDefaultAlignment());
 
         static void Memcpy(void* dest, void* src, size_t size);
 
@@ -47,6 +97,22 @@ namespace Engine
 
         /** get global malloc object, thread unsafe */
         static IMalloc* GetGMalloc();
+
+#ifdef PL_STATIC_MALLOC
+        static FORCEINLINE StaticMalloc* GetStaticMalloc()
+        {
+            StaticMalloc* staticMalloc = SStaticMalloc;
+            if (staticMalloc == nullptr) [[unlikely]]
+            {
+                staticMalloc = CreateStaticMalloc();
+            }
+            return staticMalloc;
+        }
+
+        static StaticMalloc* CreateStaticMalloc();
+
+        static StaticMalloc* SStaticMalloc;
+#endif
     };
 }
 
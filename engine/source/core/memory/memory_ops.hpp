@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <new>
+#include "definitions_core.hpp"
+#include "global.hpp"
+#include "foundation/type_traits.hpp"
+#include "memory/memory.hpp"
+
+namespace Engine
+{
+    /** Construct count elements at dest by copying src, one memcpy when the types allow it */
+    template <typename DestType, typename SourceType, typename SizeType>
+    void ConstructElements(DestType* dest, const SourceType* src, SizeType count)
+    {
+        if constexpr (TIsBitwiseConstructibleV<DestType, SourceType>)
+        {
+            if (count > 0)
+            {
+                Memory::Memcpy((void*)dest, (void*)src, sizeof(SourceType) * count);
+            }
+        }
+        else
+        {
+            for (SizeType index = 0; index < count; ++index)
+            {
+                new(dest + index) DestType(src[index]);
+            }
+        }
+    }
+
+    template <typename ElementType, typename SizeType>
+    void DestructElements(ElementType* element, SizeType count)
+    {
+        if constexpr (!std::is_trivially_destructible_v<ElementType>)
+        {
+            while (count > 0)
+            {
+                std::destroy_at(element);
+                ++element;
+                --count;
+            }
+        }
+    }
+
+    /**
+     * Move count elements from src to uninitialized dest and destroy the sources, ranges may overlap.
+     * Trivially relocatable elements are moved with one memmove, others are move constructed one by one.
+     */
+    template <typename ElementType, typename SizeType>
+    void RelocateElements(ElementType* dest, ElementType* src, SizeType count)
+    {
+        if (count <= 0 || dest == src)
+        {
+            return;
+        }
+
+        if constexpr (TIsTriviallyRelocatableV<ElementType>)
+        {
+            Memory::Memmove((void*)dest, (void*)src, sizeof(ElementType) * count);
+        }
+        else if (dest < src)
+        {
+            // front to back, every destination is either outside src or already moved from
+            for (SizeType index = 0; index < count; ++index)
+            {
+                new(dest + index) ElementType(MoveTemp(src[index]));
+                std::destroy_at(src + index);
+            }
+        }
+        else
+        {
+            for (SizeType index = count; index > 0; --index)
+            {
+                new(dest + index - 1) ElementType(MoveTemp(src[index - 1]));
+                std::destroy_at(src + index - 1);
+            }
+        }
+    }
+
+    /** single element version of RelocateElements, fixed size copy is inlined instead of calling Memory::Memmove */
+    template <typename ElementType>
+    FORCEINLINE void RelocateElement(ElementType* dest, ElementType* src)
+    {
+        if constexpr (TIsTriviallyRelocatableV<ElementType>)
+        {
+            std::memcpy((void*)dest, (void*)src, sizeof(ElementType));
+        }
+        else
+        {
+            new(dest) ElementType(MoveTemp(*src));
+            std::destroy_at(src);
+        }
+    }
+}
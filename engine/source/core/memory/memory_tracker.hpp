@@ -0,0 +1,135 @@
+#pragma once
+
+#include "definitions_core.hpp"
+#include "global.hpp"
+#include "memory/malloc_interface.hpp"
+#include "memory/system_new_delete_object.hpp"
+
+namespace Engine
+{
+    /** subsystem an allocation is attributed to, name new tags in memory_tracker.cpp too */
+    enum class EMemoryTag : uint8
+    {
+        Untagged,
+        Strings,
+        Modules,
+        Render,
+        Log,
+        Count
+    };
+
+    struct MemoryTagStats
+    {
+        /** requested bytes of live allocations */
+        int64 CurrentBytes{ 0 };
+        int64 PeakBytes{ 0 };
+        int64 LiveAllocations{ 0 };
+        int64 TotalAllocations{ 0 };
+    };
+
+    /**
+     * Per tag allocation counters, allocations are attributed to the top of the tag stack of the calling thread.
+     * Every thread batches its counts and adds them to global atomics every few operations, so stats read
+     * from any thread lag behind by at most one batch per thread and peak misses spikes shorter than a batch.
+     * Only allocations through TrackingMalloc are counted, GMalloc is wrapped by it with PL_MEMORY_TRACKER.
+     */
+    class CORE_API MemoryTracker
+    {
+    public:
+        static constexpr int32 kMaxTagDepth = 32;
+
+        static void PushTag(EMemoryTag tag);
+
+        static void PopTag();
+
+        /** top of the tag stack of current thread, Untagged if the stack is empty */
+        static EMemoryTag GetCurrentTag();
+
+        static MemoryTagStats GetTagStats(EMemoryTag tag);
+
+        static const ansi* GetTagName(EMemoryTag tag);
+
+        static void OnAlloc(EMemoryTag tag, size_t size);
+
+        static void OnFree(EMemoryTag tag, size_t size);
+
+        /** block changed size but stays the same allocation */
+        static void OnResize(EMemoryTag tag, size_t oldSize, size_t newSize);
+
+        /** add pending counts of current thread to global stats, also done on thread exit */
+        static void FlushThreadCounters();
+
+        /** append a row per tag to a csv file, header is written when the file is empty */
+        static bool DumpCsv(const ansi* path);
+
+        /** dump to path every interval seconds from Tick, missing directories of path are created, empty path disables it */
+        static void SetCsvDump(const ansi* path, double intervalSeconds);
+
+        /** called once per frame by EngineLoop */
+        static void Tick();
+
+    private:
+        MemoryTracker() = delete;
+    };
+
+    class MemoryTagScope
+    {
+    public:
+        explicit MemoryTagScope(EMemoryTag tag)
+        {
+            MemoryTracker::PushTag(tag);
+        }
+
+        MemoryTagScope(const MemoryTagScope& other) = delete;
+
+        MemoryTagScope& operator= (const MemoryTagScope& other) = delete;
+
+        ~MemoryTagScope()
+        {
+            MemoryTracker::PopTag();
+        }
+    };
+
+    /**
+     * Decorator counting every allocation of the inner malloc to the current tag.
+     * A 16 bytes header before each block keeps requested size and tag, so Free finds what to subtract.
+     */
+    class CORE_API TrackingMalloc final : public IMalloc, public SystemNewDeleteObject
+    {
+    public:
+        /** takes ownership of inner */
+        explicit TrackingMalloc(IMalloc* inner);
+
+        ~TrackingMalloc() override;
+
+        void* Malloc(size_t size, uint32 alignment) override;
+
+        void Free(void* ptr) override;
+
+        void* Realloc(void* ptr, size_t size, uint32 alignment) override;
+
+        size_t GetAllocationSize(void* ptr) override;
+
+        bool TryResizeInPlace(void* ptr, size_t size) override;
+
+        size_t QuantizeSize(size_t size, uint32 alignment) override;
+
+        void SetupCurrentThreadTLS() override;
+
+        void ClearCurrentThreadTLS() override;
+
+    private:
+        struct AllocationHeader;
+
+        static AllocationHeader* GetHeader(void* ptr);
+
+    private:
+        IMalloc* Inner;
+    };
+}
+
+#ifdef PL_MEMORY_TRACKER
+    #define MEMORY_TAG_SCOPE(tag) Engine::MemoryTagScope PL_CONCAT(memoryTagScope, __LINE__)(Engine::EMemoryTag::tag)
+#else
+    #define MEMORY_TAG_SCOPE(tag)
+#endif
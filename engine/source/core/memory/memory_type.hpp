@@ -0,0 +1,16 @@
+#pragma once
+
+#include "global.hpp"
+
+namespace Engine
+{
+    enum class EHugePage : uint8
+    {
+        /** normal os page */
+        None,
+        /** hint os to back the range with huge pages when possible, fallback to normal page silently */
+        Transparent,
+        /** require huge pages from the preallocated pool of os, fail if pool is exhausted */
+        Explicit
+    };
+}
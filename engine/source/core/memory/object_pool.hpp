@@ -0,0 +1,347 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include "definitions_core.hpp"
+#include "global.hpp"
+#include "foundation/type_traits.hpp"
+#include "memory/platform_memory.hpp"
+
+namespace Engine
+{
+    /**
+     * Pool of objects with the same type, slots are carved from 64KB blocks of os memory and recycled through an intrusive free list.
+     * Blocks are returned to os only when the pool is destructed, so a pool can outlive Memory::Shutdown.
+     * With ThreadSafe the free list is a lock-free stack, only adding a new block takes a lock.
+     */
+    template <typename ElementType, bool ThreadSafe = false>
+    class ObjectPool
+    {
+    public:
+        static constexpr size_t kBlockSize = 64 * 1024;
+
+        ObjectPool() = default;
+
+        ObjectPool(const ObjectPool& other) = delete;
+
+        ObjectPool& operator= (const ObjectPool& other) = delete;
+
+        ~ObjectPool()
+        {
+            ENSURE(LiveCount == 0);
+            ReleaseBlocks();
+        }
+
+        template <typename... Args>
+        NODISCARD ElementType* New(Args&&... args)
+        {
+            void* slot = Allocate();
+            return slot != nullptr ? new(slot) ElementType(Forward<Args>(args)...) : nullptr;
+        }
+
+        void Delete(ElementType* object)
+        {
+            if (object != nullptr)
+            {
+                object->~ElementType();
+                Free(object);
+            }
+        }
+
+        /** uninitialized slot for one element */
+        NODISCARD void* Allocate()
+        {
+            if constexpr (ThreadSafe)
+            {
+                return PopConcurrent();
+            }
+            else
+            {
+                return Pop();
+            }
+        }
+
+        /** return a slot from Allocate, the element must be destructed */
+        void Free(void* ptr)
+        {
+            if constexpr (ThreadSafe)
+            {
+                PushConcurrent(static_cast<FreeSlot*>(ptr));
+            }
+            else
+            {
+                Push(static_cast<FreeSlot*>(ptr));
+            }
+        }
+
+        int32 GetLiveCount() const
+        {
+            return LiveCount;
+        }
+
+        int32 GetBlockCount() const
+        {
+            return BlockCount;
+        }
+
+        static constexpr uint32 GetSlotsPerBlock()
+        {
+            return kSlotsPerBlock;
+        }
+
+    private:
+        union FreeSlot
+        {
+            FreeSlot* Next;
+            uint32 NextIndex;
+        };
+
+        struct BlockHeader
+        {
+            BlockHeader* Next;
+            uint32 Index;
+        };
+
+        static constexpr size_t kSlotAlignment = alignof(ElementType) > alignof(FreeSlot) ? alignof(ElementType) : alignof(FreeSlot);
+        static constexpr size_t kSlotSize = ((sizeof(ElementType) > sizeof(FreeSlot) ? sizeof(ElementType) : sizeof(FreeSlot)) + kSlotAlignment - 1) & ~(kSlotAlignment - 1);
+        static constexpr size_t kHeaderSize = (sizeof(BlockHeader) + kSlotAlignment - 1) & ~(kSlotAlignment - 1);
+        static_assert(kHeaderSize + kSlotSize <= kBlockSize, "element is too large for ObjectPool");
+        static constexpr uint32 kSlotsPerBlock = static_cast<uint32>((kBlockSize - kHeaderSize) / kSlotSize);
+
+        /** slot index of concurrent free list is block index in high bits and slot in block in low bits */
+        static constexpr uint32 kSlotIndexBits = 13;
+        static constexpr uint32 kMaxBlockCount = 1u << (32 - kSlotIndexBits);
+        static constexpr uint32 kInvalidIndex = 0xFFFFFFFF;
+        static_assert(kSlotsPerBlock < (1u << kSlotIndexBits));
+
+        static uint8* GetFirstSlot(BlockHeader* block)
+        {
+            return reinterpret_cast<uint8*>(block) + kHeaderSize;
+        }
+
+        static BlockHeader* GetBlock(void* ptr)
+        {
+            return reinterpret_cast<BlockHeader*>(reinterpret_cast<uintptr_t>(ptr) & ~static_cast<uintptr_t>(kBlockSize - 1));
+        }
+
+        BlockHeader* AllocBlock()
+        {
+            BlockHeader* block = static_cast<BlockHeader*>(PlatformMemory::BinnedAllocFromOS(kBlockSize));
+            if (block == nullptr)
+            {
+                return nullptr;
+            }
+
+            // slot address is mapped to its block by masking, os granularity keeps blocks aligned
+            ENSURE((reinterpret_cast<uintptr_t>(block) & (kBlockSize - 1)) == 0);
+            block->Next = Blocks;
+            block->Index = static_cast<uint32>(BlockCount);
+            Blocks = block;
+            ++BlockCount;
+            return block;
+        }
+
+        void ReleaseBlocks()
+        {
+            while (Blocks != nullptr)
+            {
+                BlockHeader* block = Blocks;
+                Blocks = block->Next;
+                PlatformMemory::BinnedFreeToOS(block, kBlockSize);
+            }
+            BlockCount = 0;
+
+            if (BlockTable != nullptr)
+            {
+                PlatformMemory::Release(BlockTable, kMaxBlockCount * sizeof(BlockHeader*));
+                BlockTable = nullptr;
+            }
+        }
+
+        void* Pop()
+        {
+            FreeSlot* slot = FreeList;
+            if (slot != nullptr)
+            {
+                FreeList = slot->Next;
+            }
+            else
+            {
+                // new block is handed out front to back, untouched slots are never linked
+                if (UnusedSlot == UnusedEnd)
+                {
+                    BlockHeader* block = AllocBlock();
+                    if (block == nullptr)
+                    {
+                        return nullptr;
+                    }
+                    UnusedSlot = GetFirstSlot(block);
+                    UnusedEnd = UnusedSlot + kSlotsPerBlock * kSlotSize;
+                }
+                slot = reinterpret_cast<FreeSlot*>(UnusedSlot);
+                UnusedSlot += kSlotSize;
+            }
+
+            ++LiveCount;
+            return slot;
+        }
+
+        void Push(FreeSlot* slot)
+        {
+            if (slot == nullptr)
+            {
+                return;
+            }
+
+            slot->Next = FreeList;
+            FreeList = slot;
+            --LiveCount;
+        }
+
+        static uint64 MakeHead(uint32 index, uint32 tag)
+        {
+            return (static_cast<uint64>(tag) << 32) | index;
+        }
+
+        FreeSlot* GetSlot(uint32 index) const
+        {
+            BlockHeader* block = BlockTable[index >> kSlotIndexBits];
+            return reinterpret_cast<FreeSlot*>(GetFirstSlot(block) + (index & ((1u << kSlotIndexBits) - 1)) * kSlotSize);
+        }
+
+        static uint32 GetSlotIndex(FreeSlot* slot)
+        {
+            BlockHeader* block = GetBlock(slot);
+            const uint32 slotInBlock = static_cast<uint32>((reinterpret_cast<uint8*>(slot) - GetFirstSlot(block)) / kSlotSize);
+            return (block->Index << kSlotIndexBits) | slotInBlock;
+        }
+
+        void* PopConcurrent()
+        {
+            uint64 head = FreeHead.load(std::memory_order_acquire);
+            while (true)
+            {
+                const uint32 index = static_cast<uint32>(head);
+                if (index == kInvalidIndex)
+                {
+                    if (!AddBlockConcurrent())
+                    {
+                        return nullptr;
+                    }
+                    head = FreeHead.load(std::memory_order_acquire);
+                    continue;
+                }
+
+                // slot may be popped and written by another thread meanwhile, the tag makes the exchange fail then
+                FreeSlot* slot = GetSlot(index);
+                const uint64 next = MakeHead(slot->NextIndex, static_cast<uint32>(head >> 32) + 1);
+                if (FreeHead.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire))
+                {
+                    ++LiveCount;
+                    return slot;
+                }
+            }
+        }
+
+        void PushConcurrent(FreeSlot* slot)
+        {
+            if (slot == nullptr)
+            {
+                return;
+            }
+
+            const uint32 index = GetSlotIndex(slot);
+            uint64 head = FreeHead.load(std::memory_order_relaxed);
+            do
+            {
+                slot->NextIndex = static_cast<uint32>(head);
+            }
+            while (!FreeHead.compare_exchange_weak(head, MakeHead(index, static_cast<uint32>(head >> 32) + 1), std::memory_order_release, std::memory_order_relaxed));
+            --LiveCount;
+        }
+
+        bool AddBlockConcurrent()
+        {
+            std::lock_guard lock(GrowMutex);
+            if (static_cast<uint32>(FreeHead.load(std::memory_order_acquire)) != kInvalidIndex)
+            {
+                // another thread added a block or freed slots while waiting for the lock
+                return true;
+            }
+
+            if (static_cast<uint32>(BlockCount) == kMaxBlockCount || !EnsureBlockTable())
+            {
+                return false;
+            }
+
+            BlockHeader* block = AllocBlock();
+            if (block == nullptr)
+            {
+                return false;
+            }
+            BlockTable[block->Index] = block;
+
+            const uint32 firstIndex = block->Index << kSlotIndexBits;
+            uint8* slots = GetFirstSlot(block);
+            for (uint32 slotIndex = 0; slotIndex + 1 < kSlotsPerBlock; ++slotIndex)
+            {
+                reinterpret_cast<FreeSlot*>(slots + slotIndex * kSlotSize)->NextIndex = firstIndex + slotIndex + 1;
+            }
+
+            // link the whole block in one exchange, release publishes the block table entry too
+            FreeSlot* last = reinterpret_cast<FreeSlot*>(slots + (kSlotsPerBlock - 1) * kSlotSize);
+            uint64 head = FreeHead.load(std::memory_order_relaxed);
+            do
+            {
+                last->NextIndex = static_cast<uint32>(head);
+            }
+            while (!FreeHead.compare_exchange_weak(head, MakeHead(firstIndex, static_cast<uint32>(head >> 32) + 1), std::memory_order_release, std::memory_order_relaxed));
+            return true;
+        }
+
+        /** block table is reserved once so readers never see it move, pages are committed as blocks are added */
+        bool EnsureBlockTable()
+        {
+            if (BlockTable == nullptr)
+            {
+                BlockTable = static_cast<BlockHeader**>(PlatformMemory::Reserve(kMaxBlockCount * sizeof(BlockHeader*)));
+                if (BlockTable == nullptr)
+                {
+                    return false;
+                }
+            }
+
+            const size_t requiredBytes = (BlockCount + 1) * sizeof(BlockHeader*);
+            if (requiredBytes > CommittedTableBytes)
+            {
+                const size_t pageSize = PlatformMemory::GetPageSize();
+                if (!PlatformMemory::Commit(reinterpret_cast<uint8*>(BlockTable) + CommittedTableBytes, pageSize))
+                {
+                    return false;
+                }
+                CommittedTableBytes += pageSize;
+            }
+            return true;
+        }
+
+    private:
+        FreeSlot* FreeList{ nullptr };
+        uint8* UnusedSlot{ nullptr };
+        uint8* UnusedEnd{ nullptr };
+        BlockHeader* Blocks{ nullptr };
+        int32 BlockCount{ 0 };
+        std::conditional_t<ThreadSafe, std::atomic<int32>, int32> LiveCount{ 0 };
+
+        // only used by thread safe pool
+        std::atomic<uint64> FreeHead{ kInvalidIndex };
+        std::mutex GrowMutex;
+        BlockHeader** BlockTable{ nullptr };
+        size_t CommittedTableBytes{ 0 };
+    };
+
+    template <typename ElementType>
+    using ConcurrentObjectPool = ObjectPool<ElementType, true>;
+}
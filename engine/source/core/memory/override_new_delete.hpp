@@ -2,61 +2,111 @@
 
 #include <new>
 #include "memory/memory.hpp"
+#include "math/generic_math.hpp"
 
 /**
- * override global operator new.
+ * override global operator new and delete, route every allocation to GMalloc.
  * https://en.cppreference.com/w/cpp/memory/new/operator_new
+ *
+ * Include it in exactly one cpp of every module. Shared modules on windows link their own operator new,
+ * static build only defines it in core, more than one definition would collide at link time.
+ * Global malloc is created lazily by the first allocation, it inherits SystemNewDeleteObject
+ * so creating it never goes back here.
  */
-//NODISCARD void* operator new(size_t size)
-//{
-//    if (void* ptr = Engine::Memory::Malloc(size))
-//    {
-//        return ptr;
-//    }
-//    throw std::bad_alloc{};
-//}
-//
-//NODISCARD void* operator new(size_t size, const std::nothrow_t&) noexcept
-//{
-//    return Engine::Memory::Malloc(size);
-//}
-//
-//NODISCARD void* operator new[](size_t size)
-//{
-//    if (void* ptr = Engine::Memory::Malloc(size))
-//    {
-//        return ptr;
-//    }
-//    throw std::bad_alloc{};
-//}
-//
-//NODISCARD void* operator new[](size_t size, const std::nothrow_t&) noexcept
-//{
-//    return Engine::Memory::Malloc(size);
-//}
-//
-///** override global operator delete */
-//void operator delete(void* ptr)
-//{
-//    Engine::Memory::Free(ptr);
-//}
-//
-//void operator delete(void* ptr, const std::nothrow_t&)
-//{
-//    Engine::Memory::Free(ptr);
-//}
-//
-//void operator delete[](void* ptr)
-//{
-//    Engine::Memory::Free(ptr);
-//}
-//
-//void operator delete[](void* ptr, const std::nothrow_t&)
-//{
-//    Engine::Memory::Free(ptr);
-//}
-//
-//void operator delete (void* ptr, size_t size) { Engine::Memory::Free(ptr); }
-//void operator delete[](void* ptr, size_t size) {Engine::Memory::Free(ptr); }
-//void operator delete (void* ptr, size_t size, const std::nothrow_t&) noexcept { Engine::Memory::Free(ptr); }
-//void operator delete[](void* ptr, size_t size, const std::nothrow_t&) noexcept {Engine::Memory::Free(ptr); }
+#if defined(PL_OVERRIDE_NEW_DELETE) && (defined(PL_SHARED) || defined(CORE_EXPORT))
+
+namespace Engine
+{
+    static void* OperatorNew(size_t size, uint32 alignment)
+    {
+        // new of zero size must still return a unique address
+        size = size == 0 ? 1 : size;
+        while (true)
+        {
+            if (void* ptr = Memory::Malloc(size, alignment))
+            {
+                return ptr;
+            }
+
+            std::new_handler handler = std::get_new_handler();
+            if (handler == nullptr)
+            {
+                throw std::bad_alloc{};
+            }
+            handler();
+        }
+    }
+
+    static void* OperatorNewNoThrow(size_t size, uint32 alignment) noexcept
+    {
+        try
+        {
+            return OperatorNew(size, alignment);
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+
+    static uint32 GetNewAlignment(std::align_val_t alignment)
+    {
+        return Math::Max(static_cast<uint32>(alignment), PlatformMemory::GetDefaultAlignment());
+    }
+}
+
+NODISCARD void* operator new(size_t size)
+{
+    return Engine::OperatorNew(size, Engine::PlatformMemory::GetDefaultAlignment());
+}
+
+NODISCARD void* operator new[](size_t size)
+{
+    return Engine::OperatorNew(size, Engine::PlatformMemory::GetDefaultAlignment());
+}
+
+NODISCARD void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return Engine::OperatorNewNoThrow(size, Engine::PlatformMemory::GetDefaultAlignment());
+}
+
+NODISCARD void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return Engine::OperatorNewNoThrow(size, Engine::PlatformMemory::GetDefaultAlignment());
+}
+
+NODISCARD void* operator new(size_t size, std::align_val_t alignment)
+{
+    return Engine::OperatorNew(size, Engine::GetNewAlignment(alignment));
+}
+
+NODISCARD void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return Engine::OperatorNew(size, Engine::GetNewAlignment(alignment));
+}
+
+NODISCARD void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return Engine::OperatorNewNoThrow(size, Engine::GetNewAlignment(alignment));
+}
+
+NODISCARD void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return Engine::OperatorNewNoThrow(size, Engine::GetNewAlignment(alignment));
+}
+
+/** override global operator delete, malloc knows size and alignment of its allocations so every form is a free */
+void operator delete(void* ptr) noexcept { Engine::Memory::Free(ptr); }
+void operator delete[](void* ptr) noexcept { Engine::Memory::Free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { Engine::Memory::Free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { Engine::Memory::Free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { Engine::Memory::Free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { Engine::Memory::Free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { Engine::Memory::Free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { Engine::Memory::Free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { Engine::Memory::Free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { Engine::Memory::Free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { Engine::Memory::Free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { Engine::Memory::Free(ptr); }
+
+#endif
@@ -4,6 +4,8 @@
 
 #if PLATFORM_WINDOWS
 #include "memory/details/windows/windows_memory.hpp"
+#elif PLATFORM_LINUX
+#include "memory/details/linux/linux_memory.hpp"
 #else
 #error "unsupport platform"
 #endif
\ No newline at end of file
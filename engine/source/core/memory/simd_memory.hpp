@@ -0,0 +1,47 @@
+#pragma once
+
+#include "definitions_core.hpp"
+#include "global.hpp"
+
+namespace Engine
+{
+    enum class ESimdLevel : uint8
+    {
+        /** crt functions */
+        None,
+        Sse2,
+        Avx2,
+        /** AVX-512 F and BW */
+        Avx512
+    };
+
+    /**
+     * Memcpy, Memset and Memcmp kernels tuned for small and medium blocks like the ones containers move,
+     * the best level supported by cpu and os is picked through cpuid on first call.
+     * Blocks larger than kLargeSize go to crt which switches to non temporal stores for them.
+     */
+    class CORE_API SimdMemory
+    {
+    public:
+        static constexpr size_t kLargeSize = 256 * 1024;
+
+        /** dest and src must not overlap */
+        static void Memcpy(void* dest, const void* src, size_t size);
+
+        static void Memset(void* dest, uint8 byte, size_t size);
+
+        /** true if both buffers hold the same bytes */
+        static bool Memcmp(const void* lBuffer, const void* rBuffer, size_t size);
+
+        /** highest level of cpu and os, detected once */
+        static ESimdLevel GetSupportedLevel();
+
+        static ESimdLevel GetLevel();
+
+        /** force kernels of a level for tests and benchmarks, clamped to supported level */
+        static void SetLevel(ESimdLevel level);
+
+    private:
+        SimdMemory() = delete;
+    };
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <new>
+#include <cstdlib>
 #include "definitions_core.hpp"
 
 namespace Engine
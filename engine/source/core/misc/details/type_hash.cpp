@@ -0,0 +1,116 @@
+#include <cstring>
+#include "misc/type_hash.hpp"
+
+// HashBytes follows wyhash final 4 by Wang Yi, released into the public domain (The Unlicense).
+
+namespace Engine
+{
+    namespace
+    {
+        FORCEINLINE uint64 Read8(const uint8* ptr)
+        {
+            uint64 value;
+            std::memcpy(&value, ptr, sizeof(value));
+            return value;
+        }
+
+        FORCEINLINE uint64 Read4(const uint8* ptr)
+        {
+            uint32 value;
+            std::memcpy(&value, ptr, sizeof(value));
+            return value;
+        }
+
+        /** 1 to 3 bytes, first, middle and last byte */
+        FORCEINLINE uint64 Read3(const uint8* ptr, size_t length)
+        {
+            return (static_cast<uint64>(ptr[0]) << 16) | (static_cast<uint64>(ptr[length >> 1]) << 8) | ptr[length - 1];
+        }
+
+        /** full 128 bit product of lhs and rhs, low half in lhs and high half in rhs */
+        FORCEINLINE void Multiply128(uint64& lhs, uint64& rhs)
+        {
+#if defined(__SIZEOF_INT128__)
+            const __uint128_t product = static_cast<__uint128_t>(lhs) * rhs;
+            lhs = static_cast<uint64>(product);
+            rhs = static_cast<uint64>(product >> 64);
+#elif defined(COMPILER_MSVC) && defined(_M_X64)
+            lhs = _umul128(lhs, rhs, &rhs);
+#else
+            const uint64 lowLow = (lhs & 0xffffffff) * (rhs & 0xffffffff);
+            const uint64 highLow = (lhs >> 32) * (rhs & 0xffffffff);
+            const uint64 lowHigh = (lhs & 0xffffffff) * (rhs >> 32);
+            const uint64 highHigh = (lhs >> 32) * (rhs >> 32);
+            const uint64 cross = (lowLow >> 32) + (highLow & 0xffffffff) + lowHigh;
+            lhs = (cross << 32) | (lowLow & 0xffffffff);
+            rhs = highHigh + (highLow >> 32) + (cross >> 32);
+#endif
+        }
+    }
+
+    uint64 HashBytes(const void* data, size_t length, uint64 seed)
+    {
+        using namespace Private;
+
+        const uint8* ptr = static_cast<const uint8*>(data);
+        seed ^= MultiplyFold64(seed ^ kHashSecret0, kHashSecret1);
+        uint64 a;
+        uint64 b;
+        if (LIKELY(length <= 16))
+        {
+            if (LIKELY(length >= 4))
+            {
+                // two overlapping 4 byte reads from each end cover 4 to 16 bytes
+                const size_t offset = (length >> 3) << 2;
+                a = (Read4(ptr) << 32) | Read4(ptr + offset);
+                b = (Read4(ptr + length - 4) << 32) | Read4(ptr + length - 4 - offset);
+            }
+            else if (LIKELY(length > 0))
+            {
+                a = Read3(ptr, length);
+                b = 0;
+            }
+            else
+            {
+                a = 0;
+                b = 0;
+            }
+        }
+        else
+        {
+            size_t remain = length;
+            if (UNLIKELY(remain >= 48))
+            {
+                // three lanes do not depend on each other so their multiplies overlap
+                uint64 seed1 = seed;
+                uint64 seed2 = seed;
+                do
+                {
+                    seed = MultiplyFold64(Read8(ptr) ^ kHashSecret1, Read8(ptr + 8) ^ seed);
+                    seed1 = MultiplyFold64(Read8(ptr + 16) ^ kHashSecret2, Read8(ptr + 24) ^ seed1);
+                    seed2 = MultiplyFold64(Read8(ptr + 32) ^ kHashSecret3, Read8(ptr + 40) ^ seed2);
+                    ptr += 48;
+                    remain -= 48;
+                }
+                while (LIKELY(remain >= 48));
+                seed ^= seed1 ^ seed2;
+            }
+
+            while (UNLIKELY(remain > 16))
+            {
+                seed = MultiplyFold64(Read8(ptr) ^ kHashSecret1, Read8(ptr + 8) ^ seed);
+                ptr += 16;
+                remain -= 16;
+            }
+
+            // the last 16 bytes, they may overlap bytes already hashed
+            a = Read8(ptr + remain - 16);
+            b = Read8(ptr + remain - 8);
+        }
+
+        a ^= kHashSecret1;
+        b ^= seed;
+        Multiply128(a, b);
+        return MultiplyFold64(a ^ kHashSecret0 ^ length, b ^ kHashSecret1);
+    }
+}
@@ -1,74 +1,165 @@
 #pragma once
 
+#include <bit>
+#include <concepts>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "definitions_core.hpp"
 #include "global.hpp"
 #include "foundation/type_traits.hpp"
 
+#if defined(COMPILER_MSVC) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
 namespace Engine
 {
-    inline uint32 GetHashCode(const int8 value)
+    namespace Private
     {
-        return value;
+        /** 64 x 64 bit multiply, high and low halves of the 128 bit product folded by xor */
+        FORCEINLINE uint64 MultiplyFold64(uint64 lhs, uint64 rhs)
+        {
+#if defined(__SIZEOF_INT128__)
+            const __uint128_t product = static_cast<__uint128_t>(lhs) * rhs;
+            return static_cast<uint64>(product) ^ static_cast<uint64>(product >> 64);
+#elif defined(COMPILER_MSVC) && defined(_M_X64)
+            uint64 high;
+            const uint64 low = _umul128(lhs, rhs, &high);
+            return low ^ high;
+#else
+            const uint64 lowLow = (lhs & 0xffffffff) * (rhs & 0xffffffff);
+            const uint64 highLow = (lhs >> 32) * (rhs & 0xffffffff);
+            const uint64 lowHigh = (lhs & 0xffffffff) * (rhs >> 32);
+            const uint64 highHigh = (lhs >> 32) * (rhs >> 32);
+            const uint64 cross = (lowLow >> 32) + (highLow & 0xffffffff) + lowHigh;
+            const uint64 low = (cross << 32) | (lowLow & 0xffffffff);
+            const uint64 high = highHigh + (highLow >> 32) + (cross >> 32);
+            return low ^ high;
+#endif
+        }
+
+        constexpr uint64 kHashSecret0 = 0x2d358dccaa6c78a5ull;
+        constexpr uint64 kHashSecret1 = 0x8bb84b93962eacc9ull;
+        constexpr uint64 kHashSecret2 = 0x4b33a62ed433d4a3ull;
+        constexpr uint64 kHashSecret3 = 0x4d5a2da51de1aa47ull;
     }
 
-    inline uint32 GetHashCode(const uint8 value)
+    /**
+     * Mix all bits of value into all bits of the result with one multiply, low bits are as good as high ones
+     * so the hash can be masked to a power of two bucket count.
+     */
+    FORCEINLINE uint64 HashMix64(uint64 value)
     {
-        return value;
+        return Private::MultiplyFold64(value ^ Private::kHashSecret0, Private::kHashSecret1);
     }
 
-    inline uint32 GetHashCode(const int16 value)
+    /**
+     * Hash of length bytes at data, wyhash: 48 bytes per step in three independent multiply lanes, short keys
+     * take one or two loads. Not for cryptography, stable across runs but not across engine versions.
+     */
+    CORE_API uint64 HashBytes(const void* data, size_t length, uint64 seed = 0);
+
+    /** fold hash of the next member into seed, order matters */
+    FORCEINLINE uint32 HashCombine(uint32 seed, uint32 hash)
     {
-        return value;
+        return static_cast<uint32>(HashMix64((static_cast<uint64>(seed) << 32) | hash));
     }
 
-    inline uint32 GetHashCode(const uint16 value)
+    template <std::integral T>
+    FORCEINLINE uint32 GetHashCode(const T value)
     {
-        return value;
+        return static_cast<uint32>(HashMix64(static_cast<uint64>(value)));
     }
 
-    inline uint32 GetHashCode(const int32 value)
+    template <typename T>
+        requires std::is_enum_v<T>
+    FORCEINLINE uint32 GetHashCode(const T value)
     {
-        return value;
+        return GetHashCode(static_cast<std::underlying_type_t<T>>(value));
     }
 
-    inline uint32 GetHashCode(const uint32 value)
+    inline uint32 GetHashCode(const float value)
     {
-        return value;
+        // 0.0f and -0.0f compare equal so they must hash equal
+        return GetHashCode(value == 0.0f ? 0u : std::bit_cast<uint32>(value));
     }
 
-    inline uint32 GetHashCode(const int64 value)
+    inline uint32 GetHashCode(const double value)
     {
-        return (uint32)value + ((uint32)(value >> 32) * 23);
+        return GetHashCode(value == 0.0 ? 0ull : std::bit_cast<uint64>(value));
     }
 
-    inline uint32 GetHashCode(const uint64 value)
+    inline uint32 GetPtrHashCode(const void* value)
     {
-        return (uint32)value + ((uint32)(value >> 32) * 23);
+        std::uintptr_t ptrInt = reinterpret_cast<std::uintptr_t>(value);
+        return GetHashCode(static_cast<uint64>(ptrInt));
     }
 
-    inline uint32 GetHashCode(const float value)
+    /** pointers hash the address they hold, the pointee is not looked at */
+    inline uint32 GetHashCode(const void* value)
     {
-        return *(uint32*)&value;
+        return GetPtrHashCode(value);
     }
 
-    inline uint32 GetHashCode(const double value)
+    template <typename CharType, typename Traits>
+    inline uint32 GetHashCode(const std::basic_string_view<CharType, Traits> value)
     {
-        return GetHashCode(*(uint64*)&value);
+        return static_cast<uint32>(HashBytes(value.data(), value.size() * sizeof(CharType)));
     }
 
-    inline uint32 GetPtrHashCode(const void* value)
+    template <typename CharType, typename Traits, typename Allocator>
+    inline uint32 GetHashCode(const std::basic_string<CharType, Traits, Allocator>& value)
     {
-        std::uintptr_t ptrInt = reinterpret_cast<std::uintptr_t>(value);
-        return GetHashCode(ptrInt);
+        return static_cast<uint32>(HashBytes(value.data(), value.size() * sizeof(CharType)));
     }
 
-    inline uint32 GetHashCode(const void* value)
+    /** elements without padding or float quirks are hashed as one block of bytes, others one by one */
+    template <typename T, size_t Extent>
+    uint32 GetHashCode(const std::span<T, Extent> values)
     {
-        return GetPtrHashCode(value);
+        if constexpr (std::has_unique_object_representations_v<std::remove_cv_t<T>>)
+        {
+            return static_cast<uint32>(HashBytes(values.data(), values.size_bytes()));
+        }
+        else
+        {
+            uint32 hash = GetHashCode(values.size());
+            for (const T& value : values)
+            {
+                hash = HashCombine(hash, GetHashCode(value));
+            }
+            return hash;
+        }
     }
 
+    /**
+     * Types a keyed container can hash: GetHashCode(value) is found here or next to the type by ADL,
+     * e.g. a friend function of the type. The address of an object is never used as its hash.
+     */
     template <typename T>
-    inline uint32 GetHashCode(const T& value)
+    concept Hashable = requires(const T& value)
+    {
+        { GetHashCode(value) } -> std::convertible_to<uint32>;
+    };
+
+    /**
+     * GetHashCode of any Hashable value. Key functions call this, their own static GetHashCode hides the free
+     * functions from unqualified lookup inside them.
+     */
+    template <Hashable T>
+    FORCEINLINE uint32 HashValue(const T& value)
+    {
+        return GetHashCode(value);
+    }
+
+    /** hash of several members of a key, e.g. GetHashCode of a struct */
+    template <Hashable T, Hashable... Rest>
+    uint32 HashValues(const T& value, const Rest&... rest)
     {
-        return GetPtrHashCode(&value);
+        uint32 hash = HashValue(value);
+        ((hash = HashCombine(hash, HashValue(rest))), ...);
+        return hash;
     }
 }
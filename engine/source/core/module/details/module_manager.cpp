@@ -10,7 +10,7 @@ namespace Engine
 
     IModuleInterface* ModuleManager::FindModule(const FixedString &name)
     {
-        if (IModuleInterface** module = CachedModule.Find(name))
+        if (IModuleInterface* const* module = CachedModule.Find(name))
         {
             return *module;
         }
@@ -19,15 +19,15 @@ namespace Engine
 
     void ModuleManager::Shutdown()
     {
-        for (auto&& pair : CachedModule)
+        CachedModule.ForEach([](const FixedString&, IModuleInterface* module)
         {
-            pair.Value->Shutdown();
-        }
+            module->Shutdown();
+        });
 
-        for (auto&& pair : CachedModule)
+        CachedModule.ForEach([](const FixedString&, IModuleInterface* module)
         {
-            delete pair.Value;
-        }
+            delete module;
+        });
         CachedModule.Clear();
     }
 }
\ No newline at end of file
@@ -3,7 +3,9 @@
 #include "definitions_core.hpp"
 #include "global.hpp"
 #include "module/module_interface.hpp"
+#include "foundation/concurrent_map.hpp"
 #include "foundation/fixed_string.hpp"
+#include "memory/memory_tracker.hpp"
 
 namespace Engine
 {
@@ -33,22 +35,20 @@ namespace Engine
         template <ModuleType Module>
         IModuleInterface* LoadImpl(const FixedString& name)
         {
-            IModuleInterface* module;
-            {
-                std::shared_lock lock(ModuleRWMutex);
-                module = FindModule(name);
-            }
+            IModuleInterface* module = FindModule(name);
             if (module)
             {
                 return module;
             }
             else
             {
-                std::lock_guard lock(ModuleRWMutex);
+                // lookups take no lock, the lock only makes sure a module starts up once
+                std::lock_guard lock(ModuleMutex);
                 module = FindModule(name);
 
                 if (!module)
                 {
+                    MEMORY_TAG_SCOPE(Modules);
                     module = new Module();
                     module->Startup();
                     CachedModule.Add(name, module);
@@ -61,7 +61,7 @@ namespace Engine
 
         void Shutdown();
 
-        Map<FixedString, IModuleInterface*> CachedModule;
-        std::shared_mutex ModuleRWMutex;
+        ConcurrentMap<FixedString, IModuleInterface*, true> CachedModule;
+        std::mutex ModuleMutex;
     };
 }
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include "global.hpp"
+
+#if PLATFORM_LINUX
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "thread/details/linux/linux_tls.hpp"
+
+namespace Engine
+{
+    namespace
+    {
+        constexpr uint32 kInvalidTlsIndex = 0xffffffff;
+    }
+
+    uint32 LinuxTLS::GetThreadId()
+    {
+        return static_cast<uint32>(::syscall(SYS_gettid));
+    }
+
+    uint32 LinuxTLS::AllocTls()
+    {
+        pthread_key_t key;
+        if (::pthread_key_create(&key, nullptr) != 0)
+        {
+            return kInvalidTlsIndex;
+        }
+        return static_cast<uint32>(key);
+    }
+
+    void LinuxTLS::FreeTls(uint32 tlsIndex)
+    {
+        ::pthread_key_delete(static_cast<pthread_key_t>(tlsIndex));
+    }
+
+    bool LinuxTLS::IsTlsIndexValid(uint32 tlsIndex)
+    {
+        return tlsIndex != kInvalidTlsIndex;
+    }
+
+    void* LinuxTLS::GetTlsValue(uint32 tlsIndex)
+    {
+        return ::pthread_getspecific(static_cast<pthread_key_t>(tlsIndex));
+    }
+
+    void LinuxTLS::SetTlsValue(uint32 tlsIndex, void* value)
+    {
+        ::pthread_setspecific(static_cast<pthread_key_t>(tlsIndex), value);
+    }
+}
+#endif
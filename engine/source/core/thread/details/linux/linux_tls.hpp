@@ -0,0 +1,28 @@
+#pragma once
+
+#include "definitions_core.hpp"
+#include "global.hpp"
+
+namespace Engine
+{
+    class CORE_API LinuxTLS
+    {
+    public:
+        LinuxTLS() = delete;
+
+        static uint32 GetThreadId();
+
+        /** get tls index, maybe invalid */
+        static uint32 AllocTls();
+
+        static void FreeTls(uint32 tlsIndex);
+
+        static bool IsTlsIndexValid(uint32 tlsIndex);
+
+        static void* GetTlsValue(uint32 tlsIndex);
+
+        static void SetTlsValue(uint32 tlsIndex, void* value);
+    };
+
+    typedef LinuxTLS PlatformTLS;
+}
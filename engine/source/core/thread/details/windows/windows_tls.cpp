@@ -1,10 +1,13 @@
 //#include "precompiled_core.hpp"
+#include "global.hpp"
+
+#if PLATFORM_WINDOWS
 #include "thread/details/windows/windows_tls.hpp"
 #include <windows.h>
 
 namespace Engine
 {
-    uint32 WindowsTLS::GetThreadId() const
+    uint32 WindowsTLS::GetThreadId()
     {
         return ::GetCurrentThreadId();
     }
@@ -14,6 +17,11 @@ namespace Engine
         return ::TlsAlloc();
     }
 
+    void WindowsTLS::FreeTls(uint32 tlsIndex)
+    {
+        ::TlsFree(tlsIndex);
+    }
+
     bool WindowsTLS::IsTlsIndexValid(uint32 tlsIndex)
     {
         return tlsIndex != TLS_OUT_OF_INDEXES;
@@ -28,4 +36,5 @@ namespace Engine
     {
         ::TlsSetValue(tlsIndex, value);
     }
-}
\ No newline at end of file
+}
+#endif
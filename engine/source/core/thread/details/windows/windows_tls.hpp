@@ -1,25 +1,28 @@
 #pragma once
 
+#include "definitions_core.hpp"
 #include "global.hpp"
 
 namespace Engine
 {
-    class WindowsTLS
+    class CORE_API WindowsTLS
     {
     public:
         WindowsTLS() = delete;
 
-        uint32 GetThreadId() const;
+        static uint32 GetThreadId();
 
         /** get tls index, maybe invalid */
-        uint32 AllocTls();
+        static uint32 AllocTls();
 
-        bool IsTlsIndexValid(uint32 tlsIndex);
+        static void FreeTls(uint32 tlsIndex);
 
-        void* GetTlsValue(uint32 tlsIndex);
+        static bool IsTlsIndexValid(uint32 tlsIndex);
 
-        void SetTlsValue(uint32 tlsIndex, void* value);
+        static void* GetTlsValue(uint32 tlsIndex);
+
+        static void SetTlsValue(uint32 tlsIndex, void* value);
     };
 
     typedef WindowsTLS PlatformTLS;
-}
\ No newline at end of file
+}
@@ -4,6 +4,8 @@
 
 #if PLATFORM_WINDOWS
 #include "thread/details/windows/windows_tls.hpp"
+#elif PLATFORM_LINUX
+#include "thread/details/linux/linux_tls.hpp"
 #else
 #error "unsupport platform"
 #endif
\ No newline at end of file
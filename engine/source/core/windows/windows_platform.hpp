@@ -24,4 +24,8 @@ namespace Engine
     #define DLLEXPORT __declspec(dllexport)
 
     #define NODISCARD [[nodiscard]]
+
+#ifndef FORCEINLINE
+    #define FORCEINLINE __forceinline
+#endif
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "engine_loop.hpp"
 #include "platform_application.hpp"
 #include "memory/memory.hpp"
+#include "memory/frame_allocator.hpp"
+#include "memory/memory_tracker.hpp"
 #include "render_module.hpp"
 #include "module/module_manager.hpp"
 
@@ -8,12 +10,21 @@ namespace Engine
 {
     void EngineLoop::Init()
     {
+#ifdef PL_MEMORY_TRACKER
+        MemoryTracker::SetCsvDump("logs/memory_tracker.csv", 10.0);
+#endif
         auto* app = PlatformApplication::CreateApplication();
         ModuleManager::Load<RenderModule>(_T("Render"));
     }
 
     void EngineLoop::Tick()
     {
+        // memory of frame N - 1 stays valid during this frame, older frame memory is recycled
+        FrameAllocator::Get().BeginFrame();
+#ifdef PL_MEMORY_TRACKER
+        MemoryTracker::Tick();
+#endif
+
         auto* app = PlatformApplication::GetApplication();
         if (app != nullptr)
         {
@@ -25,6 +36,7 @@ namespace Engine
     {
         ModuleManager::ShutdownModule();
         PlatformApplication::DestroyApplication();
+        FrameAllocator::Get().Reset();
         Memory::Shutdown();
     }
 
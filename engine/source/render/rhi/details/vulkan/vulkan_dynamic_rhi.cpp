@@ -3,6 +3,7 @@
 #include "rhi/details/vulkan/vulkan_dynamic_rhi.hpp"
 #include "rhi/details/vulkan/vulkan_platform.hpp"
 #include "platform_application.hpp"
+#include "memory/memory_tracker.hpp"
 
 static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(
     VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
@@ -35,6 +36,7 @@ namespace Engine
 {
     void VulkanDynamicRHI::Init()
     {
+        MEMORY_TAG_SCOPE(Render);
         InitInstance();
         SetupDebugMessenger();
 
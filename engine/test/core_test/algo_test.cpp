@@ -0,0 +1,226 @@
+#include "gtest/gtest.h"
+#include "foundation/dynamic_array.hpp"
+#include "algo/binary_search.hpp"
+#include "algo/heap.hpp"
+#include "algo/parallel_sort.hpp"
+#include "algo/radix_sort.hpp"
+#include "algo/sort.hpp"
+#include "algo/stable_sort.hpp"
+#include <algorithm>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+    struct AlgoKeyValue
+    {
+        int32 Key;
+        int32 Order;
+    };
+
+    static DynamicArray<int32> MakeRandomArray(int32 count, int32 maxValue)
+    {
+        std::mt19937 random(count);
+        std::uniform_int_distribution<int32> distribution(-maxValue, maxValue);
+        DynamicArray<int32> array;
+        for (int32 i = 0; i < count; i++)
+        {
+            array.Add(distribution(random));
+        }
+        return array;
+    }
+
+    static bool MatchesStdSort(const DynamicArray<int32>& sorted, const DynamicArray<int32>& source)
+    {
+        std::vector<int32> expected(source.begin(), source.end());
+        std::sort(expected.begin(), expected.end());
+        return std::equal(sorted.begin(), sorted.end(), expected.begin(), expected.end());
+    }
+
+    TEST(AlgoTest, Sort)
+    {
+        for (int32 count : { 0, 1, 2, 15, 17, 100, 10000 })
+        {
+            for (int32 maxValue : { 3, 1000000 })
+            {
+                const DynamicArray<int32> source = MakeRandomArray(count, maxValue);
+                DynamicArray<int32> array = source;
+                Algo::Sort(array);
+                EXPECT_TRUE(MatchesStdSort(array, source));
+            }
+        }
+
+        // sorted, reversed and equal inputs hit the worst cases of a plain quick sort
+        DynamicArray<int32> array;
+        array.Resize(5000, 7);
+        Algo::Sort(array);
+        EXPECT_TRUE(std::is_sorted(array.begin(), array.end()));
+        for (int32 i = 0; i < 5000; i++)
+        {
+            array[i] = i;
+        }
+        Algo::Sort(array, std::greater<>());
+        EXPECT_TRUE(array[0] == 4999 && std::is_sorted(array.begin(), array.end(), std::greater<>()));
+        Algo::Sort(array);
+        EXPECT_TRUE(array[0] == 0 && std::is_sorted(array.begin(), array.end()));
+
+        // only a part of the array
+        array = { 5, 4, 3, 2, 1 };
+        Algo::Sort(std::span(array.Data() + 1, 3));
+        EXPECT_TRUE(array == DynamicArray<int32>({ 5, 2, 3, 4, 1 }));
+
+        DynamicArray<AlgoKeyValue> pairs = { { 3, 0 }, { 1, 1 }, { 2, 2 } };
+        Algo::SortBy(pairs, &AlgoKeyValue::Key);
+        EXPECT_TRUE(pairs[0].Key == 1 && pairs[1].Key == 2 && pairs[2].Key == 3);
+
+        std::vector<std::string> strings = { "c", "a", "b" };
+        Algo::Sort(strings);
+        EXPECT_TRUE(strings[0] == "a" && strings[2] == "c");
+    }
+
+    TEST(AlgoTest, StableSort)
+    {
+        for (int32 count : { 0, 1, 16, 17, 1000, 10000 })
+        {
+            const DynamicArray<int32> keys = MakeRandomArray(count, 50);
+            DynamicArray<AlgoKeyValue> pairs;
+            for (int32 i = 0; i < count; i++)
+            {
+                pairs.Add({ keys[i], i });
+            }
+
+            Algo::StableSortBy(pairs, &AlgoKeyValue::Key);
+            for (int32 i = 1; i < count; i++)
+            {
+                EXPECT_TRUE(pairs[i - 1].Key < pairs[i].Key || (pairs[i - 1].Key == pairs[i].Key && pairs[i - 1].Order < pairs[i].Order));
+            }
+        }
+
+        DynamicArray<std::string> strings;
+        for (int32 i = 0; i < 100; i++)
+        {
+            strings.Add(std::to_string(i % 10) + " longer than the small string buffer " + std::to_string(i));
+        }
+        Algo::StableSort(strings, [](const std::string& lhs, const std::string& rhs) { return lhs[0] < rhs[0]; });
+        EXPECT_TRUE(strings[0] == "0 longer than the small string buffer 0");
+        EXPECT_TRUE(strings[1] == "0 longer than the small string buffer 10");
+        EXPECT_TRUE(strings[99] == "9 longer than the small string buffer 99");
+    }
+
+    TEST(AlgoTest, RadixSort)
+    {
+        for (int32 count : { 0, 1, 50, 1000, 100000 })
+        {
+            const DynamicArray<int32> source = MakeRandomArray(count, 1 << 30);
+            DynamicArray<int32> array = source;
+            Algo::RadixSort(array);
+            EXPECT_TRUE(MatchesStdSort(array, source));
+        }
+
+        DynamicArray<uint64> wide = { 1ull << 40, 3, 1ull << 63, 0, 3 };
+        Algo::RadixSort(wide);
+        EXPECT_TRUE(wide == DynamicArray<uint64>({ 0, 3, 3, 1ull << 40, 1ull << 63 }));
+
+        DynamicArray<float> floats;
+        for (int32 i = 0; i < 1000; i++)
+        {
+            floats.Add((float)((i * 7919) % 1000 - 500) * 0.25f);
+        }
+        floats.Add(-1e30f);
+        floats.Add(1e30f);
+        Algo::RadixSort(floats);
+        EXPECT_TRUE(std::is_sorted(floats.begin(), floats.end()));
+        EXPECT_TRUE(floats[0] == -1e30f && floats[floats.Size() - 1] == 1e30f);
+
+        // stable by key
+        DynamicArray<AlgoKeyValue> pairs;
+        for (int32 i = 0; i < 1000; i++)
+        {
+            pairs.Add({ (i * 31) % 7 - 3, i });
+        }
+        Algo::RadixSort(pairs, &AlgoKeyValue::Key);
+        for (int32 i = 1; i < pairs.Size(); i++)
+        {
+            EXPECT_TRUE(pairs[i - 1].Key < pairs[i].Key || (pairs[i - 1].Key == pairs[i].Key && pairs[i - 1].Order < pairs[i].Order));
+        }
+    }
+
+    TEST(AlgoTest, BinarySearch)
+    {
+        DynamicArray<int32> array = MakeRandomArray(1000, 100);
+        Algo::Sort(array);
+        for (int32 value = -102; value <= 102; value++)
+        {
+            EXPECT_TRUE(Algo::LowerBound(array, value) == std::lower_bound(array.begin(), array.end(), value) - array.begin());
+            EXPECT_TRUE(Algo::UpperBound(array, value) == std::upper_bound(array.begin(), array.end(), value) - array.begin());
+            const int32 index = Algo::BinarySearch(array, value);
+            EXPECT_TRUE(std::binary_search(array.begin(), array.end(), value) ? array[index] == value : index == INDEX_NONE);
+        }
+
+        DynamicArray<int32> empty;
+        EXPECT_TRUE(Algo::LowerBound(empty, 1) == 0 && Algo::UpperBound(empty, 1) == 0);
+        EXPECT_TRUE(Algo::BinarySearch(empty, 1) == INDEX_NONE);
+
+        DynamicArray<AlgoKeyValue> pairs = { { 1, 0 }, { 3, 1 }, { 3, 2 }, { 5, 3 } };
+        EXPECT_TRUE(Algo::LowerBoundBy(pairs, 3, &AlgoKeyValue::Key) == 1);
+        EXPECT_TRUE(Algo::UpperBoundBy(pairs, 3, &AlgoKeyValue::Key) == 3);
+        EXPECT_TRUE(Algo::LowerBoundBy(pairs, 6, &AlgoKeyValue::Key) == 4);
+
+        std::vector<int32> vector = { 1, 2, 2, 3 };
+        EXPECT_TRUE(Algo::UpperBound(vector, 2) == 3u);
+    }
+
+    TEST(AlgoTest, Heap)
+    {
+        DynamicArray<int32> array = MakeRandomArray(1000, 1000);
+        Algo::Heapify(array);
+        EXPECT_TRUE(Algo::IsHeap(array));
+        EXPECT_TRUE(array[0] == *std::max_element(array.begin(), array.end()));
+
+        array.Add(5000);
+        Algo::HeapPush(array);
+        EXPECT_TRUE(array[0] == 5000 && Algo::IsHeap(array));
+
+        int32 previous = MAX_INT32;
+        while (!array.IsEmpty())
+        {
+            Algo::HeapPop(array);
+            EXPECT_TRUE(array[array.Size() - 1] <= previous);
+            previous = array[array.Size() - 1];
+            array.RemoveAt(array.Size() - 1);
+            EXPECT_TRUE(Algo::IsHeap(array));
+        }
+
+        const DynamicArray<int32> source = MakeRandomArray(3000, 1000);
+        array = source;
+        Algo::HeapSort(array);
+        EXPECT_TRUE(MatchesStdSort(array, source));
+
+        // a min heap with greater
+        array = { 5, 1, 4, 2, 3 };
+        Algo::Heapify(array, std::greater<>());
+        EXPECT_TRUE(array[0] == 1 && Algo::IsHeap(array, std::greater<>()));
+    }
+
+    TEST(AlgoTest, ParallelSort)
+    {
+        const DynamicArray<int32> source = MakeRandomArray(300000, 1 << 20);
+        for (int32 taskCount : { 1, 2, 3, 8 })
+        {
+            DynamicArray<int32> array = source;
+            Algo::ParallelSort(array, std::less<>(), taskCount);
+            EXPECT_TRUE(MatchesStdSort(array, source));
+        }
+
+        // elements relocated by move constructor across tasks
+        DynamicArray<std::string> strings;
+        for (int32 i = 0; i < 70000; i++)
+        {
+            strings.Add(std::to_string((i * 7919) % 70000) + " longer than the small string buffer");
+        }
+        Algo::ParallelSort(strings, std::less<>(), 4);
+        EXPECT_TRUE(std::is_sorted(strings.begin(), strings.end()) && strings.Size() == 70000);
+    }
+}
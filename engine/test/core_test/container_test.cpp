@@ -4,6 +4,14 @@
 #include "foundation/sparse_array.hpp"
 #include "foundation/set.hpp"
 #include "foundation/map.hpp"
+#include "foundation/flat_set.hpp"
+#include "foundation/flat_map.hpp"
+#include "foundation/sorted_flat_map.hpp"
+#include "foundation/concurrent_map.hpp"
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 namespace Engine
@@ -24,6 +32,49 @@ namespace Engine
         int32* Z{ nullptr };
     };
 
+    /** element pointing into itself, a memcpy leaves Self at the old address */
+    struct SelfPointingElement
+    {
+        static inline int32 SLiveCount = 0;
+
+        SelfPointingElement(int32 value = 0) : Value(value), Self(this) { ++SLiveCount; }
+
+        SelfPointingElement(const SelfPointingElement& other) : Value(other.Value), Self(this) { ++SLiveCount; }
+
+        SelfPointingElement(SelfPointingElement&& other) noexcept : Value(other.Value), Self(this) { ++SLiveCount; }
+
+        SelfPointingElement& operator= (const SelfPointingElement& other)
+        {
+            Value = other.Value;
+            return *this;
+        }
+
+        ~SelfPointingElement()
+        {
+            EXPECT_TRUE(Self == this);
+            --SLiveCount;
+        }
+
+        bool operator== (const SelfPointingElement& other) const { return Value == other.Value; }
+
+        bool IsValid() const { return Self == this; }
+
+        int32 Value;
+        SelfPointingElement* Self;
+    };
+
+    struct SelfPointingKeyFunc : DefaultSetKeyFunc<SelfPointingElement>
+    {
+        static uint32 GetHashCode(const SelfPointingElement& element) { return Engine::GetHashCode(element.Value); }
+    };
+
+    static_assert(TIsTriviallyRelocatableV<int32> && !TIsTriviallyRelocatableV<ListTestStruct>);
+    static_assert(!TIsTriviallyRelocatableV<SelfPointingElement> && !TIsTriviallyRelocatableV<std::string>);
+    static_assert(TIsTriviallyRelocatableV<DynamicArray<SelfPointingElement>>);
+    static_assert(!TIsTriviallyRelocatableV<DynamicArray<int32, InlineAllocator<4>>>);
+    static_assert(TIsBitwiseConstructibleV<int32, uint32> && !TIsBitwiseConstructibleV<int32, int64>);
+    static_assert(!TIsBitwiseConstructibleV<std::string, std::string>);
+
     TEST(ContainerTest, DynamicArray_Base)
     {
         DynamicArray<int> array(10);
@@ -113,15 +164,119 @@ namespace Engine
     {
         DynamicArray<int32> array = {1, 2, 3, 4, 5};
         array.Remove(4, 4);
-        EXPECT_TRUE(array.Size() == 4 && *(--array.end()) == 4);
+        EXPECT_TRUE(array.Size() == 4 && *(array.end() - 1) == 4);
 
         array.Add(5);
         array.Remove(1, 3);
-        EXPECT_TRUE(array.Size() == 2 && *(--array.end()) == 5 && *array.begin() == 1);
+        EXPECT_TRUE(array.Size() == 2 && *(array.end() - 1) == 5 && *array.begin() == 1);
         array.Remove(0, 1);
         EXPECT_TRUE(array.Size() == 0);
     }
 
+    TEST(ContainerTest, DynamicArray_RemoveMatch)
+    {
+        DynamicArray<int32> array;
+        for (int32 i = 0; i < 100; i++)
+        {
+            array.Add(i);
+        }
+
+        int32 calls = 0;
+        const int32 removed = array.RemoveMatch([&calls](int32 value) {
+            ++calls;
+            return value % 3 == 0 || (value > 40 && value < 60);
+        });
+        EXPECT_TRUE(calls == 100);
+        EXPECT_TRUE(removed == 100 - array.Size());
+        for (int32 i = 0; i < array.Size(); i++)
+        {
+            EXPECT_TRUE(array[i] % 3 != 0 && (array[i] <= 40 || array[i] >= 60));
+            EXPECT_TRUE(i == 0 || array[i - 1] < array[i]);
+        }
+
+        const int32 remaining = array.Size();
+        EXPECT_TRUE(array.RemoveMatch([](int32) { return true; }) == remaining);
+        EXPECT_TRUE(array.IsEmpty() && array.RemoveMatch([](int32) { return true; }) == 0);
+
+        array = {1, 2, 1, 1, 3, 1};
+        EXPECT_TRUE(array.Remove(1));
+        EXPECT_TRUE(array == DynamicArray<int32>({2, 3}));
+        EXPECT_TRUE(!array.Remove(1));
+    }
+
+    TEST(ContainerTest, DynamicArray_RemoveSwap)
+    {
+        DynamicArray<int32> array = {0, 1, 2, 3, 4, 5, 6, 7};
+        array.RemoveAtSwap(1);
+        EXPECT_TRUE(array == DynamicArray<int32>({0, 7, 2, 3, 4, 5, 6}));
+        array.RemoveAtSwap(6);
+        EXPECT_TRUE(array == DynamicArray<int32>({0, 7, 2, 3, 4, 5}));
+        array.RemoveAtSwap(1, 2);
+        EXPECT_TRUE(array == DynamicArray<int32>({0, 4, 5, 3}));
+        array.RemoveAtSwap(0, 3);
+        EXPECT_TRUE(array == DynamicArray<int32>({3}));
+
+        array = {1, 2, 1, 3, 1, 1};
+        EXPECT_TRUE(array.RemoveAllSwap(1) == 4);
+        EXPECT_TRUE(array.Size() == 2 && array[0] + array[1] == 5);
+
+        array = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+        EXPECT_TRUE(array.RemoveAllSwap([](int32 value) { return value % 2 == 0; }) == 5);
+        EXPECT_TRUE(array.Size() == 5);
+        for (int32 value : array)
+        {
+            EXPECT_TRUE(value % 2 == 1);
+        }
+
+        array = {0, 1, 2, 3, 4, 5};
+        array.RemoveAt(1, 3);
+        EXPECT_TRUE(array == DynamicArray<int32>({0, 4, 5}));
+        array.RemoveAt(1, 0);
+        EXPECT_TRUE(array.Size() == 3);
+    }
+
+    TEST(ContainerTest, DynamicArray_Growth)
+    {
+        DynamicArray<int32> array;
+        int32 growCount = 0;
+        for (int32 i = 0; i < 100000; i++)
+        {
+            const int32 oldCapacity = array.Capacity();
+            array.Add(i);
+            if (array.Capacity() != oldCapacity)
+            {
+                ++growCount;
+                // capacity covers everything malloc rounds the allocation up to
+                EXPECT_TRUE(Memory::QuantizeSize(array.Capacity() * sizeof(int32)) == array.Capacity() * sizeof(int32));
+            }
+        }
+        EXPECT_TRUE(growCount < 32);
+        EXPECT_TRUE(array.GetAllocatedSize() == array.Capacity() * sizeof(int32));
+
+        // removal shrinks once most of the allocation is unused
+        array.RemoveAt(100, array.Size() - 100);
+        EXPECT_TRUE(array.Size() == 100 && array[99] == 99);
+        EXPECT_TRUE(array.Capacity() >= 100 && array.Capacity() < 1000);
+
+        DynamicArray<int32, DefaultAllocator, NoShrinkGrowthPolicy> noShrink;
+        noShrink.Resize(100000);
+        noShrink.RemoveMatch([](int32) { return true; });
+        EXPECT_TRUE(noShrink.IsEmpty() && noShrink.Capacity() >= 100000);
+        noShrink.ShrinkToFit();
+        EXPECT_TRUE(noShrink.Capacity() == 0 && noShrink.GetAllocatedSize() == 0);
+
+        // small arrays keep their slack
+        array = {1, 2, 3, 4, 5, 6, 7, 8};
+        const int32 capacity = array.Capacity();
+        array.RemoveAt(0, 7);
+        EXPECT_TRUE(array.Capacity() == capacity && array[0] == 8);
+
+        DynamicArray<int32, InlineAllocator<8>> inlineArray = {1, 2, 3};
+        EXPECT_TRUE(inlineArray.GetAllocatedSize() == 0);
+        inlineArray.ShrinkToFit();
+        EXPECT_TRUE(inlineArray.Capacity() == 8 && inlineArray[2] == 3);
+    }
+
     TEST(ContainerTest, DynamicArray_Iterator)
     {
         DynamicArray<int> array = {1, 2, 3, 4, 0 };
@@ -131,18 +286,140 @@ namespace Engine
             PL_INFO("", _T("item of array is: {0}"), value);
         }
 
+        static_assert(std::contiguous_iterator<DynamicArray<int>::Iterator>);
+        static_assert(std::contiguous_iterator<DynamicArray<int>::ConstIterator>);
+        static_assert(std::ranges::contiguous_range<DynamicArray<int>>);
+
         for (DynamicArray<int>::Iterator iter = array.begin(); iter != array.end(); ++iter)
         {
-            if (*iter > 2)
+            *iter *= 2;
+        }
+        EXPECT_TRUE(array[1] == 4 && array[4] == 0);
+
+        std::sort(array.begin(), array.end());
+        EXPECT_TRUE(array == DynamicArray<int>({0, 2, 4, 6, 8}));
+        EXPECT_TRUE(std::ranges::find(array, 6) - array.begin() == 3);
+        EXPECT_TRUE(std::to_address(array.begin()) == array.Data());
+
+        const DynamicArray<int>& constArray = array;
+        DynamicArray<int>::ConstIterator constIter = array.begin();
+        EXPECT_TRUE(constIter == constArray.begin() && constArray.end() - constIter == 5);
+
+        int32 expected = 8;
+        for (DynamicArray<int>::ConstReverseIterator iter = constArray.rbegin(); iter != constArray.rend(); ++iter)
+        {
+            EXPECT_TRUE(*iter == expected);
+            expected -= 2;
+        }
+        EXPECT_TRUE(expected == -2);
+    }
+
+    TEST(ContainerTest, DynamicArray_NonTrivial)
+    {
+        {
+            DynamicArray<SelfPointingElement> array;
+            for (int32 i = 0; i < 100; i++)
+            {
+                array.Add(SelfPointingElement(i));
+            }
+            array.Insert(0, SelfPointingElement(-1));
+            array.RemoveAt(10, 5);
+            array.RemoveAtSwap(3);
+            array.RemoveMatch([](const SelfPointingElement& element) { return element.Value % 7 == 0; });
+            array.RemoveAllSwap([](const SelfPointingElement& element) { return element.Value % 11 == 0; });
+
+            DynamicArray<SelfPointingElement> copy = array;
+            array.Reserve(1000);
+            for (int32 i = 0; i < array.Size(); i++)
+            {
+                EXPECT_TRUE(array[i].IsValid() && copy[i].IsValid() && array[i] == copy[i]);
+                EXPECT_TRUE(array[i].Value % 7 != 0 && array[i].Value % 11 != 0);
+            }
+            EXPECT_TRUE(SelfPointingElement::SLiveCount == array.Size() * 2);
+        }
+        EXPECT_TRUE(SelfPointingElement::SLiveCount == 0);
+
+        DynamicArray<std::string> strings;
+        for (int32 i = 0; i < 50; i++)
+        {
+            strings.Add(std::to_string(i) + (i % 2 ? "" : " longer than the small string buffer"));
+        }
+        DynamicArray<std::string> stringsCopy = strings;
+        strings.RemoveAt(0);
+        EXPECT_TRUE(strings[0] == "1" && stringsCopy[0] == "0 longer than the small string buffer");
+        EXPECT_TRUE(stringsCopy[49] == "49" && stringsCopy.Size() == 50);
+    }
+
+    struct alignas(64) OverAlignedElement
+    {
+        int32 Value;
+    };
+
+    struct NoDefaultElement
+    {
+        explicit NoDefaultElement(int32 value) : Value(value) {}
+
+        int32 Value;
+    };
+
+    TEST(ContainerTest, DynamicArray_InlineAllocator)
+    {
+        using InlineArray = DynamicArray<SelfPointingElement, InlineAllocator<4>>;
+        {
+            // inline slots are raw, nothing is constructed until elements are added
+            InlineArray array;
+            EXPECT_TRUE(SelfPointingElement::SLiveCount == 0 && array.Capacity() == 4);
+            for (int32 i = 0; i < 3; i++)
             {
-                iter.RemoveSelf();
+                array.Add(SelfPointingElement(i));
             }
+            EXPECT_TRUE(SelfPointingElement::SLiveCount == 3 && array.GetAllocatedSize() == 0);
+
+            InlineArray inlineMoved = MoveTemp(array);
+            EXPECT_TRUE(array.IsEmpty() && inlineMoved.Size() == 3 && inlineMoved[2].IsValid() && inlineMoved[2].Value == 2);
+
+            // spill to heap, then come back once shrunk
+            for (int32 i = 3; i < 10; i++)
+            {
+                inlineMoved.Add(SelfPointingElement(i));
+            }
+            EXPECT_TRUE(inlineMoved.GetAllocatedSize() > 0 && inlineMoved[0].IsValid() && inlineMoved[9].Value == 9);
+
+            InlineArray heapMoved;
+            heapMoved.Add(SelfPointingElement(-1));
+            heapMoved = MoveTemp(inlineMoved);
+            EXPECT_TRUE(heapMoved.Size() == 10 && inlineMoved.Capacity() == 4);
+
+            InlineArray copy = heapMoved;
+            heapMoved.RemoveAt(2, 7);
+            heapMoved.ShrinkToFit();
+            EXPECT_TRUE(heapMoved.GetAllocatedSize() == 0 && heapMoved.Capacity() == 4);
+            EXPECT_TRUE(heapMoved.Size() == 3 && heapMoved[2].IsValid() && heapMoved[2].Value == 9);
+
+            // inline array moved over a spilled one releases the heap allocation
+            copy = MoveTemp(heapMoved);
+            EXPECT_TRUE(copy.GetAllocatedSize() == 0 && copy.Size() == 3 && copy[1].IsValid() && copy[1].Value == 1);
+            EXPECT_TRUE(SelfPointingElement::SLiveCount == 3);
         }
+        EXPECT_TRUE(SelfPointingElement::SLiveCount == 0);
 
-        for (DynamicArray<int>::ConstIterator iter = array.begin(); iter != array.end(); ++iter)
+        DynamicArray<OverAlignedElement, InlineAllocator<2>> alignedArray;
+        for (int32 i = 0; i < 20; i++)
         {
-            PL_INFO("", _T("item of array is: {0}"), *iter);
+            alignedArray.Add({ i });
+            EXPECT_TRUE(reinterpret_cast<uintptr_t>(alignedArray.Data()) % 64 == 0);
         }
+        EXPECT_TRUE(alignedArray[19].Value == 19);
+
+        DynamicArray<NoDefaultElement, InlineAllocator<2>> noDefaultArray;
+        noDefaultArray.Add(NoDefaultElement(1));
+        noDefaultArray.Add(NoDefaultElement(2));
+        noDefaultArray.Add(NoDefaultElement(3));
+        EXPECT_TRUE(noDefaultArray[2].Value == 3);
+
+        DynamicArray<std::string, InlineAllocator<2>> strings = { "first string longer than the small string buffer", "b" };
+        DynamicArray<std::string, InlineAllocator<2>> movedStrings = MoveTemp(strings);
+        EXPECT_TRUE(movedStrings[0] == "first string longer than the small string buffer" && strings.IsEmpty());
     }
 
     TEST(ContainerTest, BitArray_Base)
@@ -227,6 +504,208 @@ namespace Engine
         }
     }
 
+    TEST(ContainerTest, SparseArray_NonTrivial)
+    {
+        {
+            SparseArray<SelfPointingElement> array;
+            for (int32 i = 0; i < 100; i++)
+            {
+                array.Add(SelfPointingElement(i));
+            }
+            for (int32 i = 0; i < 100; i += 3)
+            {
+                array.RemoveAt(i);
+            }
+            for (int32 i = 100; i < 200; i++)
+            {
+                array.Add(SelfPointingElement(i));
+            }
+
+            SparseArray<SelfPointingElement> copy(array);
+            int32 count = 0;
+            for (const SelfPointingElement& element : copy)
+            {
+                EXPECT_TRUE(element.IsValid() && (element.Value % 3 != 0 || element.Value >= 100));
+                ++count;
+            }
+            EXPECT_TRUE(count == array.Size() && SelfPointingElement::SLiveCount == count * 2);
+
+            copy = array;
+            EXPECT_TRUE(SelfPointingElement::SLiveCount == count * 2);
+        }
+        EXPECT_TRUE(SelfPointingElement::SLiveCount == 0);
+
+        {
+            Set<SelfPointingElement, SelfPointingKeyFunc> set;
+            for (int32 i = 0; i < 100; i++)
+            {
+                set.Add(SelfPointingElement(i));
+            }
+            Set<SelfPointingElement, SelfPointingKeyFunc> copy(set);
+            EXPECT_TRUE(set.Remove(SelfPointingElement(5)));
+            EXPECT_TRUE(set.Size() == 99 && copy.Size() == 100);
+            EXPECT_TRUE(copy.Contains(SelfPointingElement(5)) && !set.Contains(SelfPointingElement(5)));
+            for (const SelfPointingElement& element : copy)
+            {
+                EXPECT_TRUE(element.IsValid());
+            }
+        }
+        EXPECT_TRUE(SelfPointingElement::SLiveCount == 0);
+    }
+
+    TEST(ContainerTest, SparseArray_Compact)
+    {
+        {
+            SparseArray<SelfPointingElement> array;
+            for (int32 i = 0; i < 100; i++)
+            {
+                array.Add(SelfPointingElement(i));
+            }
+            for (int32 i = 0; i < 100; i += 2)
+            {
+                array.RemoveAt(i);
+            }
+            // trailing free slots only
+            array.RemoveAt(99);
+            array.RemoveAt(97);
+            array.Shrink();
+            EXPECT_TRUE(array.GetMaxIndex() == 96 && array.Size() == 48 && array[95].Value == 95);
+
+            EXPECT_TRUE(array.Compact());
+            EXPECT_TRUE(array.GetMaxIndex() == 48 && array.Size() == 48 && array.GetFreeRatio() == 0.0f);
+            int32 sum = 0;
+            for (const SelfPointingElement& element : array)
+            {
+                EXPECT_TRUE(element.IsValid() && element.Value % 2 == 1);
+                sum += element.Value;
+            }
+            EXPECT_TRUE(sum == 48 * 48 && SelfPointingElement::SLiveCount == 48);
+            EXPECT_FALSE(array.Compact());
+
+            array.Shrink();
+            array.Add(SelfPointingElement(200));
+            EXPECT_TRUE(array[48].Value == 200 && array.Size() == 49);
+        }
+        EXPECT_TRUE(SelfPointingElement::SLiveCount == 0);
+
+        // free list stays linked after slots are reused and trimmed
+        SparseArray<int32> array;
+        for (int32 i = 0; i < 10; i++)
+        {
+            array.Add(i);
+        }
+        array.RemoveAt(3);
+        array.RemoveAt(8);
+        array.RemoveAt(9);
+        EXPECT_TRUE(array.Add(10) == 9);
+        array.Insert(3, 3);
+        array.RemoveAt(9);
+        array.Shrink();
+        EXPECT_TRUE(array.GetMaxIndex() == 8 && array.Size() == 8);
+        EXPECT_TRUE(array.Add(11) == 8 && array.Add(12) == 9);
+    }
+
+    TEST(ContainerTest, Set_Compact)
+    {
+        Set<int32> set;
+        for (int32 i = 0; i < 1000; i++)
+        {
+            set.Add(i);
+        }
+        for (int32 i = 0; i < 1000; i++)
+        {
+            if (i % 10 != 0)
+            {
+                set.Remove(i);
+            }
+        }
+        set.Compact();
+        set.Shrink();
+        int32 count = 0;
+        for (int32 element : set)
+        {
+            EXPECT_TRUE(element % 10 == 0);
+            ++count;
+        }
+        EXPECT_TRUE(count == 100 && set.Size() == 100);
+        for (int32 i = 0; i < 1000; i++)
+        {
+            EXPECT_TRUE(set.Contains(i) == (i % 10 == 0));
+        }
+        set.Add(5);
+        EXPECT_TRUE(set.Contains(5) && set.Remove(5) && !set.Contains(5));
+
+        Map<int32, int32, MapDefaultHashFunc<int32, int32>, CompactingSetAllocator> map;
+        for (int32 i = 0; i < 1000; i++)
+        {
+            map.Add(i, i * 2);
+        }
+        for (int32 i = 0; i < 900; i++)
+        {
+            map.Remove(i);
+        }
+        count = 0;
+        for (const auto& pair : map)
+        {
+            EXPECT_TRUE(pair.Value == pair.Key * 2 && pair.Key >= 900);
+            ++count;
+        }
+        EXPECT_TRUE(count == 100);
+        for (int32 i = 900; i < 1000; i++)
+        {
+            EXPECT_TRUE(*map.Find(i) == i * 2);
+        }
+        EXPECT_TRUE(map.Find(5) == nullptr);
+    }
+
+    TEST(ContainerTest, Set_IncrementalRehash)
+    {
+        using IncrementalSet = Set<int32, DefaultSetKeyFunc<int32>, IncrementalSetAllocator>;
+        IncrementalSet set;
+        for (int32 i = 0; i < 5000; i++)
+        {
+            set.Add(i);
+            // lookups during a migration see keys in old and new buckets
+            if (i % 97 == 0)
+            {
+                for (int32 j = 0; j <= i; j += 7)
+                {
+                    EXPECT_TRUE(set.Contains(j) == (j % 5 != 0 || j > i - 5));
+                }
+                EXPECT_FALSE(set.Contains(i + 1));
+            }
+            // multiples of 5 are removed shortly after they are added
+            if (i % 5 == 4)
+            {
+                EXPECT_TRUE(set.Remove(i - 4));
+            }
+        }
+
+        IncrementalSet copy(set);
+        IncrementalSet moved(MoveTemp(set));
+        EXPECT_TRUE(set.Size() == 0 && copy.Size() == moved.Size());
+        int32 count = 0;
+        for (int32 i = 0; i < 5000; i++)
+        {
+            const bool removed = i % 5 == 0;
+            EXPECT_TRUE(copy.Contains(i) != removed && moved.Contains(i) != removed);
+            count += removed ? 0 : 1;
+        }
+        EXPECT_TRUE(count == copy.Size());
+
+        Map<int32, int32, MapDefaultHashFunc<int32, int32>, IncrementalSetAllocator> map;
+        for (int32 i = 0; i < 3000; i++)
+        {
+            map.Add(i, i);
+            EXPECT_TRUE(map.FindOrAdd(i / 2, -1) == i / 2);
+        }
+        map.Compact();
+        for (int32 i = 0; i < 3000; i++)
+        {
+            EXPECT_TRUE(*map.Find(i) == i);
+        }
+    }
+
     TEST(ContainerTest, Set_Base)
     {
         Set<int32> set;
@@ -278,6 +757,71 @@ namespace Engine
         EXPECT_TRUE(set.Contains(item));
     }
 
+    struct HashedPoint
+    {
+        int32 X;
+        int32 Y;
+
+        bool operator== (const HashedPoint& other) const { return X == other.X && Y == other.Y; }
+
+        friend uint32 GetHashCode(const HashedPoint& point)
+        {
+            return HashValues(point.X, point.Y);
+        }
+    };
+
+    struct UnhashedPoint
+    {
+        int32 X;
+    };
+
+    static_assert(Hashable<int32> && Hashable<TestA*> && Hashable<std::string> && Hashable<HashedPoint>);
+    static_assert(!Hashable<UnhashedPoint>);
+
+    TEST(ContainerTest, Hash_Content)
+    {
+        // sequential keys must differ in the low bits a power of two bucket mask keeps
+        Set<uint32> lowBits;
+        for (uint64 index = 0; index < 1024; ++index)
+        {
+            lowBits.Add(GetHashCode(index << 12) & 1023);
+        }
+        EXPECT_TRUE(lowBits.Size() > 512);
+
+        std::string text = "polaris engine";
+        EXPECT_TRUE(GetHashCode(text) == GetHashCode(std::string_view(text)));
+        EXPECT_TRUE(GetHashCode(text) == GetHashCode(std::string("polaris engine")));
+        EXPECT_TRUE(GetHashCode(0.0f) == GetHashCode(-0.0f) && GetHashCode(1.0) != GetHashCode(2.0));
+        EXPECT_TRUE(HashValues(1, 2) != HashValues(2, 1));
+
+        // every length takes its own path through HashBytes, all must hash differently
+        uint8 bytes[128];
+        for (int32 index = 0; index < 128; ++index)
+        {
+            bytes[index] = static_cast<uint8>(index * 7);
+        }
+        Set<uint64> byteHashes;
+        for (size_t length = 0; length <= 128; ++length)
+        {
+            byteHashes.Add(HashBytes(bytes, length));
+        }
+        EXPECT_TRUE(byteHashes.Size() == 129);
+        EXPECT_TRUE(HashBytes(bytes, 100) == HashBytes(bytes, 100) && HashBytes(bytes, 100, 1) != HashBytes(bytes, 100));
+
+        const int32 values[] = { 1, 2, 3 };
+        const int32 sameValues[] = { 1, 2, 3 };
+        const HashedPoint points[] = { { 1, 2 }, { 3, 4 } };
+        EXPECT_TRUE(GetHashCode(std::span(values)) == GetHashCode(std::span(sameValues)));
+        EXPECT_TRUE(GetHashCode(std::span(values)) != GetHashCode(std::span(values).first(2)));
+        EXPECT_TRUE(GetHashCode(std::span(points)) != GetHashCode(std::span(points).first(1)));
+
+        Set<HashedPoint> set;
+        set.Add({ 1, 2 });
+        set.Add({ 2, 1 });
+        set.Add({ 1, 2 });
+        EXPECT_TRUE(set.Size() == 2 && set.Contains(HashedPoint{ 2, 1 }) && !set.Contains(HashedPoint{ 2, 2 }));
+    }
+
     TEST(ContainerTest, Set_Iterator)
     {
         Set<int32> kSet{ 4, 6, 9, 3 };
@@ -306,6 +850,260 @@ namespace Engine
         EXPECT_TRUE(map.Size() == 0 && map2.Size() == 1);
         map2.Clear(2);
         EXPECT_TRUE(map2.Size() == 0);
+
+        // buckets stay usable after clear
+        for (int32 slack : { 0, 2, 100 })
+        {
+            for (int32 i = 0; i < 50; i++)
+            {
+                map2.Add(i, (float)i);
+            }
+            map2.Clear(slack);
+            EXPECT_TRUE(map2.Size() == 0 && map2.Find(1) == nullptr);
+        }
+        map2.Add(3, 3.5f);
+        EXPECT_TRUE(*map2.Find(3) == 3.5f && map2.Size() == 1);
+    }
+
+    struct StdStringKeyFunc : DefaultSetKeyFunc<std::string>
+    {
+        static uint32 GetHashCode(const std::string& key) { return (uint32)std::hash<std::string>()(key); }
+    };
+
+    struct StdStringMapKeyFunc : MapDefaultHashFunc<std::string, std::string>
+    {
+        static uint32 GetHashCode(const std::string& key) { return (uint32)std::hash<std::string>()(key); }
+    };
+
+    /** counts hashing to check each call probes once */
+    struct CountingKeyFunc : MapDefaultHashFunc<int32, int32>
+    {
+        static inline int32 SHashCount = 0;
+
+        static uint32 GetHashCode(const int32& key)
+        {
+            ++SHashCount;
+            return Engine::GetHashCode(key);
+        }
+    };
+
+    struct CountingSetKeyFunc : DefaultSetKeyFunc<int32>
+    {
+        static inline int32 SHashCount = 0;
+
+        static uint32 GetHashCode(const int32& key)
+        {
+            ++SHashCount;
+            return HashValue(key);
+        }
+    };
+
+    struct NameKey
+    {
+        std::string Name;
+
+        bool operator== (const NameKey& other) const { return Name == other.Name; }
+
+        bool operator== (std::string_view view) const { return Name == view; }
+    };
+
+    inline uint32 GetHashCode(const NameKey& key)
+    {
+        return GetHashCode(key.Name);
+    }
+
+    template <>
+    struct THeterogeneousKey<NameKey, std::string_view>
+    {
+        static constexpr bool Value = true;
+
+        static uint32 GetHashCode(const std::string_view& key)
+        {
+            return HashValue(key);
+        }
+    };
+
+    TEST(ContainerTest, Set_ByHash)
+    {
+        Set<int32> set = { 1, 2, 3 };
+        const uint32 hash = GetHashCode(2);
+        EXPECT_TRUE(set.Contains(2, hash) && !set.Contains(4, GetHashCode(4)));
+        EXPECT_TRUE(*set.FindByHash(hash, 2) == 2 && set.FindByHash(GetHashCode(5), 5) == nullptr);
+
+        EXPECT_TRUE(set.AddByHash(GetHashCode(4), 4) == 4 && set.Size() == 4);
+        EXPECT_TRUE(set.FindOrAddByHash(hash, 2) == 2 && set.Size() == 4);
+        EXPECT_TRUE(set.FindOrAdd(5) == 5 && set.Size() == 5);
+
+        Set<NameKey> names = { { "alpha" }, { "beta" } };
+        EXPECT_TRUE(names.Contains(std::string_view("beta")) && !names.Contains(std::string_view("gamma")));
+        EXPECT_TRUE(names.Find(std::string_view("alpha"))->Name == "alpha");
+        EXPECT_TRUE(names.Remove(std::string_view("alpha")) && names.Size() == 1);
+    }
+
+    TEST(ContainerTest, Map_ByHash)
+    {
+        Map<int32, int32, CountingKeyFunc> map;
+        for (int32 i = 0; i < 100; i++)
+        {
+            map.Add(i, i * 2);
+        }
+
+        CountingKeyFunc::SHashCount = 0;
+        EXPECT_TRUE(map.FindOrAdd(5, 0) == 10);
+        EXPECT_TRUE(map.FindOrAdd(200, 7) == 7 && map.Size() == 101);
+        EXPECT_TRUE(CountingKeyFunc::SHashCount == 2);
+
+        const uint32 hash = GetHashCode(300);
+        CountingKeyFunc::SHashCount = 0;
+        map.AddByHash(hash, 300, 1);
+        EXPECT_TRUE(map.FindOrAddByHash(hash, 300, 2) == 1);
+        EXPECT_TRUE(map.Contains(300, hash));
+#ifndef DEBUG
+        // debug builds verify the given hash
+        EXPECT_TRUE(CountingKeyFunc::SHashCount == 0);
+#endif
+        EXPECT_TRUE(*map.FindByHash(hash, 300) == 1 && map.FindByHash(GetHashCode(301), 301) == nullptr);
+
+        Map<NameKey, int32> names;
+        names.Add({ "alpha" }, 1);
+        names.Add({ "beta" }, 2);
+        const std::string_view view = "beta";
+        EXPECT_TRUE(*names.Find(view) == 2 && names.Find(std::string_view("gamma")) == nullptr);
+        EXPECT_TRUE(names.Contains(view, GetHashCode(NameKey{ "beta" })));
+        EXPECT_TRUE(names.Remove(view) && !names.Contains(view));
+    }
+
+    /** owns a heap block like a string, counts blocks made by construct and copy */
+    struct AllocCountedElement
+    {
+        static inline int32 SAllocCount = 0;
+
+        explicit AllocCountedElement(int32 value = 0) : Value(value), Data(Allocate()) {}
+
+        AllocCountedElement(const AllocCountedElement& other) : Value(other.Value), Data(Allocate()) {}
+
+        AllocCountedElement(AllocCountedElement&& other) noexcept : Value(other.Value), Data(other.Data) { other.Data = nullptr; }
+
+        AllocCountedElement& operator= (const AllocCountedElement& other)
+        {
+            Memory::Free(Data);
+            Value = other.Value;
+            Data = Allocate();
+            return *this;
+        }
+
+        AllocCountedElement& operator= (AllocCountedElement&& other) noexcept
+        {
+            std::swap(Data, other.Data);
+            Value = other.Value;
+            return *this;
+        }
+
+        ~AllocCountedElement() { Memory::Free(Data); }
+
+        bool operator== (const AllocCountedElement& other) const { return Value == other.Value; }
+
+        static void* Allocate()
+        {
+            ++SAllocCount;
+            return Memory::Malloc(32);
+        }
+
+        int32 Value;
+        void* Data;
+    };
+
+    inline uint32 GetHashCode(const AllocCountedElement& element)
+    {
+        return GetHashCode(element.Value);
+    }
+
+    TEST(ContainerTest, Set_Emplace)
+    {
+        Set<AllocCountedElement> set;
+        AllocCountedElement::SAllocCount = 0;
+        for (int32 i = 0; i < 100; i++)
+        {
+            set.Add(AllocCountedElement(i));
+        }
+        EXPECT_TRUE(AllocCountedElement::SAllocCount == 100);
+
+        // built in the slot, one allocation per insert
+        AllocCountedElement::SAllocCount = 0;
+        for (int32 i = 100; i < 200; i++)
+        {
+            EXPECT_TRUE(set.Emplace(i).Value == i);
+        }
+        EXPECT_TRUE(AllocCountedElement::SAllocCount == 100 && set.Size() == 200);
+
+        // an equal element is replaced by the new one
+        AllocCountedElement::SAllocCount = 0;
+        AllocCountedElement& element = set.Emplace(5);
+        EXPECT_TRUE(AllocCountedElement::SAllocCount == 1 && set.Size() == 200);
+        EXPECT_TRUE(&element == set.Find(AllocCountedElement(5)) && element.Data != nullptr);
+
+        // emplacing a present key never grows the table, a rehash would hash every element again
+        Set<int32, CountingSetKeyFunc> counted;
+        Set<int32, CountingSetKeyFunc, IncrementalSetAllocator> incremental;
+        for (int32 i = 0; i < 300; i++)
+        {
+            counted.Add(i);
+            incremental.Add(i);
+            CountingSetKeyFunc::SHashCount = 0;
+            EXPECT_TRUE(counted.Emplace(i) == i && incremental.Emplace(i) == i);
+            EXPECT_TRUE(CountingSetKeyFunc::SHashCount == 2);
+        }
+        for (int32 i = 300; i < 600; i++)
+        {
+            EXPECT_TRUE(counted.Emplace(i) == i && incremental.Emplace(i) == i);
+        }
+        for (int32 i = 0; i < 600; i++)
+        {
+            EXPECT_TRUE(counted.Contains(i) && incremental.Contains(i));
+        }
+        EXPECT_TRUE(counted.Size() == 600 && incremental.Size() == 600);
+
+        Set<std::string, StdStringKeyFunc> strings;
+        strings.Emplace(40, 'x');
+        strings.Emplace("abc");
+        EXPECT_TRUE(strings.Size() == 2 && strings.Contains(std::string(40, 'x')));
+    }
+
+    TEST(ContainerTest, Map_Emplace)
+    {
+        Map<int32, AllocCountedElement> map;
+        AllocCountedElement::SAllocCount = 0;
+        for (int32 i = 0; i < 100; i++)
+        {
+            map.Add(i, AllocCountedElement(i));
+        }
+        EXPECT_TRUE(AllocCountedElement::SAllocCount == 100);
+
+        AllocCountedElement::SAllocCount = 0;
+        for (int32 i = 100; i < 200; i++)
+        {
+            EXPECT_TRUE(map.Emplace(i, i * 2).Value == i * 2);
+        }
+        EXPECT_TRUE(AllocCountedElement::SAllocCount == 100 && map.Size() == 200);
+
+        // overwrite and find only allocate the argument
+        AllocCountedElement::SAllocCount = 0;
+        map.Add(5, AllocCountedElement(-5));
+        EXPECT_TRUE(map.FindOrAdd(6, AllocCountedElement(-6)).Value == 6);
+        EXPECT_TRUE(map.FindOrAdd(300, AllocCountedElement(300)).Value == 300);
+        EXPECT_TRUE(AllocCountedElement::SAllocCount == 3 && map.Find(5)->Value == -5);
+
+        AllocCountedElement value(7);
+        AllocCountedElement::SAllocCount = 0;
+        map.Add(7, value);
+        EXPECT_TRUE(AllocCountedElement::SAllocCount == 1 && map.Find(7)->Value == 7);
+
+        Map<std::string, std::string, StdStringMapKeyFunc> strings;
+        std::string key(40, 'k');
+        strings.Emplace(MoveTemp(key), 40, 'v');
+        EXPECT_TRUE(key.empty() && *strings.Find(std::string(40, 'k')) == std::string(40, 'v'));
+        strings.Emplace(std::string(40, 'k'), "short");
+        EXPECT_TRUE(strings.Size() == 1 && *strings.Find(std::string(40, 'k')) == "short");
     }
 
     TEST(ContainerTest, Map_Iterator)
@@ -320,5 +1118,309 @@ namespace Engine
         {
             PL_INFO("", _T("key:{0} value:{1}"), iter->Key, iter->Value);
         }
+
+        const Map<int32, float>& constMap = map;
+        int32 count = 0;
+        for (const auto& pair : constMap)
+        {
+            count += constMap.Contains(pair.Key) ? 1 : 0;
+        }
+        EXPECT_TRUE(count == 3);
+    }
+
+    TEST(ContainerTest, FlatSet_Base)
+    {
+        FlatSet<int32> set = { 1, 2, -3, 2 };
+        EXPECT_TRUE(set.Size() == 3 && set.Capacity() == 16);
+        EXPECT_TRUE(set.Contains(1) && set.Contains(2) && set.Contains(-3));
+        EXPECT_FALSE(set.Contains(0));
+        EXPECT_TRUE(*set.Find(-3) == -3 && set.Find(4) == nullptr);
+
+        FlatSet<int32> set2 = MoveTemp(set);
+        EXPECT_TRUE(set.Size() == 0 && set.Capacity() == 0 && !set.Contains(1));
+        EXPECT_TRUE(set2.Remove(2) && !set2.Remove(2));
+        EXPECT_TRUE(set2.Size() == 2 && set2.Contains(1) && set2.Contains(-3));
+
+        // grows past several rehashes, then removes leave tombstones reused by later adds
+        FlatSet<int32> large;
+        for (int32 i = 0; i < 10000; i++)
+        {
+            large.Add(i * 16);
+        }
+        EXPECT_TRUE(large.Size() == 10000 && large.Capacity() * 7 / 8 >= 10000);
+        for (int32 i = 0; i < 10000; i += 2)
+        {
+            EXPECT_TRUE(large.Remove(i * 16));
+        }
+        const int32 capacity = large.Capacity();
+        for (int32 round = 0; round < 20; round++)
+        {
+            for (int32 i = 0; i < 5000; i++)
+            {
+                large.Add(-i - round * 5000 - 1);
+            }
+            for (int32 i = 0; i < 5000; i++)
+            {
+                large.Remove(-i - round * 5000 - 1);
+            }
+        }
+        EXPECT_TRUE(large.Size() == 5000 && large.Capacity() == capacity);
+        for (int32 i = 0; i < 10000; i++)
+        {
+            EXPECT_TRUE(large.Contains(i * 16) == (i % 2 == 1));
+        }
+
+        large.Clear(100);
+        EXPECT_TRUE(large.IsEmpty() && large.Capacity() == 128 && !large.Contains(16));
+        large.Reserve(1000);
+        EXPECT_TRUE(large.Capacity() == 2048);
+        large.Clear();
+        EXPECT_TRUE(large.Capacity() == 0);
+    }
+
+    TEST(ContainerTest, FlatSet_NonTrivial)
+    {
+        {
+            FlatSet<SelfPointingElement, SelfPointingKeyFunc> set;
+            for (int32 i = 0; i < 100; i++)
+            {
+                set.Add(SelfPointingElement(i));
+            }
+            FlatSet<SelfPointingElement, SelfPointingKeyFunc> copy(set);
+            EXPECT_TRUE(set.Remove(SelfPointingElement(5)));
+            EXPECT_TRUE(set.Size() == 99 && copy.Size() == 100 && SelfPointingElement::SLiveCount == 199);
+            EXPECT_TRUE(copy.Contains(SelfPointingElement(5)) && !set.Contains(SelfPointingElement(5)));
+            for (const SelfPointingElement& element : copy)
+            {
+                EXPECT_TRUE(element.IsValid());
+            }
+
+            copy = set;
+            EXPECT_TRUE(copy.Size() == 99 && SelfPointingElement::SLiveCount == 198);
+        }
+        EXPECT_TRUE(SelfPointingElement::SLiveCount == 0);
+
+        FlatSet<std::string, StdStringKeyFunc> strings;
+        for (int32 i = 0; i < 1000; i++)
+        {
+            strings.Add(std::to_string(i) + " longer than the small string buffer");
+        }
+        EXPECT_TRUE(strings.Size() == 1000 && strings.Contains(std::string("999 longer than the small string buffer")));
+        EXPECT_FALSE(strings.Contains(std::string("1000 longer than the small string buffer")));
+    }
+
+    TEST(ContainerTest, FlatSet_Iterator)
+    {
+        FlatSet<int32> set{ 4, 6, 9, 3 };
+        int32 count = 0;
+        for (FlatSet<int32>::ConstIterator iter = set.begin(); iter != set.end(); ++iter)
+        {
+            EXPECT_TRUE(set.Contains(*iter));
+            count++;
+        }
+        EXPECT_TRUE(count == 4);
+
+        FlatSet<int32> empty;
+        EXPECT_TRUE(empty.begin() == empty.end());
+    }
+
+    TEST(ContainerTest, FlatMap_Base)
+    {
+        FlatMap<int32, float> map = {{1, 1.5f}, {2, 2.5f}, {1, 1.6f}};
+        EXPECT_TRUE(*(map.Find(1)) == 1.6f);
+        EXPECT_TRUE(*(map.Find(2)) == 2.5f);
+
+        float& v = map.FindOrAdd(1, 1.8f);
+        EXPECT_TRUE(v == 1.6f && map.FindOrAdd(3, 3.5f) == 3.5f);
+
+        EXPECT_FALSE(map.Remove(1111));
+        EXPECT_TRUE(map.Remove(1));
+        EXPECT_TRUE(map.Find(1) == nullptr && map.Size() == 2);
+
+        FlatMap<int32, float> map2 = MoveTemp(map);
+        EXPECT_TRUE(*map2.Find(2) == 2.5f);
+        EXPECT_TRUE(map.Size() == 0 && map2.Size() == 2);
+        float sum = 0.0f;
+        for (const auto& pair : map2)
+        {
+            sum += pair.Value;
+        }
+        EXPECT_TRUE(sum == 6.0f);
+        map2.Clear(2);
+        EXPECT_TRUE(map2.IsEmpty());
+
+        FlatMap<std::string, std::string, StdStringMapKeyFunc> strings;
+        for (int32 i = 0; i < 1000; i++)
+        {
+            strings.Add(std::to_string(i), std::to_string(i * 2) + " longer than the small string buffer");
+        }
+        EXPECT_TRUE(*strings.Find("999") == "1998 longer than the small string buffer");
+        std::string key = "5";
+        std::string value = "moved";
+        strings.Add(MoveTemp(key), MoveTemp(value));
+        EXPECT_TRUE(*strings.Find("5") == "moved" && strings.Size() == 1000);
+    }
+
+    TEST(ContainerTest, SortedFlatMap_Base)
+    {
+        SortedFlatMap<int32, float> map = {{5, 5.5f}, {1, 1.5f}, {3, 3.5f}, {1, 1.6f}};
+        EXPECT_TRUE(map.Size() == 3 && *map.Find(1) == 1.6f && *map.Find(3) == 3.5f);
+        EXPECT_TRUE(map.Find(2) == nullptr && !map.Contains(6) && map.IndexOf(5) == 2);
+
+        EXPECT_TRUE(map.FindOrAdd(1, 1.8f) == 1.6f && map.FindOrAdd(2, 2.5f) == 2.5f);
+        map.Add(0, 0.5f);
+        map.Add(5, 5.6f);
+        EXPECT_TRUE(map.Size() == 5 && *map.Find(5) == 5.6f);
+        for (int32 i = 1; i < map.Size(); i++)
+        {
+            EXPECT_TRUE(map.GetKeys()[i - 1] < map.GetKeys()[i]);
+        }
+
+        EXPECT_FALSE(map.Remove(4));
+        EXPECT_TRUE(map.Remove(0) && map.Size() == 4 && !map.Contains(0));
+
+        float sum = 0.0f;
+        int32 lastKey = -1;
+        for (auto pair : map)
+        {
+            EXPECT_TRUE(pair.Key > lastKey);
+            lastKey = pair.Key;
+            pair.Value += 1.0f;
+        }
+        const SortedFlatMap<int32, float>& constMap = map;
+        for (auto pair : constMap)
+        {
+            sum += pair.Value;
+        }
+        EXPECT_TRUE(sum == 1.6f + 2.5f + 3.5f + 5.6f + 4.0f);
+
+        // bulk build keeps the last of equal keys, transparent less finds by string view
+        DynamicArray<Pair<std::string, int32>> pairs;
+        for (int32 i = 999; i >= 0; i--)
+        {
+            pairs.Add(Pair<std::string, int32>(std::to_string(i % 500), i));
+        }
+        SortedFlatMap<std::string, int32> strings(MoveTemp(pairs));
+        EXPECT_TRUE(strings.Size() == 500 && *strings.Find(std::string_view("7")) == 7);
+        EXPECT_TRUE(strings.Find(std::string_view("500")) == nullptr);
+        strings.Clear();
+        EXPECT_TRUE(strings.IsEmpty() && strings.begin() == strings.end());
+    }
+
+    template <bool ReadMostly>
+    static void TestConcurrentMapBase()
+    {
+        ConcurrentMap<int32, std::string, ReadMostly, 4> map;
+        EXPECT_TRUE(map.Size() == 0 && !map.Contains(1));
+        map.Add(1, std::string("one"));
+        map.Add(2, std::string("two"));
+        EXPECT_TRUE(map.FindOrAdd(2, std::string("other")) == "two");
+        EXPECT_TRUE(map.FindOrAdd(3, std::string("three")) == "three");
+        map.Add(1, std::string("uno"));
+
+        std::string value;
+        EXPECT_TRUE(map.Find(1, value) && value == "uno");
+        EXPECT_TRUE(!map.Find(4, value) && map.Size() == 3);
+
+        for (int32 i = 10; i < 1000; i++)
+        {
+            map.Add(i, std::to_string(i));
+        }
+        int32 count = 0;
+        map.ForEach([&count](const int32& key, const std::string& value)
+        {
+            count += (key < 10 || value == std::to_string(key)) ? 1 : 0;
+        });
+        EXPECT_TRUE(count == 993 && map.Size() == 993);
+
+        map.Clear();
+        EXPECT_TRUE(map.Size() == 0 && !map.Contains(1));
+    }
+
+    TEST(ContainerTest, ConcurrentMap_Base)
+    {
+        TestConcurrentMapBase<false>();
+        TestConcurrentMapBase<true>();
+
+        ConcurrentMap<int32, int32> locked(100);
+        locked.Add(5, 50);
+        EXPECT_TRUE(locked.Remove(5) && !locked.Remove(5) && locked.Size() == 0);
+
+        // read mostly values stay in place while the table grows
+        ConcurrentMap<int32, int32, true> readMostly;
+        const int32* first = readMostly.Find(0);
+        readMostly.Add(0, 7);
+        first = readMostly.Find(0);
+        for (int32 i = 1; i < 10000; i++)
+        {
+            readMostly.Add(i, i);
+        }
+        EXPECT_TRUE(first == readMostly.Find(0) && *first == 7);
+    }
+
+    /** threads intern overlapping keys, every thread must see the value of the first add */
+    template <bool ReadMostly>
+    static void TestConcurrentMapThreads()
+    {
+        constexpr int32 kThreadCount = 8;
+        constexpr int32 kKeyCount = 20000;
+        ConcurrentMap<int32, int32, ReadMostly> map;
+        std::atomic<int32> mismatchCount{ 0 };
+        std::vector<std::thread> threads;
+        for (int32 thread = 0; thread < kThreadCount; thread++)
+        {
+            threads.emplace_back([&map, &mismatchCount, thread]()
+            {
+                for (int32 i = 0; i < kKeyCount; i++)
+                {
+                    const int32 key = (i * 7 + thread * 1000) % kKeyCount;
+                    const int32 value = map.FindOrAdd(key, key * 3);
+                    int32 found = -1;
+                    if (value != key * 3 || !map.Find(key, found) || found != key * 3)
+                    {
+                        ++mismatchCount;
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        EXPECT_TRUE(mismatchCount == 0 && map.Size() == kKeyCount);
+    }
+
+    TEST(ContainerTest, ConcurrentMap_Threads)
+    {
+        TestConcurrentMapThreads<false>();
+        TestConcurrentMapThreads<true>();
+    }
+
+    TEST(ContainerTest, ArenaAllocator)
+    {
+        MemMark mark;
+        const size_t usedBytes = MemStack::Get().GetUsedBytes();
+
+        DynamicArray<int32, ArenaAllocator> array;
+        for (int32 i = 0; i < 1000; i++)
+        {
+            array.Add(i);
+        }
+        EXPECT_TRUE(array.Size() == 1000 && array[999] == 999);
+
+        SparseArray<int32, ArenaAllocator> sparseArray;
+        sparseArray.Add(1);
+        sparseArray.Add(2);
+        sparseArray.RemoveAt(0);
+        EXPECT_TRUE(sparseArray.Size() == 1 && sparseArray[1] == 2);
+
+        Set<int32, DefaultSetKeyFunc<int32>, ArenaSetAllocator> set;
+        for (int32 i = 0; i < 100; i++)
+        {
+            set.Add(i);
+        }
+        EXPECT_TRUE(set.Size() == 100 && set.Contains(42));
+
+        EXPECT_TRUE(MemStack::Get().GetUsedBytes() > usedBytes);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,575 @@
+#include "gtest/gtest.h"
+#include "core_minimal_public.hpp"
+#include "memory/ansi_c_malloc.hpp"
+#include "memory/binned_malloc.hpp"
+#include "memory/mem_stack.hpp"
+#include "memory/frame_allocator.hpp"
+#include "memory/object_pool.hpp"
+#include "memory/memory_tracker.hpp"
+#include "memory/simd_memory.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace Engine
+{
+    static bool IsFilledWith(const void* ptr, size_t size, uint8 value)
+    {
+        const uint8* bytes = (const uint8*)ptr;
+        for (size_t i = 0; i < size; i++)
+        {
+            if (bytes[i] != value)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    TEST(AnsiCMalloc, Alignment)
+    {
+        for (EAnsiMallocMode mode : { EAnsiMallocMode::Header, EAnsiMallocMode::Aligned })
+        {
+            AnsiCMalloc malloc(mode);
+            EXPECT_TRUE(malloc.GetMode() == mode);
+            for (uint32 alignment = 1; alignment <= 4096; alignment <<= 1)
+            {
+                void* ptr = malloc.Malloc(100, alignment);
+                EXPECT_TRUE(((uintptr_t)ptr & (alignment - 1)) == 0);
+                EXPECT_TRUE(malloc.GetAllocationSize(ptr) >= 100);
+                Memory::Memset(ptr, 0xcd, 100);
+
+                ptr = malloc.Realloc(ptr, 1000, alignment);
+                EXPECT_TRUE(((uintptr_t)ptr & (alignment - 1)) == 0);
+                EXPECT_TRUE(IsFilledWith(ptr, 100, 0xcd));
+                malloc.Free(ptr);
+            }
+        }
+    }
+
+    TEST(BinnedMalloc, Alignment)
+    {
+        BinnedMalloc malloc;
+        for (uint32 alignment = 1; alignment <= 4096; alignment <<= 1)
+        {
+            for (size_t size : { 1, 24, 100, 1000, 8192, 10000, 100000 })
+            {
+                void* ptr = malloc.Malloc(size, alignment);
+                EXPECT_TRUE(ptr != nullptr);
+                EXPECT_TRUE(((uintptr_t)ptr & (alignment - 1)) == 0);
+                Memory::Memset(ptr, 0xcd, size);
+                malloc.Free(ptr);
+            }
+        }
+    }
+
+    TEST(BinnedMalloc, Realloc)
+    {
+        BinnedMalloc malloc;
+        void* ptr = malloc.Realloc(nullptr, 16, 16);
+        Memory::Memset(ptr, 0xab, 16);
+
+        size_t size = 16;
+        for (size_t newSize : { 24, 200, 9000, 70000, 300, 8 })
+        {
+            ptr = malloc.Realloc(ptr, newSize, 16);
+            EXPECT_TRUE(IsFilledWith(ptr, Math::Min(size, newSize), 0xab));
+            Memory::Memset(ptr, 0xab, newSize);
+            size = newSize;
+        }
+
+        EXPECT_TRUE(malloc.Realloc(ptr, 0, 16) == nullptr);
+    }
+
+    TEST(BinnedMalloc, ReuseSlot)
+    {
+        BinnedMalloc malloc;
+        DynamicArray<void*> ptrs;
+        for (int32 i = 0; i < 10000; i++)
+        {
+            ptrs.Add(malloc.Malloc(48, 16));
+        }
+
+        for (void* ptr : ptrs)
+        {
+            malloc.Free(ptr);
+        }
+
+        void* ptr = malloc.Malloc(48, 16);
+        bool reused = false;
+        for (void* oldPtr : ptrs)
+        {
+            reused |= oldPtr == ptr;
+        }
+        EXPECT_TRUE(reused);
+        malloc.Free(ptr);
+        malloc.ClearCurrentThreadTLS();
+    }
+
+    TEST(BinnedMalloc, MultiThread)
+    {
+        BinnedMalloc malloc;
+        std::vector<void*> shared(4000, nullptr);
+        std::vector<std::thread> threads;
+        for (int32 t = 0; t < 4; t++)
+        {
+            threads.emplace_back([&malloc, &shared, t]()
+            {
+                for (int32 round = 0; round < 20; round++)
+                {
+                    for (int32 i = t * 1000; i < (t + 1) * 1000; i++)
+                    {
+                        size_t size = 8 + (i * 31 + round) % 2000;
+                        shared[i] = malloc.Malloc(size, 16);
+                        Memory::Memset(shared[i], (uint8)i, size);
+                    }
+
+                    for (int32 i = t * 1000; i < (t + 1) * 1000; i++)
+                    {
+                        size_t size = 8 + (i * 31 + round) % 2000;
+                        EXPECT_TRUE(IsFilledWith(shared[i], size, (uint8)i));
+                        malloc.Free(shared[i]);
+                    }
+                }
+                malloc.ClearCurrentThreadTLS();
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    TEST(BinnedMalloc, FlushOnThreadExit)
+    {
+        BinnedMalloc malloc;
+        void* threadPtr = nullptr;
+        // the thread leaves without ClearCurrentThreadTLS, the slot it cached must still come back
+        std::thread([&malloc, &threadPtr]()
+        {
+            threadPtr = malloc.Malloc(48, 16);
+            malloc.Free(threadPtr);
+        }).join();
+
+        // more than a block of slots, a slot stuck in the cache of the dead thread is never handed out
+        std::vector<void*> ptrs;
+        for (int32 i = 0; i < 2000; i++)
+        {
+            ptrs.push_back(malloc.Malloc(48, 16));
+        }
+        EXPECT_TRUE(std::find(ptrs.begin(), ptrs.end(), threadPtr) != ptrs.end());
+        for (void* ptr : ptrs)
+        {
+            malloc.Free(ptr);
+        }
+        malloc.ClearCurrentThreadTLS();
+    }
+
+    template <typename MallocType, typename... Args>
+    static void TestResizeInPlace(Args... args)
+    {
+        MallocType malloc(args...);
+        uint8* ptr = (uint8*)malloc.Malloc(100, 16);
+        const size_t allocationSize = malloc.GetAllocationSize(ptr);
+        EXPECT_TRUE(allocationSize >= 100);
+        EXPECT_TRUE(malloc.TryResizeInPlace(ptr, allocationSize));
+        EXPECT_FALSE(malloc.TryResizeInPlace(ptr, allocationSize + 1));
+
+        Memory::Memset(ptr, 0x5a, allocationSize);
+        EXPECT_TRUE(malloc.Realloc(ptr, allocationSize, 16) == ptr);
+
+        for (uint32 alignment : { 8, 64, 256 })
+        {
+            ptr = (uint8*)malloc.Realloc(ptr, allocationSize * 4, alignment);
+            EXPECT_TRUE(((uintptr_t)ptr & (alignment - 1)) == 0);
+            EXPECT_TRUE(IsFilledWith(ptr, allocationSize, 0x5a));
+        }
+        malloc.Free(ptr);
+    }
+
+    TEST(AnsiCMalloc, ResizeInPlace)
+    {
+        TestResizeInPlace<AnsiCMalloc>(EAnsiMallocMode::Header);
+        TestResizeInPlace<AnsiCMalloc>(EAnsiMallocMode::Aligned);
+    }
+
+    TEST(BinnedMalloc, ResizeInPlace)
+    {
+        TestResizeInPlace<BinnedMalloc>();
+    }
+
+    TEST(PlatformMemory, ReserveCommit)
+    {
+        const size_t pageSize = PlatformMemory::GetPageSize();
+        const size_t size = 1024 * 1024;
+        for (EHugePage hugePage : { EHugePage::None, EHugePage::Transparent })
+        {
+            uint8* ptr = (uint8*)PlatformMemory::Reserve(size, hugePage);
+            EXPECT_TRUE(ptr != nullptr);
+            EXPECT_TRUE((uintptr_t)ptr % PlatformMemory::GetBinnedAllocationGranularity() == 0);
+
+            EXPECT_TRUE(PlatformMemory::Commit(ptr + pageSize, pageSize * 4));
+            Memory::Memset(ptr + pageSize, 0xcd, pageSize * 4);
+            EXPECT_TRUE(IsFilledWith(ptr + pageSize, pageSize * 4, 0xcd));
+
+            EXPECT_TRUE(PlatformMemory::Decommit(ptr + pageSize, pageSize * 4));
+            EXPECT_TRUE(PlatformMemory::Commit(ptr + pageSize, pageSize));
+            EXPECT_TRUE(IsFilledWith(ptr + pageSize, pageSize, 0));
+
+            PlatformMemory::Release(ptr, size, hugePage);
+        }
+    }
+
+    TEST(MemStack, MarkPop)
+    {
+        MemStack stack;
+        {
+            MemMark mark(stack);
+            uint8* first = (uint8*)stack.Alloc(100, 16);
+            EXPECT_TRUE(((uintptr_t)first & 15) == 0);
+            EXPECT_TRUE(stack.TryGrow(first, 100, 200));
+            EXPECT_FALSE(stack.TryGrow(first, 100, 300));
+
+            void* second = stack.Alloc(8, 64);
+            EXPECT_TRUE(((uintptr_t)second & 63) == 0);
+            EXPECT_FALSE(stack.TryGrow(first, 200, 300));
+            {
+                MemMark innerMark(stack);
+                stack.Alloc(MemStack::kChunkSize * 2, 16);
+                stack.Alloc(MemStack::kChunkSize / 2, 16);
+                stack.Alloc(MemStack::kChunkSize / 2, 16);
+                EXPECT_TRUE(stack.GetMarkCount() == 2);
+            }
+            EXPECT_TRUE(stack.GetUsedBytes() == MemStack::kChunkSize);
+
+            // memory after the inner mark is reused
+            void* third = stack.Alloc(8, 64);
+            EXPECT_TRUE((uint8*)third == (uint8*)second + 64);
+        }
+        EXPECT_TRUE(stack.GetMarkCount() == 0 && stack.GetUsedBytes() == 0);
+    }
+
+    TEST(FrameAllocator, Flip)
+    {
+        FrameAllocator allocator(2, 64 * 1024);
+
+        uint8* frame0 = (uint8*)allocator.Alloc(1000, 64);
+        EXPECT_TRUE(((uintptr_t)frame0 & 63) == 0);
+        Memory::Memset(frame0, 0xab, 1000);
+        // larger than a buffer, served by global malloc
+        uint8* overflow = (uint8*)allocator.Alloc(100 * 1024, 16);
+        Memory::Memset(overflow, 0xcd, 100 * 1024);
+
+        allocator.BeginFrame();
+        EXPECT_TRUE(allocator.GetStats().LastFrameBytes >= 1000 + 100 * 1024);
+        EXPECT_TRUE(allocator.GetStats().LastFrameOverflowBytes == 100 * 1024);
+
+        // data of last frame is still valid
+        uint8* frame1 = (uint8*)allocator.Alloc(1000, 64);
+        Memory::Memset(frame1, 0x12, 1000);
+        EXPECT_TRUE(IsFilledWith(frame0, 1000, 0xab));
+        EXPECT_TRUE(IsFilledWith(overflow, 100 * 1024, 0xcd));
+
+        allocator.BeginFrame();
+        EXPECT_TRUE(allocator.Alloc(1000, 64) == frame0);
+        EXPECT_TRUE(IsFilledWith(frame1, 1000, 0x12));
+        EXPECT_TRUE(allocator.GetStats().FrameCount == 2);
+        EXPECT_TRUE(allocator.GetStats().HighWaterMark >= 1000 + 100 * 1024);
+
+        allocator.Reset();
+    }
+
+    TEST(FrameAllocator, MultiThread)
+    {
+        FrameAllocator allocator(2, 1024 * 1024);
+        std::vector<std::thread> threads;
+        for (int32 t = 0; t < 4; t++)
+        {
+            threads.emplace_back([&allocator, t]()
+            {
+                for (int32 i = 0; i < 1000; i++)
+                {
+                    uint8* ptr = (uint8*)allocator.Alloc(100, 16);
+                    Memory::Memset(ptr, (uint8)t, 100);
+                    EXPECT_TRUE(IsFilledWith(ptr, 100, (uint8)t));
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        allocator.BeginFrame();
+        EXPECT_TRUE(allocator.GetStats().LastFrameBytes >= 4 * 1000 * 100);
+        allocator.Reset();
+    }
+
+    struct PoolObject
+    {
+        explicit PoolObject(int32 value) : Value(value) { ++SAliveCount; }
+        ~PoolObject() { --SAliveCount; }
+
+        alignas(32) int32 Value;
+        static inline int32 SAliveCount = 0;
+    };
+
+    TEST(ObjectPool, ReuseSlot)
+    {
+        ObjectPool<PoolObject> pool;
+        std::vector<PoolObject*> objects;
+        const int32 count = (int32)ObjectPool<PoolObject>::GetSlotsPerBlock() + 10;
+        for (int32 i = 0; i < count; i++)
+        {
+            PoolObject* object = pool.New(i);
+            EXPECT_TRUE(((uintptr_t)object & 31) == 0);
+            objects.push_back(object);
+        }
+        EXPECT_TRUE(pool.GetBlockCount() == 2);
+        EXPECT_TRUE(pool.GetLiveCount() == count);
+        EXPECT_TRUE(PoolObject::SAliveCount == count);
+
+        PoolObject* freed = objects[5];
+        pool.Delete(freed);
+        EXPECT_TRUE(PoolObject::SAliveCount == count - 1);
+        objects[5] = pool.New(-1);
+        EXPECT_TRUE(objects[5] == freed);
+
+        for (int32 i = 0; i < count; i++)
+        {
+            EXPECT_TRUE(objects[i]->Value == (i == 5 ? -1 : i));
+            pool.Delete(objects[i]);
+        }
+        EXPECT_TRUE(pool.GetLiveCount() == 0);
+        EXPECT_TRUE(PoolObject::SAliveCount == 0);
+    }
+
+    TEST(ObjectPool, MultiThread)
+    {
+        ConcurrentObjectPool<uint64> pool;
+        std::vector<std::thread> threads;
+        for (int32 t = 0; t < 4; t++)
+        {
+            threads.emplace_back([&pool, t]()
+            {
+                std::vector<uint64*> objects(5000, nullptr);
+                for (int32 round = 0; round < 20; round++)
+                {
+                    for (int32 i = 0; i < 5000; i++)
+                    {
+                        objects[i] = pool.New(((uint64)t << 32) | (uint64)(i + round));
+                    }
+
+                    for (int32 i = 0; i < 5000; i++)
+                    {
+                        EXPECT_TRUE(*objects[i] == (((uint64)t << 32) | (uint64)(i + round)));
+                        pool.Delete(objects[i]);
+                    }
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        EXPECT_TRUE(pool.GetLiveCount() == 0);
+    }
+
+    TEST(MemoryTracker, TagScope)
+    {
+        EXPECT_TRUE(MemoryTracker::GetCurrentTag() == EMemoryTag::Untagged);
+        {
+            MemoryTagScope outer(EMemoryTag::Render);
+            {
+                MemoryTagScope inner(EMemoryTag::Strings);
+                EXPECT_TRUE(MemoryTracker::GetCurrentTag() == EMemoryTag::Strings);
+            }
+            EXPECT_TRUE(MemoryTracker::GetCurrentTag() == EMemoryTag::Render);
+        }
+        EXPECT_TRUE(MemoryTracker::GetCurrentTag() == EMemoryTag::Untagged);
+    }
+
+    TEST(MemoryTracker, TrackingMalloc)
+    {
+        TrackingMalloc malloc(new AnsiCMalloc());
+        MemoryTracker::FlushThreadCounters();
+        const MemoryTagStats before = MemoryTracker::GetTagStats(EMemoryTag::Modules);
+
+        uint8* ptr;
+        {
+            MemoryTagScope scope(EMemoryTag::Modules);
+            ptr = (uint8*)malloc.Malloc(100, 64);
+        }
+        EXPECT_TRUE(((uintptr_t)ptr & 63) == 0);
+        EXPECT_TRUE(malloc.GetAllocationSize(ptr) >= 100);
+        Memory::Memset(ptr, 0x3c, 100);
+
+        MemoryTracker::FlushThreadCounters();
+        MemoryTagStats stats = MemoryTracker::GetTagStats(EMemoryTag::Modules);
+        EXPECT_TRUE(stats.CurrentBytes - before.CurrentBytes == 100);
+        EXPECT_TRUE(stats.LiveAllocations - before.LiveAllocations == 1);
+
+        // realloc keeps the tag of the block whatever the current tag is
+        ptr = (uint8*)malloc.Realloc(ptr, 300, 64);
+        EXPECT_TRUE(IsFilledWith(ptr, 100, 0x3c));
+        MemoryTracker::FlushThreadCounters();
+        ptr = (uint8*)malloc.Realloc(ptr, 200, 256);
+        EXPECT_TRUE(((uintptr_t)ptr & 255) == 0);
+        EXPECT_TRUE(IsFilledWith(ptr, 100, 0x3c));
+        MemoryTracker::FlushThreadCounters();
+        stats = MemoryTracker::GetTagStats(EMemoryTag::Modules);
+        EXPECT_TRUE(stats.CurrentBytes - before.CurrentBytes == 200);
+        EXPECT_TRUE(stats.PeakBytes - before.CurrentBytes >= 300);
+        EXPECT_TRUE(stats.LiveAllocations - before.LiveAllocations == 1);
+
+        malloc.Free(ptr);
+        MemoryTracker::FlushThreadCounters();
+        stats = MemoryTracker::GetTagStats(EMemoryTag::Modules);
+        EXPECT_TRUE(stats.CurrentBytes == before.CurrentBytes);
+        EXPECT_TRUE(stats.LiveAllocations == before.LiveAllocations);
+    }
+
+    TEST(MemoryTracker, ThreadExitFlush)
+    {
+        TrackingMalloc malloc(new AnsiCMalloc());
+        MemoryTracker::FlushThreadCounters();
+        const MemoryTagStats before = MemoryTracker::GetTagStats(EMemoryTag::Render);
+
+        // fewer operations than a flush needs, the thread leaves them pending
+        void* ptr = nullptr;
+        std::thread([&malloc, &ptr]()
+        {
+            MemoryTagScope scope(EMemoryTag::Render);
+            ptr = malloc.Malloc(64, 16);
+        }).join();
+
+        const MemoryTagStats stats = MemoryTracker::GetTagStats(EMemoryTag::Render);
+        EXPECT_TRUE(stats.CurrentBytes - before.CurrentBytes == 64);
+        EXPECT_TRUE(stats.LiveAllocations - before.LiveAllocations == 1);
+        malloc.Free(ptr);
+        MemoryTracker::FlushThreadCounters();
+    }
+
+    TEST(MemoryTracker, DumpCsv)
+    {
+        const ansi* path = "memory_tracker_test.csv";
+        std::remove(path);
+        EXPECT_TRUE(MemoryTracker::DumpCsv(path));
+        EXPECT_TRUE(MemoryTracker::DumpCsv(path));
+
+        FILE* file = std::fopen(path, "r");
+        EXPECT_TRUE(file != nullptr);
+        int32 lines = 0;
+        char line[256];
+        while (std::fgets(line, sizeof(line), file) != nullptr)
+        {
+            ++lines;
+        }
+        std::fclose(file);
+        std::remove(path);
+        EXPECT_TRUE(lines == 1 + 2 * (int32)EMemoryTag::Count);
+
+        // the directory of a periodic dump is created when it is set
+        const ansi* nestedPath = "memory_tracker_test_dir/dump.csv";
+        MemoryTracker::SetCsvDump(nestedPath, 0.0);
+        MemoryTracker::Tick();
+        MemoryTracker::SetCsvDump("", 0.0);
+        file = std::fopen(nestedPath, "r");
+        EXPECT_TRUE(file != nullptr);
+        if (file != nullptr)
+        {
+            std::fclose(file);
+        }
+        std::remove(nestedPath);
+        std::remove("memory_tracker_test_dir");
+    }
+
+    TEST(SimdMemory, MatchesCrt)
+    {
+        constexpr size_t kGuard = 64;
+        const ESimdLevel previousLevel = SimdMemory::GetLevel();
+        std::vector<size_t> sizes;
+        for (size_t size = 0; size <= 600; ++size)
+        {
+            sizes.push_back(size);
+        }
+        sizes.insert(sizes.end(), { 4095, 4096, 65537, SimdMemory::kLargeSize + 3 });
+
+        std::vector<uint8> src(SimdMemory::kLargeSize + 256);
+        for (size_t i = 0; i < src.size(); i++)
+        {
+            src[i] = (uint8)(i * 131 + 7);
+        }
+        std::vector<uint8> dest(src.size() + 2 * kGuard);
+        std::vector<uint8> expected(dest.size());
+
+        for (int32 level = 0; level <= (int32)SimdMemory::GetSupportedLevel(); ++level)
+        {
+            SimdMemory::SetLevel((ESimdLevel)level);
+            EXPECT_TRUE(SimdMemory::GetLevel() == (ESimdLevel)level);
+            for (size_t size : sizes)
+            {
+                for (size_t offset : { 0, 1, 7, 33 })
+                {
+                    // guard bytes around dest catch writes past the block
+                    std::memset(dest.data(), 0xCD, size + offset + 2 * kGuard);
+                    std::memset(expected.data(), 0xCD, size + offset + 2 * kGuard);
+                    std::memcpy(expected.data() + kGuard + offset, src.data() + 3, size);
+                    SimdMemory::Memcpy(dest.data() + kGuard + offset, src.data() + 3, size);
+                    EXPECT_TRUE(std::memcmp(dest.data(), expected.data(), size + offset + 2 * kGuard) == 0);
+
+                    std::memset(expected.data() + kGuard + offset, 0x5A, size);
+                    SimdMemory::Memset(dest.data() + kGuard + offset, 0x5A, size);
+                    EXPECT_TRUE(std::memcmp(dest.data(), expected.data(), size + offset + 2 * kGuard) == 0);
+
+                    EXPECT_TRUE(SimdMemory::Memcmp(dest.data() + kGuard + offset, expected.data() + kGuard + offset, size));
+                }
+
+                // a single different byte anywhere must be found
+                if (size <= 300)
+                {
+                    std::memcpy(dest.data(), src.data(), size);
+                    for (size_t position = 0; position < size; ++position)
+                    {
+                        dest[position] ^= 0x10;
+                        EXPECT_TRUE(!SimdMemory::Memcmp(dest.data(), src.data(), size));
+                        dest[position] ^= 0x10;
+                    }
+                    EXPECT_TRUE(SimdMemory::Memcmp(dest.data(), src.data(), size));
+                }
+            }
+        }
+        SimdMemory::SetLevel(previousLevel);
+    }
+
+#ifdef PL_OVERRIDE_NEW_DELETE
+    TEST(Memory, OverrideNewDelete)
+    {
+        struct alignas(128) OverAligned
+        {
+            uint8 Data[200];
+        };
+
+        int32* value = new int32(7);
+        EXPECT_TRUE(Memory::GetAllocationSize(value) >= sizeof(int32));
+        delete value;
+
+        OverAligned* aligned = new OverAligned[3];
+        EXPECT_TRUE(((uintptr_t)aligned & 127) == 0);
+        EXPECT_TRUE(Memory::GetAllocationSize(aligned) >= sizeof(OverAligned) * 3);
+        delete[] aligned;
+
+        uint8* empty = new(std::nothrow) uint8[0];
+        EXPECT_TRUE(empty != nullptr);
+        delete[] empty;
+
+        std::vector<int32> values(1000, 1);
+        EXPECT_TRUE(Memory::GetAllocationSize(values.data()) >= 1000 * sizeof(int32));
+    }
+#endif
+}
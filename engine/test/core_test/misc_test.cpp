@@ -60,6 +60,19 @@ namespace Engine
         EXPECT_TRUE(name4.ToString() == _T("Hello_World_12"));
     }
 
+    TEST(FixedString, MapLookup)
+    {
+        Map<FixedString, int32> map;
+        map.Add(FixedString(_T("Hello_World_12")), 1);
+        map.Add(FixedString(_T("Hello_World")), 2);
+
+        // no FixedString is made for the lookup key
+        EXPECT_TRUE(*map.Find(FixedStringView(_T("hello_world_12"))) == 1);
+        EXPECT_TRUE(*map.Find(FixedStringView(_T("Hello_World"))) == 2);
+        EXPECT_TRUE(map.Find(FixedStringView(_T("Hello_World_13"))) == nullptr);
+        EXPECT_TRUE(FixedString(_T("Hello_World_12")) == FixedStringView(_T("HELLO_WORLD_12")));
+    }
+
     TEST(UChar, Base)
     {
         UChar ch('A');
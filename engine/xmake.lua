@@ -74,6 +74,26 @@ option("with_benchmark")
     set_showmenu(true)
 option_end()
 
+option("binned_malloc")
+    set_default(false)
+    set_showmenu(true)
+option_end()
+
+option("override_new_delete")
+    set_default(false)
+    set_showmenu(true)
+option_end()
+
+option("static_malloc")
+    set_default(false)
+    set_showmenu(true)
+option_end()
+
+option("memory_tracker")
+    set_default(false)
+    set_showmenu(true)
+option_end()
+
 if has_config("shared") then
     add_defines("PL_SHARED")
 end
@@ -82,6 +102,22 @@ if has_config("unicode") then
     add_defines("UNICODE")
 end
 
+if has_config("binned_malloc") then
+    add_defines("PL_BINNED_MALLOC")
+end
+
+if has_config("override_new_delete") then
+    add_defines("PL_OVERRIDE_NEW_DELETE")
+end
+
+if has_config("static_malloc") then
+    add_defines("PL_STATIC_MALLOC")
+end
+
+if has_config("memory_tracker") then
+    add_defines("PL_MEMORY_TRACKER")
+end
+
 
 -- output
 if has_config("shared") then